@@ -0,0 +1,84 @@
+// Benchmark converting large arrays between JS and std::vector.
+//
+// The "per element" rows use property lookups for every element, which is what
+// from_js/to_js did before the bulk fast array path.
+
+#include <chrono>
+#include <cstdio>
+#include <include/ejr.hpp>
+
+using namespace std;
+using namespace ejr;
+
+static const int COUNT = 100000;
+static const int ITERATIONS = 50;
+
+template <typename Fn>
+static void run(const char* name, Fn fn) {
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; i++) {
+        fn();
+    }
+    auto end = chrono::steady_clock::now();
+
+    double ms = chrono::duration<double, milli>(end - start).count() / ITERATIONS;
+    printf("%-32s %8.3f ms/call\n", name, ms);
+}
+
+int main() {
+    JSRuntime* rt = JS_NewRuntime();
+    JSContext* ctx = JS_NewContext(rt);
+
+    const char* js = "Array.from({length: 100000}, (_, i) => i)";
+    JSValue array = JS_Eval(ctx, js, strlen(js), "<bench>", JS_EVAL_TYPE_GLOBAL);
+
+    run("import per element (JSArg)", [&]() {
+        JSValue len_val = JS_GetPropertyStr(ctx, array, "length");
+        uint32_t len;
+        JS_ToUint32(ctx, &len, len_val);
+        JS_FreeValue(ctx, len_val);
+        vector<JSArg> out;
+        out.reserve(len);
+        for (uint32_t i = 0; i < len; i++) {
+            out.push_back(from_js(ctx, JS_GetPropertyUint32(ctx, array, i)));
+        }
+    });
+    run("import bulk (JSArg)", [&]() {
+        vector<JSArg> out;
+        from_js_array(ctx, array, out);
+    });
+    run("import bulk (int)", [&]() {
+        vector<int> out;
+        from_js_array(ctx, array, out);
+    });
+    run("import bulk (double)", [&]() {
+        vector<double> out;
+        from_js_array(ctx, array, out);
+    });
+
+    vector<JSArg> args;
+    vector<int> ints;
+    for (int i = 0; i < COUNT; i++) {
+        args.push_back(i);
+        ints.push_back(i);
+    }
+
+    run("export per element (JSArg)", [&]() {
+        JSValue arr = JS_NewArray(ctx);
+        for (size_t i = 0; i < args.size(); i++) {
+            JS_SetPropertyUint32(ctx, arr, i, to_js(ctx, args[i]));
+        }
+        JS_FreeValue(ctx, arr);
+    });
+    run("export bulk (JSArg)", [&]() {
+        JS_FreeValue(ctx, to_js_array(ctx, args));
+    });
+    run("export bulk (int)", [&]() {
+        JS_FreeValue(ctx, to_js_array(ctx, ints));
+    });
+
+    JS_FreeValue(ctx, array);
+    JS_FreeContext(ctx);
+    JS_FreeRuntime(rt);
+    return 0;
+}
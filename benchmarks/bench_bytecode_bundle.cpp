@@ -0,0 +1,67 @@
+// Benchmark start up of a new runtime with a ~2 MB script: eval of the source vs eval_bytecode of a ejrc bundle (ms/start).
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <include/ejr.hpp>
+
+using namespace std;
+using namespace ejr;
+
+static const int ROUNDS = 10;
+
+template <typename F>
+static void run(const char* name, F&& start_runtime) {
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < ROUNDS; i++) {
+        start_runtime();
+    }
+    auto end = chrono::steady_clock::now();
+
+    double ms = chrono::duration<double, milli>(end - start).count() / ROUNDS;
+    printf("%-36s %8.2f ms/start\n", name, ms);
+}
+
+static vector<uint8_t> compile(const string& js, bool strip) {
+    EasyJSR rt;
+    vector<uint8_t> bytecode;
+    rt.compile_bytecode(js, "bundle.js", JS_EVAL_TYPE_GLOBAL, bytecode, strip);
+
+    vector<uint8_t> bundle;
+    write_bytecode_bundle({{"bundle.js", false, bytecode.data(), bytecode.size()}}, bundle);
+    return bundle;
+}
+
+int main() {
+    // A bundle of many small functions, like a bundler's output.
+    string source;
+    for (int i = 0; source.size() < 2 * 1024 * 1024; i++) {
+        string n = to_string(i);
+        source += "function handler_" + n + "(input) {\n"
+                  "    const items = input.items.map((item) => ({ id: item.id + " + n + ", name: 'item_' + item.name }));\n"
+                  "    if (items.length > " + n + ") { return items.slice(0, " + n + "); }\n"
+                  "    return items.filter((item) => item.id % 2 === 0);\n"
+                  "}\n";
+    }
+    source += "handler_0({ items: [] }).length;\n";
+
+    vector<uint8_t> bundle = compile(source, false);
+    vector<uint8_t> stripped = compile(source, true);
+    printf("source: %zu bytes, bundle: %zu bytes, stripped: %zu bytes\n", source.size(), bundle.size(), stripped.size());
+
+    run("eval source", [&]() {
+        EasyJSR rt;
+        rt.free_jsval(rt.eval_script(source, "bundle.js"));
+    });
+    run("eval_bytecode", [&]() {
+        EasyJSR rt;
+        rt.free_jsval(rt.eval_bytecode(bundle.data(), bundle.size()));
+    });
+    run("eval_bytecode in place, stripped", [&]() {
+        EasyJSR rt;
+        rt.free_jsval(rt.eval_bytecode(stripped.data(), stripped.size(), true));
+    });
+
+    return 0;
+}
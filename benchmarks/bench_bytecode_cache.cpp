@@ -0,0 +1,65 @@
+// Benchmark cold start of a ~2 MB script in a new runtime: compiling from source vs loading cached bytecode (ms/start).
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <include/ejr.hpp>
+
+using namespace std;
+using namespace ejr;
+
+static const int ROUNDS = 10;
+
+template <typename F>
+static void run(const char* name, F&& start_runtime) {
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < ROUNDS; i++) {
+        start_runtime();
+    }
+    auto end = chrono::steady_clock::now();
+
+    double ms = chrono::duration<double, milli>(end - start).count() / ROUNDS;
+    printf("%-36s %8.2f ms/start\n", name, ms);
+}
+
+int main() {
+    // A bundle of many small functions, like a bundler's output.
+    string bundle;
+    for (int i = 0; bundle.size() < 2 * 1024 * 1024; i++) {
+        string n = to_string(i);
+        bundle += "function handler_" + n + "(input) {\n"
+                  "    const items = input.items.map((item) => ({ id: item.id + " + n + ", name: 'item_' + item.name }));\n"
+                  "    if (items.length > " + n + ") { return items.slice(0, " + n + "); }\n"
+                  "    return items.filter((item) => item.id % 2 === 0);\n"
+                  "}\n";
+    }
+    bundle += "handler_0({ items: [] }).length;\n";
+    printf("bundle: %zu bytes\n", bundle.size());
+
+    string dir = (filesystem::temp_directory_path() / "ejr_bench_bytecode").string();
+    filesystem::remove_all(dir);
+    auto cache = make_shared<BytecodeCache>(dir);
+
+    run("compile from source", [&]() {
+        EasyJSR rt;
+        rt.free_jsval(rt.eval_script(bundle, "bundle.js"));
+    });
+
+    // The first start fills the cache.
+    {
+        EasyJSR rt;
+        rt.set_bytecode_cache(cache);
+        rt.free_jsval(rt.eval_script(bundle, "bundle.js"));
+    }
+    run("load cached bytecode", [&]() {
+        EasyJSR rt;
+        rt.set_bytecode_cache(cache);
+        rt.free_jsval(rt.eval_script(bundle, "bundle.js"));
+    });
+    printf("cache hits %zu, misses %zu\n", cache->hits(), cache->misses());
+
+    filesystem::remove_all(dir);
+    return 0;
+}
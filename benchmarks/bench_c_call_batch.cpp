@@ -0,0 +1,85 @@
+// Benchmark scoring a batch of rows from the C API, one call per row vs one batch call (ns/row).
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include <include/ejr.h>
+
+using namespace std;
+
+static const size_t ROWS = 1000000;
+
+template <typename F>
+static void run(const char* name, F&& call) {
+    auto start = chrono::steady_clock::now();
+    call();
+    auto end = chrono::steady_clock::now();
+
+    double ns = chrono::duration<double, nano>(end - start).count() / ROWS;
+    printf("%-36s %8.1f ns/row\n", name, ns);
+}
+
+int main() {
+    EasyJSRHandle* ejr = ejr_new();
+    ejr_free_jsvalue(ejr, ejr_eval_script(ejr, "function score(count, weight) { return count * weight + 1; }", "<bench>"));
+    EJRPreparedFunction* score = ejr_prepare_function(ejr, "score");
+
+    vector<int32_t> counts(ROWS);
+    vector<double> weights(ROWS);
+    vector<double> scores(ROWS);
+    for (size_t i = 0; i < ROWS; i++) {
+        counts[i] = static_cast<int32_t>(i);
+        weights[i] = 0.25;
+    }
+
+    run("ejr_eval_function_flat per row", [&]() {
+        JSArg args[2] = {};
+        args[0].type = JSARG_TYPE_INT;
+        args[1].type = JSARG_TYPE_DOUBLE;
+        for (size_t i = 0; i < ROWS; i++) {
+            args[0].value.int_val = counts[i];
+            args[1].value.double_val = weights[i];
+            int value = ejr_eval_function_flat(ejr, "score", args, 2);
+            JSArg* result = jsarg_from_jsvalue(ejr, value);
+            scores[i] = result->value.double_val;
+            jsarg_free(result);
+        }
+    });
+
+    run("ejr_call_prepared per row", [&]() {
+        JSArg args[2] = {};
+        args[0].type = JSARG_TYPE_INT;
+        args[1].type = JSARG_TYPE_DOUBLE;
+        for (size_t i = 0; i < ROWS; i++) {
+            args[0].value.int_val = counts[i];
+            args[1].value.double_val = weights[i];
+            int value = ejr_call_prepared(ejr, score, args, 2);
+            JSArg* result = jsarg_from_jsvalue(ejr, value);
+            scores[i] = result->value.double_val;
+            jsarg_free(result);
+        }
+    });
+
+    run("ejr_call_prepared_batch", [&]() {
+        JSArg columns[2] = {};
+        columns[0].type = JSARG_TYPE_INT32_ARRAY;
+        columns[0].value.i32_array_val.items = counts.data();
+        columns[0].value.i32_array_val.count = ROWS;
+        columns[1].type = JSARG_TYPE_ARRAY_VIEW;
+        columns[1].value.array_view_val.items = weights.data();
+        columns[1].value.array_view_val.count = ROWS;
+        columns[1].value.array_view_val.element_type = JSARG_TYPED_ARRAY_FLOAT64;
+
+        JSArg out = {};
+        out.type = JSARG_TYPE_ARRAY_VIEW;
+        out.value.array_view_val.items = scores.data();
+        out.value.array_view_val.count = ROWS;
+        out.value.array_view_val.element_type = JSARG_TYPED_ARRAY_FLOAT64;
+
+        ejr_call_prepared_batch(ejr, score, columns, 2, &out);
+    });
+
+    ejr_free_prepared(ejr, score);
+    ejr_free(ejr);
+    return 0;
+}
@@ -0,0 +1,52 @@
+// Benchmark the C API callback glue (ns/call).
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <include/ejr.h>
+
+using namespace std;
+
+static const int CALLS = 1000000;
+
+static JSArg* c_add(JSArg** args, size_t argc, void* opaque) {
+    return jsarg_int(args[0]->value.int_val + args[1]->value.int_val);
+}
+
+static JSArg* c_len(JSArg** args, size_t argc, void* opaque) {
+    return jsarg_int(static_cast<int>(strlen(args[0]->value.str_val)));
+}
+
+static JSArg* c_greet(JSArg** args, size_t argc, void* opaque) {
+    return jsarg_str(args[0]->value.str_val);
+}
+
+static void run(EasyJSRHandle* ejr, const char* name, const string& call) {
+    string js = "for (let i = 0; i < " + to_string(CALLS) + "; i++) { " + call + "; }";
+
+    auto start = chrono::steady_clock::now();
+    int value = ejr_eval_script(ejr, js.c_str(), "<bench>");
+    auto end = chrono::steady_clock::now();
+    ejr_free_jsvalue(ejr, value);
+
+    double ns = chrono::duration<double, nano>(end - start).count() / CALLS;
+    printf("%-28s %8.1f ns/call\n", name, ns);
+}
+
+int main() {
+    EasyJSRHandle* ejr = ejr_new();
+
+    ejr_register_callback(ejr, "add", c_add, nullptr);
+    ejr_register_callback(ejr, "len", c_len, nullptr);
+    ejr_register_callback(ejr, "greet", c_greet, nullptr);
+
+    ejr_free_jsvalue(ejr, ejr_eval_script(ejr, "var s = 'hello world, this is a longer string';", "<bench>"));
+
+    run(ejr, "add(i, 1)", "add(i, 1)");
+    run(ejr, "len(s)", "len(s)");
+    run(ejr, "greet(s)", "greet(s)");
+
+    ejr_free(ejr);
+    return 0;
+}
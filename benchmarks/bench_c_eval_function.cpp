@@ -0,0 +1,53 @@
+// Benchmark calling a JS function from the C API (ns/call).
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <include/ejr.h>
+
+using namespace std;
+
+static const int CALLS = 1000000;
+
+template <typename F>
+static void run(const char* name, F&& call) {
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < CALLS; i++) {
+        call(i);
+    }
+    auto end = chrono::steady_clock::now();
+
+    double ns = chrono::duration<double, nano>(end - start).count() / CALLS;
+    printf("%-36s %8.1f ns/call\n", name, ns);
+}
+
+int main() {
+    EasyJSRHandle* ejr = ejr_new();
+    ejr_free_jsvalue(ejr, ejr_eval_script(ejr, "function add(a, b) { return a + b; }", "<bench>"));
+
+    run("ejr_eval_function", [&](int i) {
+        JSArg** args = jsarg_make_list(2);
+        jsarg_add_to_list(args, jsarg_int(i), 0);
+        jsarg_add_to_list(args, jsarg_int(1), 1);
+        ejr_free_jsvalue(ejr, ejr_eval_function(ejr, "add", args, 2));
+    });
+
+    JSArg args[2] = {};
+    args[0].type = JSARG_TYPE_INT;
+    args[1].type = JSARG_TYPE_INT;
+    args[1].value.int_val = 1;
+    run("ejr_eval_function_flat", [&](int i) {
+        args[0].value.int_val = i;
+        ejr_free_jsvalue(ejr, ejr_eval_function_flat(ejr, "add", args, 2));
+    });
+
+    EJRPreparedFunction* add = ejr_prepare_function(ejr, "add");
+    run("ejr_call_prepared", [&](int i) {
+        args[0].value.int_val = i;
+        ejr_free_jsvalue(ejr, ejr_call_prepared(ejr, add, args, 2));
+    });
+    ejr_free_prepared(ejr, add);
+
+    ejr_free(ejr);
+    return 0;
+}
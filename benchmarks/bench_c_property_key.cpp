@@ -0,0 +1,61 @@
+// Benchmark reading the fields of a object from the C API: by name, through interned keys, and all at once (ns/field).
+
+#include <chrono>
+#include <cstdio>
+#include <include/ejr.h>
+
+using namespace std;
+
+static const int ROUNDS = 200000;
+static const int FIELDS = 10;
+
+static const char* NAMES[FIELDS] = {
+    "id", "score", "count", "weight", "rank", "offset", "total", "limit", "flags", "version"
+};
+
+template <typename F>
+static void run(const char* name, F&& get) {
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < ROUNDS; i++) {
+        for (int f = 0; f < FIELDS; f++) {
+            get(f);
+        }
+    }
+    auto end = chrono::steady_clock::now();
+
+    double ns = chrono::duration<double, nano>(end - start).count() / (ROUNDS * FIELDS);
+    printf("%-36s %8.1f ns/field\n", name, ns);
+}
+
+int main() {
+    EasyJSRHandle* ejr = ejr_new();
+    ejr_free_jsvalue(ejr, ejr_eval_script(ejr,
+        "var result = { id: 1, score: 2.5, count: 3, weight: 4, rank: 5, offset: 6, total: 7, limit: 8, flags: 9, version: 10 };",
+        "<bench>"));
+    int result = ejr_get_from_global(ejr, "result");
+
+    run("ejr_get_property_from", [&](int f) {
+        ejr_free_jsvalue(ejr, ejr_get_property_from(ejr, result, NAMES[f]));
+    });
+
+    EJRKey* keys[FIELDS];
+    for (int f = 0; f < FIELDS; f++) {
+        keys[f] = ejr_intern_key(ejr, NAMES[f]);
+    }
+    run("ejr_get_property_by_key", [&](int f) {
+        ejr_free_jsvalue(ejr, ejr_get_property_by_key(ejr, result, keys[f]));
+    });
+
+    // All fields in one call, counted per field.
+    JSArg out[FIELDS];
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < ROUNDS; i++) {
+        ejr_get_properties(ejr, result, keys, FIELDS, out, nullptr);
+    }
+    auto end = chrono::steady_clock::now();
+    double ns = chrono::duration<double, nano>(end - start).count() / (ROUNDS * FIELDS);
+    printf("%-36s %8.1f ns/field\n", "ejr_get_properties", ns);
+
+    ejr_free(ejr);
+    return 0;
+}
@@ -0,0 +1,61 @@
+// Benchmark the C API value ids: look up a value by id, add the result, free it. 10M times (ns/handle).
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include <include/ejr.h>
+
+using namespace std;
+
+static const int HANDLES = 10000000;
+
+template <typename F>
+static void run(const char* name, F&& call) {
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < HANDLES; i++) {
+        call(i);
+    }
+    auto end = chrono::steady_clock::now();
+
+    double ns = chrono::duration<double, nano>(end - start).count() / HANDLES;
+    printf("%-36s %8.1f ns/handle\n", name, ns);
+}
+
+int main() {
+    EasyJSRHandle* ejr = ejr_new();
+    ejr_free_jsvalue(ejr, ejr_eval_script(ejr, "var value = { n: 1 };", "<bench>"));
+    int object = ejr_get_from_global(ejr, "value");
+
+    // One value alive at a time.
+    run("get property + free", [&](int) {
+        ejr_free_jsvalue(ejr, ejr_get_property_from(ejr, object, "n"));
+    });
+
+    // A window of live values, freed in the order they were made.
+    const int window = 4096;
+    vector<int> live(window, -1);
+    run("get property + free, 4096 live", [&](int i) {
+        int& slot = live[i % window];
+        if (slot != -1) {
+            ejr_free_jsvalue(ejr, slot);
+        }
+        slot = ejr_get_property_from(ejr, object, "n");
+    });
+    for (int id : live) {
+        ejr_free_jsvalue(ejr, id);
+    }
+
+    // No frees, a scope releases every 4096 values at once.
+    ejr_scope_begin(ejr);
+    run("get property, scope of 4096", [&](int i) {
+        ejr_get_property_from(ejr, object, "n");
+        if (i % window == window - 1) {
+            ejr_scope_end(ejr);
+            ejr_scope_begin(ejr);
+        }
+    });
+    ejr_scope_end(ejr);
+
+    ejr_free(ejr);
+    return 0;
+}
@@ -0,0 +1,63 @@
+// Benchmark callback throughput with JSArgs (std::variant) against JSCompactArgs.
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <include/ejr.hpp>
+
+using namespace std;
+using namespace ejr;
+
+static const int CALLS = 1000000;
+
+static void run(EasyJSR& rt, const char* name, const string& call) {
+    string js = "for (let i = 0; i < " + to_string(CALLS) + "; i++) { " + call + "; }";
+
+    auto start = chrono::steady_clock::now();
+    JSValue val = rt.eval_script(js, "<bench>");
+    auto end = chrono::steady_clock::now();
+    rt.free_jsval(val);
+
+    double ns = chrono::duration<double, nano>(end - start).count() / CALLS;
+    printf("%-32s %8.1f ns/call\n", name, ns);
+}
+
+int main() {
+    EasyJSR rt;
+
+    rt.register_callback("add", [](const JSArgs& args) -> JSArg {
+        return jsarg_as<int>(args[0]) + jsarg_as<int>(args[1]);
+    });
+    rt.register_compact_callback("add_compact", [](const JSCompactArgs& args) -> JSArg {
+        return args[0].as_int() + args[1].as_int();
+    });
+
+    rt.register_callback("len", [](const JSArgs& args) -> JSArg {
+        return static_cast<int>(jsarg_as<string>(args[0]).size());
+    });
+    rt.register_compact_callback("len_compact", [](const JSCompactArgs& args) -> JSArg {
+        return static_cast<int>(args.string_of(args[0]).size());
+    });
+
+    rt.register_callback("count", [](const JSArgs& args) -> JSArg {
+        return static_cast<int>(jsarg_as<shared_ptr<vector<JSArg>>>(args[0])->size());
+    });
+    rt.register_compact_callback("count_compact", [](const JSCompactArgs& args) -> JSArg {
+        return static_cast<int>(args[0].length());
+    });
+
+    JSValue setup = rt.eval_script("var long_str = 'x'.repeat(64); var arr = [1, 'two', 3.5, [4, 5]];", "<bench>");
+    rt.free_jsval(setup);
+
+    run(rt, "add(i, 1) JSArgs", "add(i, 1)");
+    run(rt, "add(i, 1) JSCompactArgs", "add_compact(i, 1)");
+    run(rt, "len(short) JSArgs", "len('hello')");
+    run(rt, "len(short) JSCompactArgs", "len_compact('hello')");
+    run(rt, "len(long) JSArgs", "len(long_str)");
+    run(rt, "len(long) JSCompactArgs", "len_compact(long_str)");
+    run(rt, "count(array) JSArgs", "count(arr)");
+    run(rt, "count(array) JSCompactArgs", "count_compact(arr)");
+
+    printf("sizeof(JSArg) = %zu, sizeof(JSCompactArg) = %zu\n", sizeof(JSArg), sizeof(JSCompactArg));
+    return 0;
+}
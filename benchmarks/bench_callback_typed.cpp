@@ -0,0 +1,72 @@
+// Benchmark typed callbacks against DynCallback, and count C++ heap allocations per call.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <include/ejr.hpp>
+
+using namespace std;
+using namespace ejr;
+
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    if (void* ptr = malloc(size)) {
+        return ptr;
+    }
+    throw bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+static const int CALLS = 1000000;
+
+static int add(int a, int b) {
+    return a + b;
+}
+
+static void run(EasyJSR& rt, const char* name, const string& call) {
+    string js = "for (let i = 0; i < " + to_string(CALLS) + "; i++) { " + call + "; }";
+
+    size_t before = allocations;
+    auto start = chrono::steady_clock::now();
+    JSValue val = rt.eval_script(js, "<bench>");
+    auto end = chrono::steady_clock::now();
+    size_t after = allocations;
+    rt.free_jsval(val);
+
+    double ns = chrono::duration<double, nano>(end - start).count() / CALLS;
+    printf("%-28s %8.1f ns/call %8.2f allocs/call\n", name, ns, static_cast<double>(after - before) / CALLS);
+}
+
+int main() {
+    EasyJSR rt;
+
+    rt.register_callback("add_dyn", [](const JSArgs& args) -> JSArg {
+        return jsarg_as<int>(args[0]) + jsarg_as<int>(args[1]);
+    });
+    rt.register_callback("add_typed", add);
+
+    rt.register_callback("scale_dyn", [](const JSArgs& args) -> JSArg {
+        return jsarg_as<double>(args[0]) * 2.0;
+    });
+    rt.register_callback<double(double)>("scale_typed", [](double x) {
+        return x * 2.0;
+    });
+
+    run(rt, "add(i, 1) DynCallback", "add_dyn(i, 1)");
+    run(rt, "add(i, 1) typed", "add_typed(i, 1)");
+    run(rt, "scale(i + 0.5) DynCallback", "scale_dyn(i + 0.5)");
+    run(rt, "scale(i + 0.5) typed", "scale_typed(i + 0.5)");
+
+    return 0;
+}
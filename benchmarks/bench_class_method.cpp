@@ -0,0 +1,50 @@
+// Benchmark calling a native object from JS: a class method vs a global callback that looks the object up by name.
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <include/ejr.hpp>
+
+using namespace std;
+using namespace ejr;
+
+static const int CALLS = 1000000;
+
+struct Counter {
+    int count = 0;
+
+    int add(int by) {
+        this->count += by;
+        return this->count;
+    }
+};
+
+static void run(EasyJSR& rt, const char* name, const string& setup, const string& call) {
+    string js = setup + "; for (let i = 0; i < " + to_string(CALLS) + "; i++) { " + call + "; }";
+
+    auto start = chrono::steady_clock::now();
+    JSValue val = rt.eval_script(js, "<bench>");
+    auto end = chrono::steady_clock::now();
+    rt.free_jsval(val);
+
+    double ns = chrono::duration<double, nano>(end - start).count() / CALLS;
+    printf("%-28s %8.1f ns/call\n", name, ns);
+}
+
+int main() {
+    EasyJSR rt;
+
+    // Objects kept on the native side, found by name on every call.
+    unordered_map<string, Counter> counters;
+    rt.register_callback<int(std::string, int)>("counter_add", [&](std::string name, int by) {
+        return counters[name].add(by);
+    });
+
+    rt.register_class<Counter>("Counter").method("add", &Counter::add);
+
+    run(rt, "global callback + lookup", "", "counter_add('c', 1)");
+    run(rt, "class method", "const c = new Counter()", "c.add(1)");
+
+    return 0;
+}
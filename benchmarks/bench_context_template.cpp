@@ -0,0 +1,59 @@
+// Benchmark creating a ready to use runtime: set up by hand vs from a context template (us/runtime).
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include <include/ejr.hpp>
+
+using namespace std;
+using namespace ejr;
+
+static const int ROUNDS = 500;
+
+static const string PRELUDE = "globalThis.console = { log: (...args) => print(args.join(' ')) };\n"
+                              "globalThis.app = { routes: new Map(), route(path, fn) { this.routes.set(path, fn); } };\n"
+                              "for (let i = 0; i < 50; i++) { app.route('/item/' + i, (req) => ({ id: i, req })); }\n";
+
+template <typename F>
+static void run(const char* name, F&& create) {
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < ROUNDS; i++) {
+        unique_ptr<EasyJSR> rt = create();
+        rt->free_jsval(rt->eval_script("app.routes.get('/item/7')({}).id", "request.js"));
+    }
+    auto end = chrono::steady_clock::now();
+
+    double us = chrono::duration<double, micro>(end - start).count() / ROUNDS;
+    printf("%-36s %8.1f us/runtime\n", name, us);
+}
+
+static void setup(ContextTemplate& tmpl) {
+    tmpl.register_compact_callback("print", [](const JSCompactArgs&) -> JSArg { return JSArg(); });
+    tmpl.add_prelude_script(PRELUDE, "prelude.js");
+}
+
+int main() {
+    run("by hand", []() {
+        auto rt = make_unique<EasyJSR>();
+        rt->register_compact_callback("print", [](const JSCompactArgs&) -> JSArg { return JSArg(); });
+        rt->free_jsval(rt->eval_script(PRELUDE, "prelude.js"));
+        return rt;
+    });
+
+    ContextTemplate all;
+    setup(all);
+    run("template", [&]() { return all.instantiate(); });
+
+    ContextTemplate reduced;
+    reduced.set_intrinsics(ContextTemplate::MapSet);
+    setup(reduced);
+    run("template, only Map and Set", [&]() { return reduced.instantiate(); });
+
+    // Made ahead of time, e.g. on a background thread between requests.
+    reduced.prewarm(ROUNDS);
+    run("template, prewarmed", [&]() { return reduced.instantiate(); });
+
+    return 0;
+}
@@ -0,0 +1,50 @@
+// Benchmark the per value cost of from_js for every JSArg type.
+
+#include <chrono>
+#include <cstdio>
+#include <include/ejr.hpp>
+
+using namespace std;
+using namespace ejr;
+
+static const int ITERATIONS = 200000;
+
+static void run(JSContext* ctx, const char* name, const char* js, bool borrow = false) {
+    JSValue value = JS_Eval(ctx, js, strlen(js), "<bench>", JS_EVAL_TYPE_GLOBAL);
+
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; i++) {
+        JSArg arg = from_js(ctx, value, false, borrow);
+        (void)arg;
+    }
+    auto end = chrono::steady_clock::now();
+
+    double ns = chrono::duration<double, nano>(end - start).count() / ITERATIONS;
+    printf("%-24s %10.1f ns/value\n", name, ns);
+
+    JS_FreeValue(ctx, value);
+}
+
+int main() {
+    JSRuntime* rt = JS_NewRuntime();
+    JSContext* ctx = JS_NewContext(rt);
+
+    run(ctx, "int", "42");
+    run(ctx, "double", "4.2");
+    run(ctx, "bool", "true");
+    run(ctx, "bigint", "42n");
+    run(ctx, "null", "null");
+    run(ctx, "undefined", "undefined");
+    run(ctx, "string (8)", "'abcdefgh'");
+    run(ctx, "string (1024)", "'x'.repeat(1024)");
+    run(ctx, "array (16 ints)", "Array.from({length: 16}, (_, i) => i)");
+    run(ctx, "Uint8Array (1024)", "new Uint8Array(1024)");
+    run(ctx, "Uint8Array view (1024)", "new Uint8Array(1024)", true);
+    run(ctx, "Float32Array (256)", "new Float32Array(256)");
+    run(ctx, "BigInt64Array (128)", "new BigInt64Array(128)");
+    run(ctx, "error", "new TypeError('bad')");
+
+    JS_FreeContext(ctx);
+    JS_FreeRuntime(rt);
+    return 0;
+}
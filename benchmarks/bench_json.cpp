@@ -0,0 +1,71 @@
+// Benchmark exchanging a large document: JSArg trees through to_js/from_js vs the JSON bridge (ms/document).
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <include/ejr.hpp>
+
+using namespace std;
+using namespace ejr;
+
+static const int ROWS = 100000;
+static const int ROUNDS = 20;
+
+template <typename F>
+static void run(const char* name, F&& exchange) {
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < ROUNDS; i++) {
+        exchange();
+    }
+    auto end = chrono::steady_clock::now();
+
+    double ms = chrono::duration<double, milli>(end - start).count() / ROUNDS;
+    printf("%-36s %8.2f ms/document\n", name, ms);
+}
+
+int main() {
+    EasyJSR rt;
+    JSContext* ctx = rt.get_context();
+
+    // Rows of [id, score, label], as a JSArg tree and as JSON.
+    vector<JSArg> rows;
+    string json = "[";
+    for (int i = 0; i < ROWS; i++) {
+        rows.push_back(JSArg(vector<JSArg>{ i, i * 0.5, string("row") }));
+        json += (i > 0 ? ",[" : "[") + to_string(i) + "," + to_string(i * 0.5) + ",\"row\"]";
+    }
+    json += "]";
+    JSArg tree(std::move(rows));
+    rt.free_jsval(rt.eval_script("var __json_parse = (text) => JSON.parse(text);", "<bench>"));
+
+    run("to_js of a JSArg tree", [&]() {
+        JS_FreeValue(ctx, to_js(ctx, tree));
+    });
+    // What a JSON document used to take: a JS string copy, then JSON.parse.
+    run("JSON.parse through eval_function", [&]() {
+        JS_FreeValue(ctx, rt.eval_function("__json_parse", { json }));
+    });
+    run("parse_json", [&]() {
+        JS_FreeValue(ctx, rt.parse_json(json));
+    });
+
+    JSValue doc = rt.parse_json(json);
+    run("from_js into a JSArg tree", [&]() {
+        from_js(ctx, doc, false);
+    });
+    JSValue stringify = JS_Eval(ctx, "JSON.stringify", 14, "<bench>", 0);
+    run("JSON.stringify + val_to_string", [&]() {
+        string text = rt.val_to_string(JS_Call(ctx, stringify, js_undefined(), 1, &doc));
+    });
+    JS_FreeValue(ctx, stringify);
+
+    string out;
+    run("stringify_json into a reused string", [&]() {
+        out.clear();
+        rt.stringify_json(doc, out);
+    });
+    JS_FreeValue(ctx, doc);
+
+    return 0;
+}
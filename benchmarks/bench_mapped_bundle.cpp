@@ -0,0 +1,84 @@
+// Benchmark a request that imports 3 of 300 bundled modules: eval_bytecode of the whole bundle vs a mapped bundle (ms/request).
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <include/ejr.hpp>
+
+using namespace std;
+using namespace ejr;
+
+static const int ROUNDS = 20;
+static const int MODULES = 300;
+
+template <typename F>
+static void run(const char* name, F&& request) {
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < ROUNDS; i++) {
+        request();
+    }
+    auto end = chrono::steady_clock::now();
+
+    double ms = chrono::duration<double, milli>(end - start).count() / ROUNDS;
+    printf("%-36s %8.2f ms/request\n", name, ms);
+}
+
+int main() {
+    // Modules of ~20 KB, compiled into one bundle.
+    vector<string> names;
+    vector<vector<uint8_t>> bytecode(MODULES);
+    vector<BytecodeBundleEntry> entries;
+    {
+        EasyJSR compiler;
+        for (int m = 0; m < MODULES; m++) {
+            string source;
+            for (int i = 0; source.size() < 20 * 1024; i++) {
+                string n = to_string(i);
+                source += "export function handler_" + n + "(input) {\n"
+                          "    const items = input.items.map((item) => ({ id: item.id + " + n + ", name: 'item_' + item.name }));\n"
+                          "    return items.filter((item) => item.id % 2 === 0);\n"
+                          "}\n";
+            }
+            names.push_back("lib_" + to_string(m) + ".js");
+            compiler.compile_bytecode(source, names.back(), JS_EVAL_TYPE_MODULE, bytecode[m]);
+        }
+    }
+    for (int m = 0; m < MODULES; m++) {
+        entries.push_back({names[m], true, bytecode[m].data(), bytecode[m].size()});
+    }
+    vector<uint8_t> bundle;
+    write_bytecode_bundle(entries, bundle);
+
+    string path = (filesystem::temp_directory_path() / "ejr_bench_bundle.jsbc").string();
+    ofstream(path, ios::binary).write(reinterpret_cast<const char*>(bundle.data()), bundle.size());
+    printf("bundle: %zu modules, %zu bytes\n", entries.size(), bundle.size());
+
+    const string request = "import { handler_0 as a } from 'lib_7.js';\n"
+                           "import { handler_0 as b } from 'lib_150.js';\n"
+                           "import { handler_0 as c } from 'lib_299.js';\n"
+                           "a({ items: [] }); b({ items: [] }); c({ items: [] });\n";
+
+    run("eval_bytecode of the whole bundle", [&]() {
+        EasyJSR rt;
+        rt.free_jsval(rt.eval_bytecode(bundle.data(), bundle.size()));
+        rt.free_jsval(rt.eval_module(request, "request.js"));
+    });
+
+    auto mapped = MappedBytecodeBundle::open(path);
+    run("mapped bundle, lazy imports", [&]() {
+        EasyJSR rt;
+        rt.mount_bytecode_bundle(mapped);
+        rt.free_jsval(rt.eval_module(request, "request.js"));
+    });
+    run("open, map and import", [&]() {
+        EasyJSR rt;
+        rt.mount_bytecode_bundle(MappedBytecodeBundle::open(path));
+        rt.free_jsval(rt.eval_module(request, "request.js"));
+    });
+
+    filesystem::remove(path);
+    return 0;
+}
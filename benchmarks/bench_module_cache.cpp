@@ -0,0 +1,53 @@
+// Benchmark 64 runtimes importing the same 20 modules: compiling them in every runtime vs the shared module cache (ms/runtime).
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <include/ejr.hpp>
+
+using namespace std;
+using namespace ejr;
+
+static const int RUNTIMES = 64;
+static const int MODULES = 20;
+
+int main() {
+    // Modules of ~50 KB, like the files of a app.
+    unordered_map<string, string> files;
+    string main_module;
+    for (int m = 0; m < MODULES; m++) {
+        string source;
+        for (int i = 0; source.size() < 50 * 1024; i++) {
+            string n = to_string(i);
+            source += "export function handler_" + n + "(input) {\n"
+                      "    const items = input.items.map((item) => ({ id: item.id + " + n + ", name: 'item_' + item.name }));\n"
+                      "    return items.filter((item) => item.id % 2 === 0);\n"
+                      "}\n";
+        }
+        string name = "lib_" + to_string(m) + ".js";
+        files[name] = source;
+        main_module += "import * as m" + to_string(m) + " from '" + name + "';\n";
+    }
+
+    auto run = [&](const char* name, bool cached) {
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < RUNTIMES; i++) {
+            EasyJSR rt;
+            rt.set_module_cache_enabled(cached);
+            rt.set_file_loader([&](const string& path) { return files[path]; });
+            rt.free_jsval(rt.eval_module(main_module, "main.js"));
+        }
+        auto end = chrono::steady_clock::now();
+
+        double ms = chrono::duration<double, milli>(end - start).count() / RUNTIMES;
+        printf("%-36s %8.2f ms/runtime\n", name, ms);
+    };
+
+    run("compile in every runtime", false);
+    run("shared module cache", true);
+
+    ModuleCache& cache = ModuleCache::shared();
+    printf("cache hits %zu, misses %zu, modules %zu\n", cache.hits(), cache.misses(), cache.size());
+    return 0;
+}
@@ -0,0 +1,62 @@
+// Benchmark the overhead of calling a native function from JS (ns/call).
+//
+// The callbacks do no work, so the time is the trampoline dispatch plus the loop itself.
+// The empty loop is measured too so it can be subtracted.
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <include/ejr.hpp>
+
+using namespace std;
+using namespace ejr;
+
+static const int CALLS = 5000000;
+
+static const int RUNS = 5;
+
+/// Best of RUNS, to keep scheduler noise out.
+static double run(EasyJSR& rt, const string& call) {
+    string js = "for (let i = 0; i < " + to_string(CALLS) + "; i++) { " + call + "; }";
+
+    double best = 0;
+    for (int r = 0; r < RUNS; r++) {
+        auto start = chrono::steady_clock::now();
+        JSValue val = rt.eval_script(js, "<bench>");
+        auto end = chrono::steady_clock::now();
+        rt.free_jsval(val);
+
+        double ns = chrono::duration<double, nano>(end - start).count() / CALLS;
+        if (r == 0 || ns < best) {
+            best = ns;
+        }
+    }
+    return best;
+}
+
+int main() {
+    EasyJSR rt;
+
+    // Register a few unrelated callbacks so lookups are not trivially cheap.
+    for (int i = 0; i < 64; i++) {
+        rt.register_callback("filler_" + to_string(i), [](const JSArgs& args) -> JSArg {
+            return nullptr;
+        });
+    }
+
+    rt.register_callback("noop_dyn", [](const JSArgs& args) -> JSArg {
+        return std::monostate();
+    });
+    rt.register_compact_callback("noop_compact", [](const JSCompactArgs& args) -> JSArg {
+        return std::monostate();
+    });
+    rt.register_callback<void()>("noop_typed", [] {});
+
+    double loop = run(rt, "");
+    printf("%-24s %8.1f ns/iteration\n", "empty loop", loop);
+    printf("%-24s %8.1f ns/call\n", "DynCallback", run(rt, "noop_dyn()") - loop);
+    printf("%-24s %8.1f ns/call\n", "CompactCallback", run(rt, "noop_compact()") - loop);
+    printf("%-24s %8.1f ns/call\n", "typed", run(rt, "noop_typed()") - loop);
+
+    return 0;
+}
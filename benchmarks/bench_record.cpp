@@ -0,0 +1,76 @@
+// Benchmark returning records to JS: a JSON string parsed in JS, properties set one by one, and a JSArgObject (ns/record).
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <include/ejr.hpp>
+
+using namespace std;
+using namespace ejr;
+
+static const int RECORDS = 1000000;
+
+static const char* NAMES[] = { "id", "score", "count", "label", "active", "weight" };
+
+template <typename F>
+static void run(const char* name, F&& make) {
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < RECORDS; i++) {
+        make(i);
+    }
+    auto end = chrono::steady_clock::now();
+
+    double ns = chrono::duration<double, nano>(end - start).count() / RECORDS;
+    printf("%-36s %8.1f ns/record\n", name, ns);
+}
+
+int main() {
+    EasyJSR rt;
+    JSContext* ctx = rt.get_context();
+
+    JSValue global = JS_GetGlobalObject(ctx);
+    JSValue json = JS_GetPropertyStr(ctx, global, "JSON");
+    JSValue parse = JS_GetPropertyStr(ctx, json, "parse");
+
+    run("JSON string + JSON.parse", [&](int i) {
+        string text = "{\"id\":" + to_string(i) + ",\"score\":2.5,\"count\":3,\"label\":\"row\",\"active\":true,\"weight\":0.25}";
+        JSValue str = JS_NewStringLen(ctx, text.data(), text.size());
+        JS_FreeValue(ctx, JS_Call(ctx, parse, json, 1, &str));
+        JS_FreeValue(ctx, str);
+    });
+
+    run("JS_SetPropertyStr per field", [&](int i) {
+        JSValue object = JS_NewObject(ctx);
+        JS_SetPropertyStr(ctx, object, NAMES[0], JS_NewInt32(ctx, i));
+        JS_SetPropertyStr(ctx, object, NAMES[1], JS_NewFloat64(ctx, 2.5));
+        JS_SetPropertyStr(ctx, object, NAMES[2], JS_NewInt32(ctx, 3));
+        JS_SetPropertyStr(ctx, object, NAMES[3], JS_NewString(ctx, "row"));
+        JS_SetPropertyStr(ctx, object, NAMES[4], JS_NewBool(ctx, true));
+        JS_SetPropertyStr(ctx, object, NAMES[5], JS_NewFloat64(ctx, 0.25));
+        JS_FreeValue(ctx, object);
+    });
+
+    // The same record, converted with to_js from its cached template.
+    JSArgObject record;
+    record.set("id", 0).set("score", 2.5).set("count", 3).set("label", string("row")).set("active", true).set("weight", 0.25);
+    JSArg arg(std::move(record));
+    JSArgObject& fields = *get<shared_ptr<JSArgObject>>(arg.value);
+    run("JSArgObject to_js", [&](int i) {
+        fields.values[0] = i;
+        JS_FreeValue(ctx, to_js(ctx, arg));
+    });
+
+    run("new_record", [&](int i) {
+        string_view keys[6] = { NAMES[0], NAMES[1], NAMES[2], NAMES[3], NAMES[4], NAMES[5] };
+        JSValue values[6] = {
+            JS_NewInt32(ctx, i), JS_NewFloat64(ctx, 2.5), JS_NewInt32(ctx, 3),
+            JS_NewString(ctx, "row"), JS_NewBool(ctx, true), JS_NewFloat64(ctx, 0.25),
+        };
+        JS_FreeValue(ctx, new_record(ctx, keys, 6, values));
+    });
+
+    JS_FreeValue(ctx, parse);
+    JS_FreeValue(ctx, json);
+    JS_FreeValue(ctx, global);
+    return 0;
+}
@@ -0,0 +1,56 @@
+// Benchmark moving a value between two runtimes: a JSON round trip vs serialize_value/deserialize_value (ms/transfer).
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <include/ejr.hpp>
+
+using namespace std;
+using namespace ejr;
+
+static const int ROUNDS = 50;
+
+template <typename F>
+static void run(const char* name, F&& transfer) {
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < ROUNDS; i++) {
+        transfer();
+    }
+    auto end = chrono::steady_clock::now();
+
+    double ms = chrono::duration<double, milli>(end - start).count() / ROUNDS;
+    printf("%-40s %8.2f ms/transfer\n", name, ms);
+}
+
+static void compare(EasyJSR& from, EasyJSR& to, const char* label, const string& js) {
+    JSValue value = from.eval_script(js, "<bench>");
+
+    string json;
+    run((string(label) + ": JSON round trip").c_str(), [&]() {
+        json.clear();
+        from.stringify_json(value, json);
+        to.free_jsval(to.parse_json(json));
+    });
+
+    SerializedValue serialized;
+    run((string(label) + ": serialize_value").c_str(), [&]() {
+        from.serialize_value(value, serialized);
+        to.free_jsval(to.deserialize_value(serialized));
+    });
+    printf("%-40s %8zu / %zu bytes\n", (string(label) + ": JSON / serialized size").c_str(), json.size(), serialized.data().size());
+
+    from.free_jsval(value);
+}
+
+int main() {
+    EasyJSR from;
+    EasyJSR to;
+
+    compare(from, to, "records",
+        "Array.from({ length: 50000 }, (_, i) => ({ id: i, score: i * 0.5, label: 'row' + i, tags: ['a', 'b'] }))");
+    // JSON has to spell every number out, and the result is a plain Array instead of a Float64Array.
+    compare(from, to, "Float64Array",
+        "Float64Array.from({ length: 500000 }, (_, i) => i * 0.25)");
+
+    return 0;
+}
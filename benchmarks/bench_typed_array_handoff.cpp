@@ -0,0 +1,63 @@
+// Benchmark typed array handoff from C++ to JS.
+//
+// Compares the copying path (to_js(const JSArg&)) against the ownership
+// transferring path (to_js(JSArg&&)) and reports the bytes copied per call.
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include <include/ejr.hpp>
+
+using namespace std;
+using namespace ejr;
+
+static const size_t PAYLOAD_BYTES = 4 * 1024 * 1024;
+static const int ITERATIONS = 200;
+
+/// @brief Get the backing store of a typed array.
+static const uint8_t* typed_array_data(JSContext* ctx, JSValue array) {
+    size_t offset, length, bpe, size;
+    JSValue buffer = JS_GetTypedArrayBuffer(ctx, array, &offset, &length, &bpe);
+    const uint8_t* data = JS_GetArrayBuffer(ctx, &size, buffer);
+    JS_FreeValue(ctx, buffer);
+    return data + offset;
+}
+
+template <typename T>
+static void run(JSContext* ctx, const char* name, bool transfer) {
+    size_t count = PAYLOAD_BYTES / sizeof(T);
+    size_t bytes_copied = 0;
+    double total_ms = 0;
+
+    for (int i = 0; i < ITERATIONS; i++) {
+        JSArg arg(JSArgTypedArray<T>(vector<T>(count, T(1))));
+        const uint8_t* original = reinterpret_cast<const uint8_t*>(get<JSArgTypedArray<T>>(arg.value).values.data());
+
+        auto start = chrono::steady_clock::now();
+        JSValue array = transfer ? to_js(ctx, std::move(arg)) : to_js(ctx, arg);
+        auto end = chrono::steady_clock::now();
+        total_ms += chrono::duration<double, milli>(end - start).count();
+
+        if (typed_array_data(ctx, array) != original) {
+            bytes_copied += count * sizeof(T);
+        }
+        JS_FreeValue(ctx, array);
+    }
+
+    printf("%-14s %-9s %10.3f ms/call %12zu bytes copied/call\n",
+           name, transfer ? "transfer" : "copy", total_ms / ITERATIONS, bytes_copied / ITERATIONS);
+}
+
+int main() {
+    JSRuntime* rt = JS_NewRuntime();
+    JSContext* ctx = JS_NewContext(rt);
+
+    run<uint8_t>(ctx, "Uint8Array", false);
+    run<uint8_t>(ctx, "Uint8Array", true);
+    run<float>(ctx, "Float32Array", false);
+    run<float>(ctx, "Float32Array", true);
+
+    JS_FreeContext(ctx);
+    JS_FreeRuntime(rt);
+    return 0;
+}
@@ -6,22 +6,32 @@
 using namespace std;
 using namespace ejr;
 
-JSArg add_callback(const JSArgs& args) {
-    return jsarg_as<int>(args[0]) + jsarg_as<int>(args[1]);
+int add_callback(int a, int b) {
+    return a + b;
+}
+
+JSArg describe_callback(const JSArgs& args) {
+    return "called with " + to_string(args.size()) + " args";
 }
 
 int main() {
     unique_ptr<EasyJSR> easyjsr = make_unique<EasyJSR>();
 
+    // Typed callbacks convert the arguments directly, no JSArgs are built.
     easyjsr->register_callback("add", add_callback);
-    easyjsr->register_callback("sub", [](const JSArgs& args) -> JSArg {
-        return jsarg_as<int>(args[0]) - jsarg_as<int>(args[1]);
+    easyjsr->register_callback<int(int, int)>("sub", [](int a, int b) {
+        return a - b;
     });
+    // Dynamic callbacks take any arguments.
+    easyjsr->register_callback("describe", describe_callback);
 
-    auto result = easyjsr->run_script(R"(
+    auto result = easyjsr->eval_script(R"(
         sub(add(1, 1), add(1, 0)) // result is going to be 1 (2 - 1)
     )", "<script>");
     cout << "Result is: " << easyjsr->val_to_string(result) << endl;
 
+    result = easyjsr->eval_script("describe(1, 'two', [3])", "<script>");
+    cout << easyjsr->val_to_string(result) << endl;
+
     return 0;
 }
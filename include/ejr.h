@@ -14,6 +14,14 @@ extern "C" {
 #define EJR_MINOR 2
 #define EJR_PATCH 1
 
+/**
+ * @brief Most values a runtime hands out to C at once.
+ *
+ * Value ids index a table of this size. While it is full, calls returning a value id
+ * free the new value and return -1, until values are freed with ejr_free_jsvalue or a scope.
+ */
+#define EJR_MAX_LIVE_VALUES (1 << 20)
+
 // Types
 
 /**
@@ -21,6 +29,16 @@ extern "C" {
  */
 typedef struct EasyJSRHandle EasyJSRHandle;
 
+/**
+ * @brief A arena JSArgs can be allocated in, see ejr_arena_new.
+ */
+typedef struct EJRArena EJRArena;
+
+/**
+ * @brief A JS function resolved once for repeated calls, see ejr_prepare_function.
+ */
+typedef struct EJRPreparedFunction EJRPreparedFunction;
+
 /**
  * @brief C version of our JSArg union
  */
@@ -44,8 +62,28 @@ typedef enum {
     JSARG_TYPE_INT16_ARRAY,
     JSARG_TYPE_UINT64_ARRAY,
     JSARG_TYPE_FLOAT_ARRAY,
-    JSARG_TYPE_EXCEPTION
+    JSARG_TYPE_EXCEPTION,
+    JSARG_TYPE_ARRAY_VIEW,
+    JSARG_TYPE_OBJECT
 } JSArgType;
+
+/**
+ * @brief Element type of a JSARG_TYPE_ARRAY_VIEW. Matches QuickJS's JSTypedArrayEnum.
+ */
+typedef enum {
+    JSARG_TYPED_ARRAY_UINT8C,
+    JSARG_TYPED_ARRAY_INT8,
+    JSARG_TYPED_ARRAY_UINT8,
+    JSARG_TYPED_ARRAY_INT16,
+    JSARG_TYPED_ARRAY_UINT16,
+    JSARG_TYPED_ARRAY_INT32,
+    JSARG_TYPED_ARRAY_UINT32,
+    JSARG_TYPED_ARRAY_BIG_INT64,
+    JSARG_TYPED_ARRAY_BIG_UINT64,
+    JSARG_TYPED_ARRAY_FLOAT16,
+    JSARG_TYPED_ARRAY_FLOAT32,
+    JSARG_TYPED_ARRAY_FLOAT64
+} JSArgTypedArrayType;
 typedef struct JSArg JSArg;
 /**
  * @brief C version of our JSArg union
@@ -53,6 +91,8 @@ typedef struct JSArg JSArg;
 struct JSArg {
     // The argument type
     JSArgType type;
+    // Set when allocated in a EJRArena, jsarg_free ignores these.
+    bool in_arena;
     union {
         int int_val;
         double double_val;
@@ -107,6 +147,17 @@ struct JSArg {
             const char* msg;
             const char* name;
         } exception_val;
+        struct {
+            void* items;
+            size_t count;
+            JSArgTypedArrayType element_type;
+        } array_view_val;
+        struct {
+            const char** keys;
+            JSArg** values;
+            size_t count;
+            size_t capacity;
+        } object_val;
     } value;
 };
 /**
@@ -114,6 +165,61 @@ struct JSArg {
  */
 typedef JSArg* (*C_Callback)(JSArg** args, size_t arg_count, void* opaque);
 
+/**
+ * @brief A property name interned once, see ejr_intern_key.
+ */
+typedef struct EJRKey EJRKey;
+
+/**
+ * @brief A value serialized by ejr_serialize_value.
+ */
+typedef struct EJRSerializedValue EJRSerializedValue;
+
+/**
+ * @brief A native class registered with ejr_register_class.
+ */
+typedef struct EJRClass EJRClass;
+
+/**
+ * @brief A prelude captured once and stamped into new runtimes, see ejr_template_new.
+ */
+typedef struct EJRContextTemplate EJRContextTemplate;
+
+/**
+ * @brief Optional built-ins of a runtime made from a template. The base objects, eval, JSON and Promise are always there.
+ */
+typedef enum {
+    EJR_INTRINSIC_DATE = 1 << 0,
+    EJR_INTRINSIC_REGEXP = 1 << 1,
+    EJR_INTRINSIC_PROXY = 1 << 2,
+    EJR_INTRINSIC_MAP_SET = 1 << 3,
+    EJR_INTRINSIC_TYPED_ARRAYS = 1 << 4,
+    EJR_INTRINSIC_WEAK_REF = 1 << 5,
+    EJR_INTRINSIC_ALL = (1 << 6) - 1
+} EJRIntrinsic;
+
+/**
+ * @brief Creates the native object of a class, for `new ClassName(...)` in JS.
+ * 
+ * Returning NULL throws a error in JS.
+ */
+typedef void* (*C_Constructor)(JSArg** args, size_t arg_count, void* opaque);
+
+/**
+ * @brief A method, getter or setter of a class. native is the object it is called on.
+ */
+typedef JSArg* (*C_Method)(void* native, JSArg** args, size_t arg_count, void* opaque);
+
+/**
+ * @brief Frees the native object of a class once its JS object is collected.
+ */
+typedef void (*C_Finalizer)(void* native, void* opaque);
+
+/**
+ * @brief Receives the text of ejr_json_stringify. Return false to fail it.
+ */
+typedef bool (*C_JSONSink)(const char* data, size_t length, void* opaque);
+
 /**
  * @brief C wrapper for FileLoaderFn
  */
@@ -142,6 +248,89 @@ struct JSMethod {
  */
 EasyJSRHandle* ejr_new();
 
+/**
+ * @brief Create a context template, registrations and a prelude stamped into every runtime made from it.
+ * 
+ * The prelude is compiled once, runtimes made from the template run its bytecode.
+ * Set the template up from one thread, runtimes can then be made from many.
+ */
+EJRContextTemplate* ejr_template_new();
+
+/**
+ * @brief Pick the optional built-ins of the runtimes, leaving some out makes them faster to create.
+ * 
+ * @param tmpl The template.
+ * @param intrinsics A mask of EJRIntrinsic, EJR_INTRINSIC_ALL by default.
+ */
+void ejr_template_set_intrinsics(EJRContextTemplate* tmpl, uint32_t intrinsics);
+
+/**
+ * @brief Register a callback in every runtime made from the template, see ejr_register_callback.
+ * 
+ * @param tmpl The template.
+ * @param fn_name The JS function name.
+ * @param cb The callback.
+ * @param opaque Passed to every call, in every runtime.
+ */
+void ejr_template_register_callback(EJRContextTemplate* tmpl, const char* fn_name, C_Callback cb, void* opaque);
+
+/**
+ * @brief Register a module in every runtime made from the template, see ejr_register_module.
+ * 
+ * @param tmpl The template.
+ * @param module_name Name to give the module.
+ * @param methods A array of methods, copied.
+ * @param method_count number of methods.
+ */
+void ejr_template_register_module(EJRContextTemplate* tmpl, const char* module_name, JSMethod* methods, size_t method_count);
+
+/**
+ * @brief Add a prelude script or module, run by every runtime made from the template after the registrations before it.
+ * 
+ * It is compiled and run once here, to catch errors early.
+ * 
+ * @param tmpl The template.
+ * @param js The JS code.
+ * @param file_name The name of the file.
+ * @param is_module Compile it as a module.
+ * 
+ * @return false if it does not compile or throws, see ejr_template_error.
+ */
+bool ejr_template_add_prelude(EJRContextTemplate* tmpl, const char* js, const char* file_name, bool is_module);
+
+/**
+ * @brief Why the last ejr_template_add_prelude failed.
+ * 
+ * @param tmpl The template.
+ * 
+ * @return The error, owned by the template.
+ */
+const char* ejr_template_error(EJRContextTemplate* tmpl);
+
+/**
+ * @brief Make runtimes ahead of time, ejr_new_from_template then hands them out in microseconds.
+ * 
+ * Safe to call from a background thread while runtimes are made from the template.
+ * 
+ * @param tmpl The template.
+ * @param count Number of runtimes to make.
+ */
+void ejr_template_prewarm(EJRContextTemplate* tmpl, size_t count);
+
+/**
+ * @brief Create a runtime from a template, with its registrations and prelude in place.
+ * 
+ * @param tmpl The template, it may be freed before the runtime.
+ * 
+ * @return The runtime, freed with ejr_free.
+ */
+EasyJSRHandle* ejr_new_from_template(EJRContextTemplate* tmpl);
+
+/**
+ * @brief Free a template and its prewarmed runtimes.
+ */
+void ejr_template_free(EJRContextTemplate* tmpl);
+
 /**
  * @brief Create a int JSArg.
  * 
@@ -343,6 +532,19 @@ JSArg* jsarg_float_array(const float* args, size_t argc);
  */
 JSArg* jsarg_exception(const char* message, const char* name);
 
+/**
+ * @brief Create a borrowed typed array view.
+ * 
+ * This does NOT copy or own the memory. The items must outlive the JSArg.
+ * 
+ * @param items Pointer to the first element.
+ * @param count The number of elements.
+ * @param element_type The type of the elements.
+ * 
+ * @return JSArg
+ */
+JSArg* jsarg_array_view(void* items, size_t count, JSArgTypedArrayType element_type);
+
 /**
  * @brief Add a JSArg value to a array.
  * 
@@ -351,6 +553,26 @@ JSArg* jsarg_exception(const char* message, const char* name);
  */
 void jsarg_add_value_to_c_array(JSArg* arg, JSArg* value);
 
+/**
+ * @brief Create a object JSArg of ordered key/value pairs.
+ *
+ * Records with the same keys in the same order share one cached template when converted to JS.
+ *
+ * @param capacity The max number of entries.
+ *
+ * @return JSArg
+ */
+JSArg* jsarg_object(size_t capacity);
+
+/**
+ * @brief Add a entry to a object, the key is copied. Does nothing once the object is full.
+ *
+ * @param arg Pointer to the object.
+ * @param key the key.
+ * @param value the JSArg value, owned by the object from now on.
+ */
+void jsarg_add_entry_to_object(JSArg* arg, const char* key, JSArg* value);
+
 /**
  * @brief Get a JSArg from a JSValue(int)
  * 
@@ -368,6 +590,162 @@ JSArg* jsarg_from_jsvalue(EasyJSRHandle* handle, int value);
  */
 JSArg* jsarg_undefined();
 
+// Arena
+
+/**
+ * @brief Create a arena for JSArgs.
+ * 
+ * JSArgs created with the jsarg_*_in functions are bump allocated in the arena, strings and arrays included.
+ * They are all released at once by ejr_arena_reset or ejr_arena_free, jsarg_free ignores them.
+ * Only add args of the same arena to a arena array or list.
+ * 
+ * @param block_size Size of the blocks the arena allocates, 0 for the default (4096).
+ * 
+ * @return EJRArena
+ */
+EJRArena* ejr_arena_new(size_t block_size);
+
+/**
+ * @brief Release every JSArg in the arena. The memory is kept for reuse.
+ * 
+ * @param arena The arena.
+ */
+void ejr_arena_reset(EJRArena* arena);
+
+/**
+ * @brief Free a arena and every JSArg in it.
+ * 
+ * @param arena The arena.
+ */
+void ejr_arena_free(EJRArena* arena);
+
+/**
+ * @brief Same as jsarg_int, allocated in arena.
+ */
+JSArg* jsarg_int_in(EJRArena* arena, int value);
+
+/**
+ * @brief Same as jsarg_str, the copy is allocated in arena.
+ */
+JSArg* jsarg_str_in(EJRArena* arena, const char* value);
+
+/**
+ * @brief Same as jsarg_double, allocated in arena.
+ */
+JSArg* jsarg_double_in(EJRArena* arena, double value);
+
+/**
+ * @brief Same as jsarg_float, allocated in arena.
+ */
+JSArg* jsarg_float_in(EJRArena* arena, float value);
+
+/**
+ * @brief Same as jsarg_int64t, allocated in arena.
+ */
+JSArg* jsarg_int64t_in(EJRArena* arena, int64_t value);
+
+/**
+ * @brief Same as jsarg_uint32t, allocated in arena.
+ */
+JSArg* jsarg_uint32t_in(EJRArena* arena, uint32_t value);
+
+/**
+ * @brief Same as jsarg_bool, allocated in arena.
+ */
+JSArg* jsarg_bool_in(EJRArena* arena, bool value);
+
+/**
+ * @brief Same as jsarg_carray, the array is allocated in arena.
+ */
+JSArg* jsarg_carray_in(EJRArena* arena, size_t count);
+
+/**
+ * @brief Same as jsarg_null, allocated in arena.
+ */
+JSArg* jsarg_null_in(EJRArena* arena);
+
+/**
+ * @brief Same as jsarg_undefined, allocated in arena.
+ */
+JSArg* jsarg_undefined_in(EJRArena* arena);
+
+/**
+ * @brief Same as jsarg_u8_array, the copy is allocated in arena.
+ */
+JSArg* jsarg_u8_array_in(EJRArena* arena, const uint8_t* args, size_t argc);
+
+/**
+ * @brief Same as jsarg_i32_array, the copy is allocated in arena.
+ */
+JSArg* jsarg_i32_array_in(EJRArena* arena, const int32_t* args, size_t argc);
+
+/**
+ * @brief Same as jsarg_u32_array, the copy is allocated in arena.
+ */
+JSArg* jsarg_u32_array_in(EJRArena* arena, const uint32_t* args, size_t argc);
+
+/**
+ * @brief Same as jsarg_i64_array, the copy is allocated in arena.
+ */
+JSArg* jsarg_i64_array_in(EJRArena* arena, const int64_t* args, size_t argc);
+
+/**
+ * @brief Same as jsarg_i8_array, the copy is allocated in arena.
+ */
+JSArg* jsarg_i8_array_in(EJRArena* arena, const int8_t* args, size_t argc);
+
+/**
+ * @brief Same as jsarg_i16_array, the copy is allocated in arena.
+ */
+JSArg* jsarg_i16_array_in(EJRArena* arena, const int16_t* args, size_t argc);
+
+/**
+ * @brief Same as jsarg_u16_array, the copy is allocated in arena.
+ */
+JSArg* jsarg_u16_array_in(EJRArena* arena, const uint16_t* args, size_t argc);
+
+/**
+ * @brief Same as jsarg_u64_array, the copy is allocated in arena.
+ */
+JSArg* jsarg_u64_array_in(EJRArena* arena, const uint64_t* args, size_t argc);
+
+/**
+ * @brief Same as jsarg_float_array, the copy is allocated in arena.
+ */
+JSArg* jsarg_float_array_in(EJRArena* arena, const float* args, size_t argc);
+
+/**
+ * @brief Same as jsarg_exception, the copies are allocated in arena.
+ */
+JSArg* jsarg_exception_in(EJRArena* arena, const char* message, const char* name);
+
+/**
+ * @brief Same as jsarg_array_view, allocated in arena. The items are still borrowed.
+ */
+JSArg* jsarg_array_view_in(EJRArena* arena, void* items, size_t count, JSArgTypedArrayType element_type);
+
+/**
+ * @brief Same as jsarg_object, the entries are allocated in arena.
+ */
+JSArg* jsarg_object_in(EJRArena* arena, size_t capacity);
+
+/**
+ * @brief Same as jsarg_add_entry_to_object, the key is copied into arena.
+ */
+void jsarg_add_entry_to_object_in(EJRArena* arena, JSArg* arg, const char* key, JSArg* value);
+
+/**
+ * @brief Same as jsarg_make_list, the list and its placeholders are allocated in arena.
+ * 
+ * Do not pass it to jsarg_free_all, or to functions that free their args.
+ * 
+ * @param arena The arena.
+ * @param argc Count of args this can hold
+ * 
+ * @return a Pointer of Pointers
+ */
+JSArg** jsarg_make_list_in(EJRArena* arena, size_t argc);
+
 // Deleters
 /**
  * @brief Free a easyjs runtime
@@ -381,6 +759,13 @@ void ejr_free(EasyJSRHandle* handle);
  */
 void jsarg_free(JSArg* arg);
 
+/**
+ * @brief Free what a JSArg owns, but not the JSArg itself. For JSArgs in caller arrays, see ejr_get_properties.
+ * 
+ * @param arg A pointer to the JSArg.
+ */
+void jsarg_free_value(JSArg* arg);
+
 /**
  * @brief Free A JSArg**
  * 
@@ -392,6 +777,8 @@ void jsarg_free_all(JSArg** args, size_t argc);
 /**
  * @brief Create a JSArg**
  * 
+ * Every slot starts out as a undefined JSArg.
+ * 
  * @param argc Count of args this can hold
  * 
  * @return a Pointer of Pointers
@@ -402,6 +789,7 @@ JSArg** jsarg_make_list(size_t argc);
  * @brief Add a JSArg to a JSArg** 
  * 
  * This is NOT for a C_Array! But rather a list of JSArgs
+ * The JSArg previously at i is freed.
  * 
  * @param jsarg the list ptr
  * @param njsarg the jsarg to add
@@ -427,10 +815,88 @@ void ejr_set_file_loader(EasyJSRHandle* handle, C_FileLoaderFn fn, void* opaque)
  * @param js The JS code.
  * @param file_name The name of the file.
  * 
- * @return The id of the created JSValue.
+ * @return The id of the created JSValue, -1 if EJR_MAX_LIVE_VALUES are alive.
  */
 int ejr_eval_script(EasyJSRHandle* handle, const char* js, const char* file_name);
 
+/**
+ * @brief Cache the compiled bytecode of evaluated scripts and modules in a directory, across runs.
+ * 
+ * Files are keyed by a hash of the source, file name and QuickJS version. Evals with a cached
+ * file skip parsing and compiling, anything missing or damaged is compiled again.
+ * The bytecode is loaded as is, only use a directory you trust.
+ * 
+ * @param handle the easyjsr runtime.
+ * @param directory The cache directory, created if needed. NULL turns the cache off.
+ */
+void ejr_set_bytecode_cache(EasyJSRHandle* handle, const char* directory);
+
+/**
+ * @brief Get how many evals were served from the bytecode cache and how many compiled.
+ * 
+ * @param handle the easyjsr runtime.
+ * @param hits Set to the number of evals that loaded bytecode.
+ * @param misses Set to the number of evals that compiled.
+ * 
+ * @return false if no bytecode cache is set.
+ */
+bool ejr_bytecode_cache_stats(EasyJSRHandle* handle, size_t* hits, size_t* misses);
+
+/**
+ * @brief Evaluate a bytecode bundle made by ejrc, skipping parsing and compiling.
+ * 
+ * Modules of the bundle can import each other, then every entry runs in bundle order.
+ * A promise result, like that of a module, is awaited as in ejr_eval_module.
+ * 
+ * @param handle the easyjsr runtime.
+ * @param bundle The bundle, like the array of a header written by `ejrc -c`.
+ * @param size The size of the bundle in bytes.
+ * @param in_place Use the bytecode from bundle instead of copying it, bundle must then outlive handle.
+ * 
+ * @return The id of the value of the last entry, -1 if EJR_MAX_LIVE_VALUES are alive.
+ */
+int ejr_eval_bytecode(EasyJSRHandle* handle, const uint8_t* bundle, size_t size, bool in_place);
+
+/**
+ * @brief Map a bundle file made by ejrc read only and import its modules from it.
+ * 
+ * Only the index is read here, a module is read the first time it is imported. Mounted bundles are
+ * searched after native modules and before the file loader, the pages are shared between processes.
+ * 
+ * @param handle the easyjsr runtime.
+ * @param path The bundle file.
+ * 
+ * @return false if the file can not be mapped or is not a bundle.
+ */
+bool ejr_mount_bytecode_bundle(EasyJSRHandle* handle, const char* path);
+
+/**
+ * @brief Turn the process wide module cache on or off for a runtime, it is on by default.
+ * 
+ * Modules imported through the file loader are compiled once per process and shared by every runtime
+ * through their bytecode, keyed by module name and a hash of the source.
+ * 
+ * @param handle the easyjsr runtime.
+ * @param enabled Whether imports of this runtime go through the cache.
+ */
+void ejr_set_module_cache_enabled(EasyJSRHandle* handle, bool enabled);
+
+/**
+ * @brief Get how many imports of all runtimes read cached bytecode and how many compiled.
+ * 
+ * @param hits Set to the number of imports that read cached bytecode.
+ * @param misses Set to the number of imports that compiled.
+ * @param modules Set to the number of cached modules.
+ * 
+ * @return false if a pointer is NULL.
+ */
+bool ejr_module_cache_stats(size_t* hits, size_t* misses, size_t* modules);
+
+/**
+ * @brief Drop every module of the process wide module cache, runtimes that use them are not affected.
+ */
+void ejr_clear_module_cache();
+
 /**
  * @brief Evaluate a JS script as a module level.
  * 
@@ -438,7 +904,7 @@ int ejr_eval_script(EasyJSRHandle* handle, const char* js, const char* file_name
  * @param js The JS code.
  * @param file_name The name of the file.
  * 
- * @return The id of the created JSValue.
+ * @return The id of the created JSValue, -1 if EJR_MAX_LIVE_VALUES are alive.
  */
 int ejr_eval_module(EasyJSRHandle* handle, const char* js, const char* file_name);
 
@@ -452,10 +918,25 @@ int ejr_eval_module(EasyJSRHandle* handle, const char* js, const char* file_name
  * @param args The args to pass into the function.
  * @param arg_count Number of args being passed.
  * 
- * @return The id of the resulted JSValue.
+ * @return The id of the resulted JSValue, -1 if EJR_MAX_LIVE_VALUES are alive.
  */
 int ejr_eval_function(EasyJSRHandle* handle, const char* fn_name, JSArg** args, size_t arg_count);
 
+/**
+ * @brief Evaluate a JS function with a contiguous array of args.
+ * 
+ * Unlike ejr_eval_function the args are owned by the caller and NOT freed, so the same
+ * array can be refilled and reused across calls. Args can live on the stack.
+ * 
+ * @param handle the easyjsr runtime.
+ * @param fn_name The JS function name.
+ * @param args The args to pass into the function.
+ * @param arg_count Number of args being passed.
+ * 
+ * @return The id of the resulted JSValue, -1 if EJR_MAX_LIVE_VALUES are alive.
+ */
+int ejr_eval_function_flat(EasyJSRHandle* handle, const char* fn_name, const JSArg* args, size_t arg_count);
+
 /**
  * @brief Convert a JSValue into a c_string.
  * 
@@ -477,10 +958,96 @@ char * ejr_val_to_string(EasyJSRHandle* handle, int value_id);
  * @param args The args to pass into the function.
  * @param arg_count Number of args being passed.
  * 
- * @return The id of the resulted JSValue.
+ * @return The id of the resulted JSValue, -1 if EJR_MAX_LIVE_VALUES are alive.
  */
 int ejr_eval_class_function(EasyJSRHandle* handle, int value_id, const char* fn_name, JSArg** args, size_t arg_count);
 
+/**
+ * @brief Evaluate a JS function on a class or object with a contiguous array of args.
+ * 
+ * The args are owned by the caller and NOT freed, see ejr_eval_function_flat.
+ * 
+ * @param handle the easyjsr runtime.
+ * @param value_id The objects/classes id in jsvad
+ * @param fn_name The JS function name.
+ * @param args The args to pass into the function.
+ * @param arg_count Number of args being passed.
+ * 
+ * @return The id of the resulted JSValue, -1 if EJR_MAX_LIVE_VALUES are alive.
+ */
+int ejr_eval_class_function_flat(EasyJSRHandle* handle, int value_id, const char* fn_name, const JSArg* args, size_t arg_count);
+
+/**
+ * @brief Resolve a global JS function once, for calling it many times with ejr_call_prepared.
+ * 
+ * The function stays alive until ejr_free_prepared (or ejr_free).
+ * 
+ * @param handle the easyjsr runtime.
+ * @param fn_name The JS function name.
+ * 
+ * @return The prepared function, NULL if fn_name is not a function.
+ */
+EJRPreparedFunction* ejr_prepare_function(EasyJSRHandle* handle, const char* fn_name);
+
+/**
+ * @brief Resolve a function on a class or object once, for calling it many times with ejr_call_prepared.
+ * 
+ * The object is kept alive with the function and used as this.
+ * 
+ * @param handle the easyjsr runtime.
+ * @param value_id The objects/classes id in jsvad
+ * @param fn_name The JS function name.
+ * 
+ * @return The prepared function, NULL if fn_name is not a function.
+ */
+EJRPreparedFunction* ejr_prepare_class_function(EasyJSRHandle* handle, int value_id, const char* fn_name);
+
+/**
+ * @brief Call a prepared function.
+ * 
+ * The args are owned by the caller and NOT freed, see ejr_eval_function_flat.
+ * 
+ * @param handle the easyjsr runtime.
+ * @param function The prepared function.
+ * @param args The args to pass into the function.
+ * @param arg_count Number of args being passed.
+ * 
+ * @return The id of the resulted JSValue, -1 if EJR_MAX_LIVE_VALUES are alive.
+ */
+int ejr_call_prepared(EasyJSRHandle* handle, EJRPreparedFunction* function, const JSArg* args, size_t arg_count);
+
+/**
+ * @brief Call a prepared function once per row over columns of args, in a single call.
+ * 
+ * Column i is the i-th argument of every row. A column is any typed array JSArg
+ * (including JSARG_TYPE_ARRAY_VIEW), or a JSARG_TYPE_C_ARRAY of JSArgs (e.g. strings).
+ * The columns are owned by the caller and NOT freed.
+ * 
+ * The results are written into out, which is either:
+ * - a JSARG_TYPE_ARRAY_VIEW over a caller buffer, each result is converted to its element type.
+ * - a JSARG_TYPE_C_ARRAY from jsarg_carray(rows), filled with the results.
+ * 
+ * Every column must have as many rows as out. If a row throws, the batch stops there.
+ * With a JSARG_TYPE_C_ARRAY output the exception is kept in that rows slot.
+ * 
+ * @param handle the easyjsr runtime.
+ * @param function The prepared function.
+ * @param columns The argument columns.
+ * @param column_count Number of columns, the number of args per call.
+ * @param out The output column.
+ * 
+ * @return The number of rows completed, -1 if the columns do not line up.
+ */
+int ejr_call_prepared_batch(EasyJSRHandle* handle, EJRPreparedFunction* function, const JSArg* columns, size_t column_count, JSArg* out);
+
+/**
+ * @brief Free a prepared function. Freeing it again is a no-op.
+ * 
+ * @param handle the easyjsr runtime.
+ * @param function The prepared function.
+ */
+void ejr_free_prepared(EasyJSRHandle* handle, EJRPreparedFunction* function);
+
 /**
  * @brief Get a property from a object.
  * 
@@ -488,17 +1055,155 @@ int ejr_eval_class_function(EasyJSRHandle* handle, int value_id, const char* fn_
  * @param value_id The objects/classes id in jsvad
  * @param property The property name.
  * 
- * @return the Id of the resulted value.
+ * @return the Id of the resulted value, -1 if EJR_MAX_LIVE_VALUES are alive.
  */
 int ejr_get_property_from(EasyJSRHandle* handle, int value_id, const char* property);
 
+/**
+ * @brief Intern a property name once, for fast repeated gets and sets.
+ * 
+ * The key stays alive until ejr_free_key (or ejr_free).
+ * 
+ * @param handle the easyjsr runtime.
+ * @param property The property name.
+ * 
+ * @return The key, NULL on failure.
+ */
+EJRKey* ejr_intern_key(EasyJSRHandle* handle, const char* property);
+
+/**
+ * @brief Free a interned key. Freeing it again is a no-op.
+ * 
+ * @param handle the easyjsr runtime.
+ * @param key The key.
+ */
+void ejr_free_key(EasyJSRHandle* handle, EJRKey* key);
+
+/**
+ * @brief Get a property from a object through a interned key.
+ * 
+ * @param handle the easyjsr runtime.
+ * @param value_id The objects id.
+ * @param key The property key.
+ * 
+ * @return the Id of the resulted value, -1 if EJR_MAX_LIVE_VALUES are alive.
+ */
+int ejr_get_property_by_key(EasyJSRHandle* handle, int value_id, const EJRKey* key);
+
+/**
+ * @brief Set a property on a object through a interned key.
+ * 
+ * @param handle the easyjsr runtime.
+ * @param value_id The objects id.
+ * @param key The property key.
+ * @param value The value, owned by the caller.
+ * 
+ * @return true if the property was set.
+ */
+bool ejr_set_property_by_key(EasyJSRHandle* handle, int value_id, const EJRKey* key, const JSArg* value);
+
+/**
+ * @brief Read many properties of a object at once, into a caller array.
+ * 
+ * Numbers and bools are filled in place. Strings, arrays and other values are allocated
+ * in arena if given (released with it), otherwise release each with jsarg_free_value.
+ * A getter that throws leaves a JSARG_TYPE_EXCEPTION in its slot.
+ * 
+ * @param handle the easyjsr runtime.
+ * @param value_id The objects id.
+ * @param keys The interned property keys.
+ * @param key_count Number of keys, out must hold as many JSArgs.
+ * @param out The JSArgs to fill, one per key.
+ * @param arena Arena for the values that need memory, can be NULL.
+ * 
+ * @return The number of properties read, -1 if value_id is not a object.
+ */
+int ejr_get_properties(EasyJSRHandle* handle, int value_id, const EJRKey* const* keys, size_t key_count, JSArg* out, EJRArena* arena);
+
+/**
+ * @brief Parse a JSON document straight from a caller buffer, without copying it.
+ * 
+ * @param handle the easyjsr runtime.
+ * @param json UTF-8 JSON, json[length] must be '\0' (QuickJS reads up to the terminator).
+ * @param length The length of json, without the terminator.
+ * 
+ * @return The id of the parsed value, a exception if the JSON is invalid, -1 if EJR_MAX_LIVE_VALUES are alive.
+ */
+int ejr_parse_json(EasyJSRHandle* handle, const char* json, size_t length);
+
+/**
+ * @brief JSON.stringify a value into sink, in one piece.
+ * 
+ * ASCII text is passed straight from the JS string, with no copy. data is only valid during the call.
+ * 
+ * @param handle the easyjsr runtime.
+ * @param value_id The id of the value.
+ * @param sink Receives the UTF-8 text, returns false to fail the call.
+ * @param opaque Passed to sink.
+ * 
+ * @return true if the text was written, false if stringify threw, the value has no JSON form or sink failed.
+ */
+bool ejr_json_stringify(EasyJSRHandle* handle, int value_id, C_JSONSink sink, void* opaque);
+
+/**
+ * @brief Serialize a value in the structured clone format of QuickJS, for another runtime.
+ * 
+ * Keeps types JSON loses: typed arrays, Dates, BigInts, undefined, cycles and shared references.
+ * The result can be read by any runtime, on any thread.
+ * 
+ * @param handle the easyjsr runtime.
+ * @param value_id The id of the value.
+ * @param allow_shared Pass SharedArrayBuffers by reference instead of failing.
+ * 
+ * @return The serialized value, free it with ejr_free_serialized_value. NULL if the value can not be cloned (e.g. a function).
+ */
+EJRSerializedValue* ejr_serialize_value(EasyJSRHandle* handle, int value_id, bool allow_shared);
+
+/**
+ * @brief Get the bytes of a serialized value.
+ * 
+ * Values without SharedArrayBuffers can be copied and read back later with ejr_deserialize_bytes.
+ * 
+ * @param value The serialized value.
+ * @param size Set to the number of bytes.
+ * 
+ * @return The bytes, owned by value.
+ */
+const uint8_t* ejr_serialized_bytes(const EJRSerializedValue* value, size_t* size);
+
+/**
+ * @brief Read a serialized value into a runtime.
+ * 
+ * @param handle the easyjsr runtime.
+ * @param value The serialized value, can be read any number of times.
+ * 
+ * @return The id of the value, a exception if the bytes are not valid, -1 if EJR_MAX_LIVE_VALUES are alive.
+ */
+int ejr_deserialize_value(EasyJSRHandle* handle, const EJRSerializedValue* value);
+
+/**
+ * @brief Read a value from stored ejr_serialized_bytes. SharedArrayBuffers are rejected.
+ * 
+ * @param handle the easyjsr runtime.
+ * @param bytes The bytes.
+ * @param size The number of bytes.
+ * 
+ * @return The id of the value, a exception if the bytes are not valid, -1 if EJR_MAX_LIVE_VALUES are alive.
+ */
+int ejr_deserialize_bytes(EasyJSRHandle* handle, const uint8_t* bytes, size_t size);
+
+/**
+ * @brief Free a serialized value.
+ */
+void ejr_free_serialized_value(EJRSerializedValue* value);
+
 /**
  * @brief Get a property from Global scope.
  * 
  * @param handle the easyjsr runtime.
  * @param property The property name.
  * 
- * @return the Id of the resulted value.
+ * @return the Id of the resulted value, -1 if EJR_MAX_LIVE_VALUES are alive.
  */
 int ejr_get_from_global(EasyJSRHandle* handle, const char* property);
 
@@ -512,6 +1217,19 @@ int ejr_get_from_global(EasyJSRHandle* handle, const char* property);
  */
 void ejr_register_callback(EasyJSRHandle* handle, const char* fn_name, C_Callback cb, void* opaque);
 
+/**
+ * @brief Register a callback in JS that borrows typed arrays.
+ * 
+ * Typed array arguments are passed as JSARG_TYPE_ARRAY_VIEW pointing straight into the JS ArrayBuffer.
+ * Nothing is copied, writes are visible to JS. The view is only valid until the callback returns.
+ * 
+ * @param handle The easyjsr runtime.
+ * @param fn_name Name to give the callback.
+ * @param cb The actual C callback.
+ * @param opaque Opaque user data.
+ */
+void ejr_register_callback_borrowed(EasyJSRHandle* handle, const char* fn_name, C_Callback cb, void* opaque);
+
 /**
  * @brief Register a module in JS.
  * 
@@ -522,13 +1240,74 @@ void ejr_register_callback(EasyJSRHandle* handle, const char* fn_name, C_Callbac
  */
 void ejr_register_module(EasyJSRHandle* handle, const char* module_name, JSMethod* methods, size_t method_count);
 
+/**
+ * @brief Register a native class in JS, exposed as a global constructor.
+ * 
+ * Each JS object owns one native object, freed by finalizer when the GC collects it.
+ * Methods and properties live on the prototype and are called with the native object directly.
+ * 
+ * @param handle The easyjsr runtime.
+ * @param class_name Name of the class.
+ * @param constructor Creates the native object for `new`. If NULL, objects are only made with ejr_new_object.
+ * @param finalizer Frees a native object, can be NULL.
+ * @param opaque Opaque user data for the constructor and finalizer.
+ * 
+ * @return The class, alive as long as the handle. NULL on failure.
+ */
+EJRClass* ejr_register_class(EasyJSRHandle* handle, const char* class_name, C_Constructor constructor, C_Finalizer finalizer, void* opaque);
+
+/**
+ * @brief Add a method to a class.
+ * 
+ * @param handle The easyjsr runtime.
+ * @param cls The class.
+ * @param name Name of the method.
+ * @param method The C method.
+ * @param opaque Opaque user data.
+ */
+void ejr_class_add_method(EasyJSRHandle* handle, EJRClass* cls, const char* name, C_Method method, void* opaque);
+
+/**
+ * @brief Add a property to a class. The setter gets the new value as its only arg.
+ * 
+ * @param handle The easyjsr runtime.
+ * @param cls The class.
+ * @param name Name of the property.
+ * @param getter Returns the value of the property.
+ * @param setter Sets the property, NULL for read only.
+ * @param opaque Opaque user data.
+ */
+void ejr_class_add_property(EasyJSRHandle* handle, EJRClass* cls, const char* name, C_Method getter, C_Method setter, void* opaque);
+
+/**
+ * @brief Wrap a native object in a JS object of a class. The JS object takes ownership of it.
+ * 
+ * @param handle The easyjsr runtime.
+ * @param cls The class.
+ * @param native The native object.
+ * 
+ * @return The id of the new object, -1 if EJR_MAX_LIVE_VALUES are alive.
+ */
+int ejr_new_object(EasyJSRHandle* handle, EJRClass* cls, void* native);
+
+/**
+ * @brief Get the native object of a JS object.
+ * 
+ * @param handle The easyjsr runtime.
+ * @param cls The class.
+ * @param value_id The objects id.
+ * 
+ * @return The native object, NULL if the value is not a object of the class.
+ */
+void* ejr_get_object(EasyJSRHandle* handle, EJRClass* cls, int value_id);
+
 /**
  * @brief Await a JSValue. Does not free the passed in value.
  * 
  * @param handle The easyjsr runtime.
  * @param value_id The Promise value
  * 
- * @return the Id of the awaited promise.
+ * @return the Id of the awaited promise, -1 if EJR_MAX_LIVE_VALUES are alive.
  */
 int ejr_await_promise(EasyJSRHandle* handle, int value_id);
 
@@ -547,6 +1326,43 @@ void ejr_free_string(char* c_string);
  */
 void ejr_free_jsvalue(EasyJSRHandle* handle, int value_id);
 
+/**
+ * @brief Start a scope. Every value id made until the matching ejr_scope_end belongs to it.
+ * 
+ * Scopes nest, the ids can still be freed one by one with ejr_free_jsvalue.
+ * 
+ * @param handle The easyjsr runtime associated.
+ */
+void ejr_scope_begin(EasyJSRHandle* handle);
+
+/**
+ * @brief End the innermost scope, freeing every value made in it that was not escaped.
+ * 
+ * @param handle The easyjsr runtime associated.
+ */
+void ejr_scope_end(EasyJSRHandle* handle);
+
+/**
+ * @brief Move a value out of the innermost scope into the one around it (or out of scopes).
+ * 
+ * @param handle The easyjsr runtime associated.
+ * @param value_id id of the value to escape.
+ * 
+ * @return value_id, which stays the same, or -1 if it is not a value.
+ */
+int ejr_scope_escape(EasyJSRHandle* handle, int value_id);
+
+/**
+ * @brief Check if a value id is still alive. Ids of freed values are reused, but
+ * a freed id stays invalid (for at least the next two million values freed).
+ * 
+ * @param handle The easyjsr runtime associated.
+ * @param value_id id of the value.
+ * 
+ * @return true if the id refers to a value that has not been freed.
+ */
+bool ejr_is_valid_jsvalue(EasyJSRHandle* handle, int value_id);
+
 /** 
  * @brief Convert a JSArg into a String. This is not the same as val_to_string.
  * The difference being that jsarg could be a value that never reaches the runtime. It's a 
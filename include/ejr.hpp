@@ -11,6 +11,13 @@
 #include <lib/quickjs_cpp_utils.hpp>
 #include <iostream>
 #include <tuple>
+#include <cstring>
+#include <string_view>
+#include <utility>
+#include <exception>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
 #include <lib/quickjs_cpp_utils.hpp>
 
 namespace ejr
@@ -40,13 +47,46 @@ namespace ejr
     {
         std::vector<T> values;
 
-        JSArgTypedArray(std::vector<T>&& values) : values(values) {}
-        JSArgTypedArray<T>(uint8_t* buffer_data, size_t element_count) {
-            auto arr = reinterpret_cast<T*>(buffer_data);
-            std::vector<T> bufferValues(arr, arr + element_count);
-            this->values = bufferValues;
+        JSArgTypedArray(std::vector<T>&& values) : values(std::move(values)) {}
+        JSArgTypedArray<T>(uint8_t* buffer_data, size_t element_count)
+            : values(reinterpret_cast<T*>(buffer_data), reinterpret_cast<T*>(buffer_data) + element_count) {}
+    };
+    /// @brief A borrowed view of a JS TypedArray for JSArg.
+    ///
+    /// Points straight into the ArrayBuffer, nothing is copied. It is only valid for the
+    /// duration of the callback it was passed to. Writes are visible to JS.
+    struct JSArgTypedArrayView
+    {
+        uint8_t* data;
+        size_t length;
+        JSTypedArrayEnum type;
+
+        JSArgTypedArrayView(uint8_t* data, size_t length, JSTypedArrayEnum type) : data(data), length(length), type(type) {}
+
+        /// @brief Get the elements as T.
+        template <typename T>
+        T* as() const
+        {
+            return reinterpret_cast<T*>(data);
         }
     };
+
+    /// @brief Check if a type is a JSArgTypedArray.
+    template <typename T>
+    struct is_typed_array : std::false_type
+    {
+    };
+
+    template <typename T>
+    struct is_typed_array<JSArgTypedArray<T>> : std::true_type
+    {
+    };
+
+    template <typename T>
+    inline constexpr bool is_typed_array_v = is_typed_array<T>::value;
+
+    struct JSArgObject;
+
     /// @brief A JSArg for dynamic typing.
     struct JSArg
     {
@@ -54,7 +94,6 @@ namespace ejr
             int,
             double,
             float,
-            long,
             std::string,
             bool,
             int64_t,
@@ -71,11 +110,14 @@ namespace ejr
             JSArgTypedArray<uint16_t>,
             JSArgTypedArray<uint64_t>,
             JSArgTypedArray<float>,
-            JSArgException>;
+            JSArgException,
+            JSArgTypedArrayView,
+            std::shared_ptr<JSArgObject>>;
 
         ValueType value;
 
         // Constructors for convenience
+        JSArg() : value(JSArgUndefined{}) {}
         JSArg(int v) : value(v) {}
         JSArg(double v) : value(v) {}
         JSArg(float v) : value(v) {}
@@ -87,13 +129,182 @@ namespace ejr
         JSArg(std::monostate) : value(JSArgUndefined{}) {}
         JSArg(std::vector<JSArg> &&vec) : value(std::make_shared<std::vector<JSArg>>(std::move(vec))) {}
         JSArg(const JSArgException& exec) : value(exec) {}
+        JSArg(const JSArgTypedArrayView& view) : value(view) {}
+        JSArg(JSArgObject &&object);
 
         template<typename T>
-        JSArg(JSArgTypedArray<T> v) : value(v) {}
+        JSArg(JSArgTypedArray<T> v) : value(std::move(v)) {}
+    };
+
+    /// @brief A object of ordered key/value pairs for JSArg.
+    ///
+    /// to_js builds records with the same keys in the same order from one cached template,
+    /// so they share their shape instead of adding properties one by one.
+    struct JSArgObject
+    {
+        std::vector<std::string> keys;
+        std::vector<JSArg> values;
+
+        /// @brief Set key to value, a existing key keeps its position.
+        JSArgObject &set(const std::string &key, JSArg value);
+
+        /// @brief Get the value of key, nullptr if it is missing.
+        const JSArg *get(const std::string &key) const;
+
+        size_t size() const
+        {
+            return keys.size();
+        }
+    };
+
+    inline JSArg::JSArg(JSArgObject &&object) : value(std::make_shared<JSArgObject>(std::move(object))) {}
+
+    /// @brief Type of a JSCompactArg.
+    enum class JSCompactType : uint8_t
+    {
+        Undefined,
+        Null,
+        Bool,
+        Int,
+        Int64,
+        Double,
+        /// @brief A string of up to JSCompactArg::inline_capacity bytes stored in the arg itself.
+        InlineString,
+        /// @brief A longer string stored in the JSCompactArgs buffer.
+        String,
+        /// @brief A slice of the JSCompactArgs elements.
+        Array,
+        /// @brief A borrowed view of a JS TypedArray.
+        TypedArray,
+        /// @brief A slice of two strings (message, name) in the JSCompactArgs elements.
+        Exception
+    };
+
+    /// @brief A compact 16 byte JSArg.
+    ///
+    /// Scalars and short strings live inline. Longer strings and array elements live
+    /// out of line in the JSCompactArgs that owns this arg and are addressed by offset.
+    ///
+    /// Layout: [0] type, [1] inline string size or typed array type, [2..15] inline string,
+    /// [4..7] out of line length, [8..15] payload.
+    class JSCompactArg
+    {
+    public:
+        static constexpr size_t inline_capacity = 14;
+
+        JSCompactArg() : JSCompactArg(JSCompactType::Undefined) {}
+
+        static JSCompactArg make_null() { return JSCompactArg(JSCompactType::Null); }
+        static JSCompactArg make_bool(bool value) { return with_payload(JSCompactType::Bool, value); }
+        static JSCompactArg make_int(int value) { return with_payload(JSCompactType::Int, value); }
+        static JSCompactArg make_int64(int64_t value) { return with_payload(JSCompactType::Int64, value); }
+        static JSCompactArg make_double(double value) { return with_payload(JSCompactType::Double, value); }
+
+        /// @brief Get the type.
+        JSCompactType type() const { return static_cast<JSCompactType>(bytes[0]); }
+
+        bool as_bool() const { return load<bool>(8); }
+        int as_int() const { return load<int>(8); }
+        int64_t as_int64() const { return load<int64_t>(8); }
+        double as_double() const { return load<double>(8); }
+
+        /// @brief Number of bytes (strings) or elements (arrays, typed arrays).
+        size_t length() const { return type() == JSCompactType::InlineString ? bytes[1] : load<uint32_t>(4); }
+
+    private:
+        friend class JSCompactArgs;
+
+        alignas(8) unsigned char bytes[16];
+
+        explicit JSCompactArg(JSCompactType type)
+        {
+            std::memset(bytes, 0, sizeof(bytes));
+            bytes[0] = static_cast<unsigned char>(type);
+        }
+
+        template <typename T>
+        static JSCompactArg with_payload(JSCompactType type, T value)
+        {
+            JSCompactArg arg(type);
+            arg.store<T>(8, value);
+            return arg;
+        }
+
+        template <typename T>
+        T load(size_t offset) const
+        {
+            T value;
+            std::memcpy(&value, bytes + offset, sizeof(T));
+            return value;
+        }
+
+        template <typename T>
+        void store(size_t offset, T value)
+        {
+            std::memcpy(bytes + offset, &value, sizeof(T));
+        }
+    };
+
+    static_assert(sizeof(JSCompactArg) == 16, "JSCompactArg must stay 16 bytes");
+
+    /// @brief A list of JSCompactArg with a shared buffer for out of line payloads.
+    ///
+    /// Clearing keeps the memory around, so one instance can be reused for every call.
+    class JSCompactArgs
+    {
+    public:
+        size_t size() const { return args.size(); }
+        bool empty() const { return args.empty(); }
+        const JSCompactArg &operator[](size_t i) const { return args[i]; }
+        std::vector<JSCompactArg>::const_iterator begin() const { return args.begin(); }
+        std::vector<JSCompactArg>::const_iterator end() const { return args.end(); }
+
+        /// @brief Remove all args but keep the memory.
+        void clear();
+
+        /// @brief Append a scalar or inline arg.
+        void push_back(const JSCompactArg &arg) { args.push_back(arg); }
+
+        /// @brief Append a string, inline if short enough.
+        void push_string(std::string_view str) { args.push_back(make_string(str)); }
+
+        /// @brief Append a JSValue. Does not free the value.
+        ///
+        /// TypedArrays are borrowed, so the value must outlive these args.
+        void push_js(JSContext *ctx, JSValueConst value) { args.push_back(make_js(ctx, value)); }
+
+        /// @brief Get the string of a InlineString or String arg.
+        std::string_view string_of(const JSCompactArg &arg) const;
+
+        /// @brief Get the elements of a Array or Exception arg. There are arg.length() of them.
+        const JSCompactArg *elements_of(const JSCompactArg &arg) const;
+
+        /// @brief Get the view of a TypedArray arg.
+        JSArgTypedArrayView view_of(const JSCompactArg &arg) const;
+
+        /// @brief Convert a arg into a JSArg.
+        JSArg to_jsarg(const JSCompactArg &arg) const;
+
+    private:
+        /// @brief Top level args.
+        std::vector<JSCompactArg> args;
+        /// @brief Array and Exception elements.
+        std::vector<JSCompactArg> elements;
+        /// @brief Out of line string bytes.
+        std::vector<char> buffer;
+
+        JSCompactArg make_string(std::string_view str);
+        JSCompactArg make_js(JSContext *ctx, JSValueConst value);
+        JSCompactArg make_slice(JSCompactType type, const std::vector<JSCompactArg> &items);
+        JSCompactArg make_exception(const JSArgException &exception);
     };
 
     /// @brief A type for Dynamic Callbacks ([JSArgs]) -> JSArg
     using DynCallback = std::function<JSArg(const std::vector<JSArg> &)>;
+    /// @brief A type for Dynamic Callbacks taking compact args (JSCompactArgs) -> JSArg
+    using CompactCallback = std::function<JSArg(const JSCompactArgs &)>;
+    /// @brief A type for callbacks on the raw JSValues. argv is borrowed, returns a new value or JS_EXCEPTION.
+    using RawCallback = JSValue (*)(JSContext *ctx, int argc, JSValueConst *argv, void *opaque);
     /// @brief Shorthand for std::vector<JSArg>
     using JSArgs = std::vector<JSArg>;
     /// @brief Type for file loader function
@@ -133,13 +344,244 @@ namespace ejr
         }
     };
 
+    /// @brief A JS function resolved once and kept alive for repeated calls.
+    ///
+    /// Holds a reference to the function and its this object, it must be destroyed before the EasyJSR.
+    class PreparedFunction
+    {
+    private:
+        JSContext *ctx = nullptr;
+        JSValue function;
+        JSValue this_obj;
+        /// @brief Reused argument buffer.
+        std::vector<JSValue> argv;
+
+    public:
+        /// @brief Takes ownership of function and this_obj.
+        PreparedFunction(JSContext *ctx, JSValue function, JSValue this_obj);
+        ~PreparedFunction();
+
+        PreparedFunction(const PreparedFunction &) = delete;
+        PreparedFunction &operator=(const PreparedFunction &) = delete;
+        PreparedFunction(PreparedFunction &&other) noexcept;
+        PreparedFunction &operator=(PreparedFunction &&other) noexcept;
+
+        /// @brief false if the name did not resolve to a function.
+        bool is_function() const;
+
+        /// @brief Call the function. The result has to be freed.
+        JSValue call(const std::vector<JSArg> &args);
+
+        /// @brief Call the function with JSValues. argv is borrowed, the result has to be freed.
+        JSValue call(int argc, JSValueConst *argv);
+    };
+
+    /// @brief A property name interned once as a JSAtom, for repeated gets/sets without hashing the name.
+    ///
+    /// It must be destroyed before the EasyJSR.
+    class PropertyKey
+    {
+    private:
+        JSContext *ctx = nullptr;
+        JSAtom atom = JS_ATOM_NULL;
+
+    public:
+        /// @brief Takes ownership of atom.
+        PropertyKey(JSContext *ctx, JSAtom atom);
+        ~PropertyKey();
+
+        PropertyKey(const PropertyKey &) = delete;
+        PropertyKey &operator=(const PropertyKey &) = delete;
+        PropertyKey(PropertyKey &&other) noexcept;
+        PropertyKey &operator=(PropertyKey &&other) noexcept;
+
+        JSAtom get_atom() const;
+    };
+
+    /// @brief A value serialized by EasyJSR::serialize_value, readable by any EasyJSR on any thread.
+    class SerializedValue
+    {
+    private:
+        std::vector<uint8_t> bytes;
+        /// @brief SharedArrayBuffers the bytes point at, each kept alive by one reference.
+        std::vector<void *> shared_buffers;
+
+        friend class EasyJSR;
+
+    public:
+        SerializedValue() = default;
+        ~SerializedValue();
+
+        SerializedValue(const SerializedValue &) = delete;
+        SerializedValue &operator=(const SerializedValue &) = delete;
+        SerializedValue(SerializedValue &&other) noexcept;
+        SerializedValue &operator=(SerializedValue &&other) noexcept;
+
+        /// @brief The serialized bytes.
+        ///
+        /// Without SharedArrayBuffers they can be stored and read back later with EasyJSR::deserialize_value.
+        const std::vector<uint8_t> &data() const;
+
+        /// @brief true if the bytes point at SharedArrayBuffers, they are then only valid with this value.
+        bool has_shared_buffers() const;
+    };
+
+    /// @brief Compiled bytecode of scripts and modules, stored on disk across runs. See EasyJSR::set_bytecode_cache.
+    ///
+    /// Files are keyed by a hash of the source, file name, eval flags and the QuickJS version, so a changed
+    /// script or a upgraded QuickJS compiles again. One cache can be shared by many EasyJSRs and threads.
+    /// The bytecode is loaded as is, only point it at a directory you trust.
+    class BytecodeCache
+    {
+    private:
+        std::string directory;
+        std::atomic<size_t> hit_count{0};
+        std::atomic<size_t> miss_count{0};
+
+        std::string path_of(uint64_t key) const;
+
+    public:
+        /// @brief Store the files in directory, it is created if needed.
+        explicit BytecodeCache(const std::string &directory);
+
+        /// @brief The key of source evaluated as file_name with eval_flags.
+        static uint64_t key_of(const char *source, size_t length, const std::string &file_name, int eval_flags);
+
+        /// @brief Read the bytecode stored under key into out. Returns false if it is missing or damaged.
+        ///
+        /// Not counted, the caller knows if the bytecode was usable, see count_lookup.
+        bool load(uint64_t key, std::vector<uint8_t> &out);
+
+        /// @brief Store bytecode under key. The file is replaced atomically, readers never see half of it.
+        bool store(uint64_t key, const uint8_t *bytecode, size_t size);
+
+        /// @brief Count a lookup, as a hit if its bytecode was read and linked in a runtime.
+        void count_lookup(bool hit);
+
+        /// @brief Number of lookups that used stored bytecode.
+        size_t hits() const;
+
+        /// @brief Number of lookups that did not use stored bytecode.
+        size_t misses() const;
+    };
+
+    /// @brief Compiled bytecode of the modules imported through file loaders, shared by every EasyJSR of the process.
+    ///
+    /// Modules are keyed by their resolved name and a hash of their source, so a changed file compiles again.
+    /// A runtime importing a cached module reads its bytecode instead of parsing it. Safe to use from many threads.
+    class ModuleCache
+    {
+    private:
+        struct Entry
+        {
+            std::string name;
+            std::vector<uint8_t> bytecode;
+        };
+
+        mutable std::shared_mutex mutex;
+        std::unordered_map<uint64_t, std::shared_ptr<const Entry>> entries;
+        std::atomic<size_t> hit_count{0};
+        std::atomic<size_t> miss_count{0};
+
+    public:
+        /// @brief The cache of the process.
+        static ModuleCache &shared();
+
+        /// @brief The key of a module named name with source.
+        static uint64_t key_of(const std::string &name, const char *source, size_t length);
+
+        /// @brief Read the module stored under key into ctx. Returns nullptr if it is not cached.
+        JSModuleDef *load(JSContext *ctx, uint64_t key, const std::string &name);
+
+        /// @brief Store the bytecode of the compiled module under key.
+        void store(JSContext *ctx, uint64_t key, const std::string &name, JSValueConst module);
+
+        /// @brief Drop every module, runtimes already using them are not affected.
+        void clear();
+
+        /// @brief Number of modules cached.
+        size_t size() const;
+
+        /// @brief Number of imports that read cached bytecode.
+        size_t hits() const;
+
+        /// @brief Number of imports that had to compile.
+        size_t misses() const;
+    };
+
+    /// @brief A script or module in a bytecode bundle, see write_bytecode_bundle.
+    struct BytecodeBundleEntry
+    {
+        /// @brief The file name it was compiled as, modules are found by it when imported.
+        std::string_view name;
+        bool is_module;
+        const uint8_t *bytecode;
+        size_t size;
+    };
+
+    /// @brief Write entries as a bytecode bundle, like the ejrc tool does.
+    ///
+    /// A bundle is a header, a index of the entries with their names and the bytecode of every entry after it.
+    void write_bytecode_bundle(const std::vector<BytecodeBundleEntry> &entries, std::vector<uint8_t> &out);
+
+    /// @brief Read the index of a bundle, the entries point into bundle. Returns false if it is not a valid bundle.
+    bool read_bytecode_bundle(const uint8_t *bundle, size_t size, std::vector<BytecodeBundleEntry> &out);
+
+    /// @brief A bytecode bundle file mapped read only, see EasyJSR::mount_bytecode_bundle.
+    ///
+    /// Opening only reads the index, the bytecode of a module is paged in when a runtime first imports it.
+    /// The pages are shared by every runtime and process mapping the same file.
+    class MappedBytecodeBundle
+    {
+    private:
+        const uint8_t *data = nullptr;
+        size_t size = 0;
+        std::vector<BytecodeBundleEntry> entries;
+        std::unordered_map<std::string_view, size_t> modules_by_name;
+
+        MappedBytecodeBundle() = default;
+
+    public:
+        MappedBytecodeBundle(const MappedBytecodeBundle &) = delete;
+        MappedBytecodeBundle &operator=(const MappedBytecodeBundle &) = delete;
+        ~MappedBytecodeBundle();
+
+        /// @brief Map the bundle at path. Returns nullptr if it can not be mapped or is not a bundle.
+        static std::shared_ptr<MappedBytecodeBundle> open(const std::string &path);
+
+        /// @brief The module compiled as name, nullptr if the bundle has none.
+        const BytecodeBundleEntry *find_module(std::string_view name) const;
+
+        /// @brief Number of entries.
+        size_t entry_count() const;
+    };
+
+    /// @brief Atoms of the property names used by the conversions.
+    ///
+    /// QuickJS predefines them, so they are the same in every runtime and never need freeing.
+    struct CommonAtoms
+    {
+        JSAtom length;
+        JSAtom message;
+        JSAtom name;
+        JSAtom constructor;
+        JSAtom prototype;
+    };
+
+    /// @brief The CommonAtoms, looked up once.
+    const CommonAtoms &common_atoms(JSContext *ctx);
+
     /// @brief A method.
     struct JSMethod
     {
         std::string name;
         DynCallback callback;
+        /// @brief Used instead of callback when set.
+        RawCallback raw_callback = nullptr;
+        void *opaque = nullptr;
 
         JSMethod(const std::string &name, DynCallback callback);
+        JSMethod(const std::string &name, RawCallback raw_callback, void *opaque);
     };
 
     // Templates
@@ -153,48 +595,71 @@ namespace ejr
     }
 
     /// @brief get the JSClassID from a type
+    ///
+    /// Allocated once per type, the static initialization is thread-safe.
     template <typename T>
     JSClassID get_js_class_id()
     {
-        static JSClassID class_id = 0; // static ensures one per type
-        if (class_id == 0)
+        static const JSClassID class_id = []()
         {
-            JS_NewClassID(&class_id);
-        }
+            JSClassID id = 0;
+            return JS_NewClassID(&id);
+        }();
         return class_id;
     }
 
-    /// @brief Create a JS Typed Array
+    /// @brief Get the JSTypedArrayEnum of a typed array element type.
     template<typename T>
-    JSValue create_js_array_typed(JSContext* ctx, const JSArgTypedArray<T>& typed_array) {
-        // Get array type from T
-        JSTypedArrayEnum array_type;
-
+    constexpr JSTypedArrayEnum typed_array_type() {
         if constexpr (std::is_same_v<T, uint8_t>) {
-            array_type = JSTypedArrayEnum::JS_TYPED_ARRAY_UINT8;
+            return JSTypedArrayEnum::JS_TYPED_ARRAY_UINT8;
         } else if constexpr (std::is_same_v<T, int32_t>) {
-            array_type = JSTypedArrayEnum::JS_TYPED_ARRAY_INT32;
+            return JSTypedArrayEnum::JS_TYPED_ARRAY_INT32;
         } else if constexpr (std::is_same_v<T, uint32_t>) {
-            array_type = JSTypedArrayEnum::JS_TYPED_ARRAY_UINT32;
+            return JSTypedArrayEnum::JS_TYPED_ARRAY_UINT32;
         } else if constexpr (std::is_same_v<T, int64_t>) {
-            array_type = JSTypedArrayEnum::JS_TYPED_ARRAY_BIG_INT64;
+            return JSTypedArrayEnum::JS_TYPED_ARRAY_BIG_INT64;
         } else if constexpr (std::is_same_v<T, int8_t>) {
-            array_type = JSTypedArrayEnum::JS_TYPED_ARRAY_INT8;
+            return JSTypedArrayEnum::JS_TYPED_ARRAY_INT8;
         } else if constexpr (std::is_same_v<T, int16_t>) {
-            array_type = JSTypedArrayEnum::JS_TYPED_ARRAY_INT16;
+            return JSTypedArrayEnum::JS_TYPED_ARRAY_INT16;
         } else if constexpr (std::is_same_v<T, uint16_t>) {
-            array_type = JSTypedArrayEnum::JS_TYPED_ARRAY_UINT16;
+            return JSTypedArrayEnum::JS_TYPED_ARRAY_UINT16;
         } else if constexpr (std::is_same_v<T, uint64_t>) {
-            array_type = JSTypedArrayEnum::JS_TYPED_ARRAY_BIG_UINT64;
+            return JSTypedArrayEnum::JS_TYPED_ARRAY_BIG_UINT64;
         } else if constexpr (std::is_same_v<T, float>) {
-            array_type = JSTypedArrayEnum::JS_TYPED_ARRAY_FLOAT32;
+            return JSTypedArrayEnum::JS_TYPED_ARRAY_FLOAT32;
         } else {
             static_assert(sizeof(T) == 0, "Unsupported type for JS typed array");
         }
+    }
 
-        const uint8_t* values = reinterpret_cast<const uint8_t*>(typed_array.values.data());
+    /// @brief Get the size in bytes of a single element of a JSTypedArrayEnum.
+    inline size_t typed_array_element_size(JSTypedArrayEnum type) {
+        switch (type) {
+        case JSTypedArrayEnum::JS_TYPED_ARRAY_UINT8C:
+        case JSTypedArrayEnum::JS_TYPED_ARRAY_INT8:
+        case JSTypedArrayEnum::JS_TYPED_ARRAY_UINT8:
+            return 1;
+        case JSTypedArrayEnum::JS_TYPED_ARRAY_INT16:
+        case JSTypedArrayEnum::JS_TYPED_ARRAY_UINT16:
+        case JSTypedArrayEnum::JS_TYPED_ARRAY_FLOAT16:
+            return 2;
+        case JSTypedArrayEnum::JS_TYPED_ARRAY_INT32:
+        case JSTypedArrayEnum::JS_TYPED_ARRAY_UINT32:
+        case JSTypedArrayEnum::JS_TYPED_ARRAY_FLOAT32:
+            return 4;
+        default:
+            return 8;
+        }
+    }
+
+    /// @brief Wrap a ArrayBuffer in a JS Typed Array. Frees the buffer.
+    inline JSValue new_typed_array_from_buffer(JSContext* ctx, JSValue buffer, JSTypedArrayEnum array_type) {
+        if (JS_IsException(buffer)) {
+            return buffer;
+        }
 
-        JSValue buffer = JS_NewArrayBufferCopy(ctx, values, typed_array.values.size() * sizeof(T));
         JSValue argv[3] = { buffer, js_undefined(), js_undefined() };
         JSValue array = JS_NewTypedArray(ctx, 3, argv, array_type);
 
@@ -204,14 +669,442 @@ namespace ejr
         return array;
     }
 
+    /// @brief Create a JS Typed Array, copying the values.
+    template<typename T>
+    JSValue create_js_array_typed(JSContext* ctx, const JSArgTypedArray<T>& typed_array) {
+        const uint8_t* values = reinterpret_cast<const uint8_t*>(typed_array.values.data());
+
+        JSValue buffer = JS_NewArrayBufferCopy(ctx, values, typed_array.values.size() * sizeof(T));
+        return new_typed_array_from_buffer(ctx, buffer, typed_array_type<T>());
+    }
+
+    /// @brief Create a JS Typed Array, transfering ownership of the values.
+    ///
+    /// The vectors storage becomes the ArrayBuffer backing store, no bytes are copied.
+    /// It is released when the ArrayBuffer is garbage collected.
+    template<typename T>
+    JSValue create_js_array_typed(JSContext* ctx, JSArgTypedArray<T>&& typed_array) {
+        if (typed_array.values.empty()) {
+            // Nothing to transfer
+            return create_js_array_typed(ctx, static_cast<const JSArgTypedArray<T>&>(typed_array));
+        }
+
+        // Keep the storage alive on the heap until QuickJS is done with it.
+        auto* owned = new std::vector<T>(std::move(typed_array.values));
+        uint8_t* values = reinterpret_cast<uint8_t*>(owned->data());
+
+        auto free_func = [](JSRuntime* rt, void* opaque, void* ptr) {
+            delete static_cast<std::vector<T>*>(opaque);
+        };
+
+        JSValue buffer = JS_NewArrayBuffer(ctx, values, owned->size() * sizeof(T), free_func, owned, false);
+        if (JS_IsException(buffer)) {
+            // QuickJS only takes ownership on success.
+            delete owned;
+            return buffer;
+        }
+        return new_typed_array_from_buffer(ctx, buffer, typed_array_type<T>());
+    }
+
     // Utils
     /// @brief Convert a JSArgs type into a JSValue.
     JSValue to_js(JSContext *ctx, const JSArg &args);
+    /// @brief Convert a JSArgs type into a JSValue, moving typed arrays into JS without a copy.
+    JSValue to_js(JSContext *ctx, JSArg &&args);
     /// @brief Convert a JSValue into a JSArg
-    JSArg from_js(JSContext *ctx, JSValue value, bool force_free = true);
+    ///
+    /// If borrow_typed_arrays is set (and force_free is not) typed arrays become a JSArgTypedArrayView
+    /// instead of being copied. The view lives as long as the value does.
+    JSArg from_js(JSContext *ctx, JSValue value, bool force_free = true, bool borrow_typed_arrays = false);
+    /// @brief Convert a std::vector into a JS Array in one pass.
+    JSValue to_js_array(JSContext *ctx, const std::vector<JSArg> &values);
+    /// @brief Convert a std::vector<int> into a JS Array in one pass.
+    JSValue to_js_array(JSContext *ctx, const std::vector<int> &values);
+    /// @brief Convert a std::vector<double> into a JS Array in one pass.
+    JSValue to_js_array(JSContext *ctx, const std::vector<double> &values);
+    /// @brief Convert a std::vector<std::string> into a JS Array in one pass.
+    JSValue to_js_array(JSContext *ctx, const std::vector<std::string> &values);
+    /// @brief Convert a JS Array into a std::vector<JSArg>. Does not free the value.
+    ///
+    /// Returns false if the value is not a Array.
+    bool from_js_array(JSContext *ctx, JSValueConst value, std::vector<JSArg> &out);
+    /// @brief Convert a JS Array of int32s into a std::vector<int>. Does not free the value.
+    ///
+    /// Returns false if the value is not a Array or a element is not a int32.
+    bool from_js_array(JSContext *ctx, JSValueConst value, std::vector<int> &out);
+    /// @brief Convert a JS Array of numbers into a std::vector<double>. Does not free the value.
+    ///
+    /// Returns false if the value is not a Array or a element is not a number.
+    bool from_js_array(JSContext *ctx, JSValueConst value, std::vector<double> &out);
+    /// @brief Convert a JS Array of strings into a std::vector<std::string>. Does not free the value.
+    ///
+    /// Returns false if the value is not a Array or a element is not a string.
+    bool from_js_array(JSContext *ctx, JSValueConst value, std::vector<std::string> &out);
+    /// @brief Create a object with keys[i] set to values[i], the values are consumed.
+    ///
+    /// Goes through the record templates of the EasyJSR owning ctx, so same-shaped records share one shape.
+    JSValue new_record(JSContext *ctx, const std::string_view *keys, size_t count, JSValue *values);
+
+    /// @brief Build a record of count entries with new_record.
+    ///
+    /// key_at(i) returns a std::string_view and value_at(i) a new JSValue. Small records stay on the stack.
+    template <typename KeyAt, typename ValueAt>
+    JSValue record_to_js(JSContext *ctx, size_t count, KeyAt key_at, ValueAt value_at)
+    {
+        constexpr size_t inline_count = 16;
+        std::string_view inline_keys[inline_count];
+        JSValue inline_values[inline_count];
+        std::vector<std::string_view> heap_keys;
+        std::vector<JSValue> heap_values;
+
+        std::string_view *keys = inline_keys;
+        JSValue *values = inline_values;
+        if (count > inline_count)
+        {
+            heap_keys.resize(count);
+            heap_values.resize(count);
+            keys = heap_keys.data();
+            values = heap_values.data();
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            keys[i] = key_at(i);
+            values[i] = value_at(i);
+        }
+
+        return new_record(ctx, keys, count, values);
+    }
     /// @brief Convert a JSArg into a string, will return "unkown" if not vaild JSArg to string
     std::string jsarg_to_str(const JSArg &arg);
 
+    /// @brief Store a native pointer in two int32 JSValues, for a functions func_data.
+    ///
+    /// Int32 values are never boxed or refcounted, so reading it back is just two loads.
+    inline void pointer_to_js(void *ptr, JSValue out[2]) {
+        uint64_t address = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(ptr));
+        out[0] = JS_MKVAL(JS_TAG_INT, static_cast<int32_t>(static_cast<uint32_t>(address)));
+        out[1] = JS_MKVAL(JS_TAG_INT, static_cast<int32_t>(static_cast<uint32_t>(address >> 32)));
+    }
+
+    /// @brief Read back a pointer stored with pointer_to_js.
+    inline void *pointer_from_js(const JSValue data[2]) {
+        uint64_t low = static_cast<uint32_t>(JS_VALUE_GET_INT(data[0]));
+        uint64_t high = static_cast<uint32_t>(JS_VALUE_GET_INT(data[1]));
+        return reinterpret_cast<void *>(static_cast<uintptr_t>(low | (high << 32)));
+    }
+
+    /// @brief Converts a C++ type straight from/to a JSValue, without going through a JSArg.
+    ///
+    /// from_js_value returns false with a pending JS exception if the value can not be converted.
+    /// Values are borrowed, to_js_value returns a new value.
+    template<typename T, typename Enable = void>
+    struct JSConvert;
+
+    template<>
+    struct JSConvert<bool> {
+        static bool from_js_value(JSContext *ctx, JSValueConst value, bool &out) {
+            int result = JS_ToBool(ctx, value);
+            out = result > 0;
+            return result >= 0;
+        }
+        static JSValue to_js_value(JSContext *ctx, bool value) {
+            return JS_NewBool(ctx, value);
+        }
+    };
+
+    template<typename T>
+    struct JSConvert<T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool> && sizeof(T) <= 4>> {
+        static bool from_js_value(JSContext *ctx, JSValueConst value, T &out) {
+            if constexpr (std::is_same_v<T, uint32_t>) {
+                return JS_ToUint32(ctx, &out, value) == 0;
+            } else {
+                int32_t result;
+                if (JS_ToInt32(ctx, &result, value) < 0) {
+                    return false;
+                }
+                out = static_cast<T>(result);
+                return true;
+            }
+        }
+        static JSValue to_js_value(JSContext *ctx, T value) {
+            if constexpr (std::is_same_v<T, uint32_t>) {
+                return JS_NewUint32(ctx, value);
+            } else {
+                return JS_NewInt32(ctx, static_cast<int32_t>(value));
+            }
+        }
+    };
+
+    template<typename T>
+    struct JSConvert<T, std::enable_if_t<std::is_integral_v<T> && sizeof(T) == 8 && !std::is_same_v<T, JSValue>>> {
+        static bool from_js_value(JSContext *ctx, JSValueConst value, T &out) {
+            int64_t result;
+            // Accepts numbers and BigInts.
+            if (JS_ToInt64Ext(ctx, &result, value) < 0) {
+                return false;
+            }
+            out = static_cast<T>(result);
+            return true;
+        }
+        static JSValue to_js_value(JSContext *ctx, T value) {
+            // Same as to_js, 64 bit integers become BigInts.
+            if constexpr (std::is_signed_v<T>) {
+                return JS_NewBigInt64(ctx, static_cast<int64_t>(value));
+            } else {
+                return JS_NewBigUint64(ctx, static_cast<uint64_t>(value));
+            }
+        }
+    };
+
+    template<typename T>
+    struct JSConvert<T, std::enable_if_t<std::is_floating_point_v<T>>> {
+        static bool from_js_value(JSContext *ctx, JSValueConst value, T &out) {
+            double result;
+            if (JS_ToFloat64(ctx, &result, value) < 0) {
+                return false;
+            }
+            out = static_cast<T>(result);
+            return true;
+        }
+        static JSValue to_js_value(JSContext *ctx, T value) {
+            return JS_NewFloat64(ctx, static_cast<double>(value));
+        }
+    };
+
+    template<>
+    struct JSConvert<std::string> {
+        static bool from_js_value(JSContext *ctx, JSValueConst value, std::string &out) {
+            size_t length;
+            const char *str = JS_ToCStringLen(ctx, &length, value);
+            if (!str) {
+                return false;
+            }
+            out.assign(str, length);
+            JS_FreeCString(ctx, str);
+            return true;
+        }
+        static JSValue to_js_value(JSContext *ctx, const std::string &value) {
+            return JS_NewStringLen(ctx, value.data(), value.size());
+        }
+    };
+
+    /// @brief Raw values are passed through. Arguments are borrowed, a returned value is owned by JS.
+    template<>
+    struct JSConvert<JSValue> {
+        static bool from_js_value(JSContext *ctx, JSValueConst value, JSValue &out) {
+            out = value;
+            return true;
+        }
+        static JSValue to_js_value(JSContext *ctx, JSValue value) {
+            return value;
+        }
+    };
+
+    template<>
+    struct JSConvert<JSArg> {
+        static bool from_js_value(JSContext *ctx, JSValueConst value, JSArg &out) {
+            out = from_js(ctx, value, false);
+            return true;
+        }
+        static JSValue to_js_value(JSContext *ctx, JSArg &&value) {
+            return to_js(ctx, std::move(value));
+        }
+    };
+
+    /// @brief Arrays use the bulk converters, so only their element types are supported.
+    template<typename T>
+    struct JSConvert<std::vector<T>> {
+        static bool from_js_value(JSContext *ctx, JSValueConst value, std::vector<T> &out) {
+            if (!from_js_array(ctx, value, out)) {
+                JS_ThrowTypeError(ctx, "expected a array of the parameters element type");
+                return false;
+            }
+            return true;
+        }
+        static JSValue to_js_value(JSContext *ctx, const std::vector<T> &value) {
+            return to_js_array(ctx, value);
+        }
+    };
+
+    /// @brief Base of callbacks owned by a EasyJSR and reached through a pointer in func_data.
+    struct NativeCallback {
+        virtual ~NativeCallback() = default;
+    };
+
+    /// @brief Converts argv into the parameter types Args of a native function.
+    ///
+    /// QuickJS pads argv with undefined up to the functions declared length, so argv holds sizeof...(Args) values.
+    template<typename... Args>
+    struct TypedArgs {
+        /// @brief Call fn with the converted args.
+        /// @return false with a pending JS exception if a arg could not be converted.
+        template<typename Fn>
+        static bool apply(JSContext *ctx, JSValueConst *argv, Fn &&fn) {
+            return apply(ctx, argv, fn, std::index_sequence_for<Args...>{});
+        }
+
+        /// @brief Call fn with the converted args and convert its result of type R.
+        template<typename R, typename Fn>
+        static JSValue call(JSContext *ctx, JSValueConst *argv, Fn &&fn) {
+            JSValue result = js_undefined();
+            bool converted = apply(ctx, argv, [&](auto &&...values) {
+                if constexpr (std::is_void_v<R>) {
+                    fn(std::forward<decltype(values)>(values)...);
+                } else {
+                    result = JSConvert<std::decay_t<R>>::to_js_value(ctx, fn(std::forward<decltype(values)>(values)...));
+                }
+            });
+            return converted ? result : JS_EXCEPTION;
+        }
+
+    private:
+        template<typename Fn, size_t... I>
+        static bool apply(JSContext *ctx, JSValueConst *argv, Fn &fn, std::index_sequence<I...>) {
+            std::tuple<std::decay_t<Args>...> values;
+            bool converted = (JSConvert<std::decay_t<Args>>::from_js_value(ctx, argv[I], std::get<I>(values)) && ...);
+            if (!converted) {
+                return false;
+            }
+            fn(std::get<I>(std::move(values))...);
+            return true;
+        }
+    };
+
+    /// @brief A callback with a fixed C++ signature.
+    ///
+    /// call converts argv into the parameter types and the result into a JSValue directly.
+    template<typename F, typename R, typename... Args>
+    struct TypedCallback : NativeCallback {
+        F fn;
+
+        explicit TypedCallback(F fn) : fn(std::move(fn)) {}
+
+        static JSValue call(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv, int magic, JSValue *func_data) {
+            auto *self = static_cast<TypedCallback *>(pointer_from_js(func_data));
+            return TypedArgs<Args...>::template call<R>(ctx, argv, self->fn);
+        }
+    };
+
+    /// @brief Create the JS object of a native class instance, owning opaque.
+    ///
+    /// The prototype comes from new_target (when called through a constructor) or the class.
+    /// Returns JS_EXCEPTION without touching opaque on failure.
+    JSValue new_class_object(JSContext *ctx, JSClassID class_id, JSValueConst new_target, void *opaque);
+
+    /// @brief A member function of a native class T, called on the T of this.
+    template<typename T, typename M, typename R, typename... Args>
+    struct MethodCallback : NativeCallback {
+        M method;
+
+        explicit MethodCallback(M method) : method(method) {}
+
+        static JSValue call(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv, int magic, JSValue *func_data) {
+            auto *self = static_cast<MethodCallback *>(pointer_from_js(func_data));
+            // Throws a TypeError if this is not a T.
+            T *object = static_cast<T *>(JS_GetOpaque2(ctx, this_val, get_js_class_id<T>()));
+            if (!object) {
+                return JS_EXCEPTION;
+            }
+            return TypedArgs<Args...>::template call<R>(ctx, argv, [&](auto &&...values) -> decltype(auto) {
+                return (object->*(self->method))(std::forward<decltype(values)>(values)...);
+            });
+        }
+    };
+
+    /// @brief The JS constructor of a native class T, calls T(Args...).
+    template<typename T, typename... Args>
+    struct ConstructorCallback : NativeCallback {
+        /// @brief Only called with new, see EasyJSR::call_class_constructor.
+        static JSValue call(JSContext *ctx, JSValueConst new_target, int argc, JSValueConst *argv, int magic, JSValue *func_data) {
+            T *native = nullptr;
+            bool converted;
+            try {
+                converted = TypedArgs<Args...>::apply(ctx, argv, [&](auto &&...values) {
+                    native = new T(std::forward<decltype(values)>(values)...);
+                });
+            } catch (const std::exception &e) {
+                return JS_ThrowInternalError(ctx, "Constructor failed: %s", e.what());
+            }
+            if (!converted) {
+                return JS_EXCEPTION;
+            }
+
+            JSValue object = new_class_object(ctx, get_js_class_id<T>(), new_target, native);
+            if (JS_IsException(object)) {
+                delete native;
+            }
+            return object;
+        }
+    };
+
+    class EasyJSR;
+
+    /// @brief Reads properties of JS objects into the members of a struct T, through interned keys.
+    ///
+    /// ```cpp
+    /// ejr::FieldTable<Result> fields(runtime);
+    /// fields.field("id", &Result::id).field("score", &Result::score);
+    /// Result result;
+    /// fields.read(object, result);
+    /// ```
+    /// It must be destroyed before the EasyJSR.
+    template<typename T>
+    class FieldTable {
+    public:
+        explicit FieldTable(EasyJSR &runtime);
+
+        /// @brief Read property name into member, converted like a typed callback argument.
+        template<typename V>
+        FieldTable &field(const std::string &name, V T::*member);
+
+        /// @brief Fill out from object.
+        /// @return false with a pending JS exception if a property could not be read or converted.
+        bool read(JSValueConst object, T &out) const;
+
+    private:
+        struct Field {
+            PropertyKey key;
+            std::function<bool(JSContext *, JSValueConst, T &)> read;
+        };
+
+        JSContext *ctx;
+        EasyJSR *runtime;
+        std::vector<Field> fields;
+    };
+
+    /// @brief Adds methods and properties to a registered native class, see EasyJSR::register_class.
+    template<typename T>
+    class ClassBinding {
+    public:
+        explicit ClassBinding(EasyJSR *owner) : owner(owner) {}
+
+        /// @brief Add a method, called on the T of this.
+        template<typename R, typename... Args>
+        ClassBinding &method(const std::string &name, R (T::*method)(Args...));
+
+        template<typename R, typename... Args>
+        ClassBinding &method(const std::string &name, R (T::*method)(Args...) const);
+
+        /// @brief Add a read only property.
+        template<typename V>
+        ClassBinding &property(const std::string &name, V (T::*getter)() const);
+
+        /// @brief Add a property with a getter and setter.
+        template<typename V, typename S>
+        ClassBinding &property(const std::string &name, V (T::*getter)() const, void (T::*setter)(S));
+
+        /// @brief Frees the T of each object when it is collected.
+        static void finalize(JSRuntime *rt, JSValue value) {
+            delete static_cast<T *>(JS_GetOpaque(value, get_js_class_id<T>()));
+        }
+
+    private:
+        EasyJSR *owner;
+    };
+
+    class RecordTemplates;
+    class ContextTemplate;
+
     // EasyJSR class
     /**
      * @brief The easyjs runtime.
@@ -225,14 +1118,59 @@ namespace ejr
         /// @brief The context from quickjs.
         JSContext *ctx = nullptr;
 
-        /// @brief Callbacks
-        std::unordered_map<std::string, DynCallback> callbacks;
-
         /// @brief Make sure if the value is a exception we return a string of cause: $cause, message: $message
         std::tuple<JSValue, bool> clean_js_value(JSValue val);
 
-        /// @brief Create a trampoline that calls a callback from callbacks.
-        JSValue create_trampoline(const std::string &cb_name, DynCallback cb);
+        /// @brief Create a JS function that calls cb.
+        JSValue create_trampoline(DynCallback cb, bool borrow_typed_arrays = false);
+
+        /// @brief Native callbacks, each JS function points at its own through func_data.
+        ///
+        /// They live as long as the EasyJSR, so dispatch is a pointer load and one indirect call.
+        std::vector<std::unique_ptr<NativeCallback>> native_callbacks;
+
+        /// @brief Create a JS function that calls call with a pointer to native in its func_data. Takes ownership of native.
+        JSValue new_native_function(std::unique_ptr<NativeCallback> native, JSCFunctionData *call, int length);
+
+        /// @brief A constructor of a registered class.
+        struct ClassConstructor
+        {
+            std::unique_ptr<NativeCallback> native;
+            JSCFunctionData *construct;
+        };
+
+        /// @brief Constructors of the registered classes, their JS functions find them by magic.
+        ///
+        /// Data functions do not see the call flags, a constructor function does: QuickJS throws unless it is
+        /// called with new, so new_target is always a real new.target.
+        std::vector<ClassConstructor> class_constructors;
+
+        /// @brief The JS function of every class constructor, calls class_constructors[magic].
+        static JSValue call_class_constructor(JSContext *ctx, JSValueConst new_target, int argc, JSValueConst *argv, int magic);
+
+        /// @brief Register a callback of signature R(Args...) as a global function.
+        template<typename R, typename... Args, typename F>
+        void register_typed_callback(const std::string &fn_name, F &&callback, R (*)(Args...)) {
+            using Callback = TypedCallback<std::decay_t<F>, R, Args...>;
+            auto native = std::make_unique<Callback>(std::forward<F>(callback));
+            JSValue fn = this->new_native_function(std::move(native), &Callback::call, sizeof...(Args));
+
+            JSValue global = JS_GetGlobalObject(this->ctx);
+            JS_SetPropertyStr(this->ctx, global, fn_name.c_str(), fn);
+            this->free_jsval(global);
+        }
+
+        /// @brief Reusable compact args, one per nested compact callback call.
+        std::vector<std::unique_ptr<JSCompactArgs>> compact_args_pool;
+
+        /// @brief How many compact callbacks are currently running.
+        size_t compact_depth = 0;
+
+        /// @brief Create a JS function that calls cb with compact args.
+        JSValue create_compact_trampoline(CompactCallback cb);
+
+        /// @brief Create a JS function that calls cb with the raw JSValues.
+        JSValue create_raw_trampoline(RawCallback cb, void *opaque);
 
         /// @brief Unmangled names of methods with their JSValue.
         std::unordered_map<std::string, std::vector<std::tuple<std::string, JSValue>>> methods_by_module;
@@ -240,13 +1178,46 @@ namespace ejr
         /// @brief internal file loader. Set via set_file_loader
         FileLoaderFn file_loader_fn;
 
+        /// @brief Template objects of the records built by to_js, one per key set.
+        std::unique_ptr<RecordTemplates> record_templates;
+
+        /// @brief Bytecode of evaluated scripts and modules, see set_bytecode_cache.
+        std::shared_ptr<BytecodeCache> bytecode_cache;
+
+        /// @brief Whether imports go through ModuleCache::shared().
+        bool use_module_cache = true;
+
+        /// @brief Bundles imports are looked up in, see mount_bytecode_bundle.
+        std::vector<std::shared_ptr<MappedBytecodeBundle>> mounted_bundles;
+
+        /// @brief Objects the natives of this runtime point to, see keep_alive.
+        std::vector<std::shared_ptr<void>> kept_alive;
+
+        /// @brief eval through the bytecode cache, compiling on a miss.
+        JSValue eval_cached(const std::string &js, const std::string &file_name, int eval_flags);
+
+        /// @brief A runtime with the base objects and the ContextTemplate::Intrinsic built-ins in intrinsics.
+        explicit EasyJSR(uint32_t intrinsics);
+
     public:
         EasyJSR();
         ~EasyJSR();
 
+        /// @brief A runtime stamped from context_template, its registrations and prelude already in place.
+        explicit EasyJSR(const ContextTemplate &context_template);
+
+        /// @brief Keep object alive until the runtime is freed, like the state of a raw callback.
+        void keep_alive(std::shared_ptr<void> object);
+
         /// @brief initiate a module statically
         static int module_init(JSContext *ctx, JSModuleDef *m);
 
+        /// @brief Get the EasyJSR owning ctx, nullptr if ctx was not created by one.
+        static EasyJSR *from_context(JSContext *ctx);
+
+        /// @brief Create a object with keys[i] set to values[i] from the template of its key set, see ejr::new_record.
+        JSValue new_record(const std::string_view *keys, size_t count, JSValue *values);
+
         /// @brief Set a file loader function.
         void set_file_loader(FileLoaderFn func);
 
@@ -265,6 +1236,38 @@ namespace ejr
         /// @brief a really easy way to run a JS module. No strings attached, very plain way.
         JSValue eval_module(const std::string &js, const std::string &file_name);
 
+        /// @brief Parse JSON straight from a buffer, without copying it.
+        ///
+        /// Like JS_ParseJSON, json[length] must be '\0'. Returns JS_EXCEPTION if the JSON is invalid.
+        JSValue parse_json(const char *json, size_t length, const std::string &file_name = "<json>");
+
+        /// @brief Parse a JSON string, see parse_json.
+        JSValue parse_json(const std::string &json, const std::string &file_name = "<json>");
+
+        /// @brief JSON.stringify value and hand the UTF-8 text to sink in one piece.
+        ///
+        /// ASCII output goes straight from the JS string to sink, with no copy.
+        /// Returns false with a pending exception if stringify throws, or false if value has no JSON form (undefined, a function).
+        bool stringify_json(JSValueConst value, const std::function<void(const char *, size_t)> &sink);
+
+        /// @brief JSON.stringify value, appending to out so its capacity is reused. See stringify_json.
+        bool stringify_json(JSValueConst value, std::string &out);
+
+        /// @brief Serialize value with the structured clone format of QuickJS (JS_WriteObject).
+        ///
+        /// Keeps types JSON loses: typed arrays, Dates, BigInts, undefined, cycles and shared references.
+        /// With allow_shared, SharedArrayBuffers are passed by reference instead of failing.
+        /// Returns false with a pending exception for values that can not be cloned, like functions.
+        bool serialize_value(JSValueConst value, SerializedValue &out, bool allow_shared = false);
+
+        /// @brief Read a value written by serialize_value, in this or any other EasyJSR.
+        ///
+        /// Returns JS_EXCEPTION if the bytes are not valid.
+        JSValue deserialize_value(const SerializedValue &value);
+
+        /// @brief Read a value from stored serialize_value bytes. SharedArrayBuffers are rejected.
+        JSValue deserialize_value(const uint8_t *bytes, size_t size);
+
         /// @brief free a JSValue using this runtimes context.
         void free_jsval(JSValue value);
 
@@ -272,177 +1275,329 @@ namespace ejr
         void free_jsvals(const std::vector<JSValue> &js_args);
 
         /// @brief evaluate JS with strings attached.
+        ///
+        /// Goes through the bytecode cache if one is set, unless JS_EVAL_FLAG_COMPILE_ONLY is passed.
         JSValue eval(const std::string &js, const std::string &file_name, int eval_flags);
 
+        /// @brief Cache the bytecode of eval, eval_script and eval_module in cache, nullptr turns it off.
+        void set_bytecode_cache(std::shared_ptr<BytecodeCache> cache);
+
+        /// @brief The bytecode cache, nullptr if there is none.
+        const std::shared_ptr<BytecodeCache> &get_bytecode_cache() const;
+
+        /// @brief Read modules imported through the file loader from ModuleCache::shared(), on by default.
+        ///
+        /// Modules this runtime compiles are added to it, so every other runtime of the process skips parsing them.
+        void set_module_cache_enabled(bool enabled);
+
+        /// @brief Whether imports go through ModuleCache::shared().
+        bool module_cache_enabled() const;
+
+        /// @brief Import modules from bundle, before the file loader. Nothing is read until a module is imported.
+        ///
+        /// Native modules come first, then the mounted bundles in mount order.
+        void mount_bytecode_bundle(std::shared_ptr<MappedBytecodeBundle> bundle);
+
+        /// @brief Read the module name of a mounted bundle into the context, nullptr if no bundle has it.
+        ///
+        /// Also nullptr, with a exception pending, if the entry is unreadable or not module bytecode.
+        JSModuleDef *load_bundled_module(const std::string &name);
+
+        /// @brief Compile js to bytecode without running it, for write_bytecode_bundle.
+        ///
+        /// eval_flags picks JS_EVAL_TYPE_GLOBAL or JS_EVAL_TYPE_MODULE. strip drops the source and debug info,
+        /// so function toString and error locations are lost. Returns false with a pending exception on syntax errors.
+        bool compile_bytecode(const std::string &js, const std::string &file_name, int eval_flags, std::vector<uint8_t> &out, bool strip = false);
+
+        /// @brief Evaluate a bytecode bundle made by ejrc, skipping parsing and compiling.
+        ///
+        /// All modules are loaded first so they can import each other, then every entry runs in bundle order.
+        /// Returns the value of the last entry, or JS_EXCEPTION. With in_place, the bytecode is used from bundle
+        /// instead of copied, bundle must then outlive this EasyJSR, like the array of a ejrc header does.
+        JSValue eval_bytecode(const uint8_t *bundle, size_t size, bool in_place = false);
+
         /// @brief evalute a function from the current global context.
         JSValue eval_function(const std::string &fnName, const std::vector<JSArg> &args);
 
         /// @brief convert a JSValue into a std::string with the current context.
         std::string val_to_string(JSValue value, bool free = true);
 
+        /// @brief The quickjs context, for converting values without going through JSArg.
+        JSContext *get_context();
+
         /// @brief Get a Value from globalThis
         JSValue get_from_global(const std::string &name);
 
         /// @brief Evalute a function on a class/object.
         JSValue eval_class_function(JSValue obj, const std::string &fn_name, const std::vector<JSArg> &args);
 
+        /// @brief Resolve a function from the global context once, for calling it many times.
+        PreparedFunction prepare_function(const std::string &fn_name);
+
+        /// @brief Resolve a function on a class/object once, for calling it many times. Does not free obj.
+        PreparedFunction prepare_class_function(JSValue obj, const std::string &fn_name);
+
         /// @brief get a property from a JSValue object
         JSValue get_property_from(JSValue object, std::string property);
 
+        /// @brief Intern a property name once, for get_property_from and set_property.
+        PropertyKey intern_key(const std::string &property);
+
+        /// @brief get a property from a JSValue object through a interned key.
+        JSValue get_property_from(JSValueConst object, const PropertyKey &key);
+
+        /// @brief set a property on a JSValue object through a interned key. Takes ownership of value.
+        /// @return false with a pending exception if the set failed.
+        bool set_property(JSValueConst object, const PropertyKey &key, JSValue value);
+
         /// @brief Wrap a JSValue in a EJRValue for RAII
         EJRValue wrap_js_val(JSValue val);
 
         /// @brief register a callback 
-        void register_callback(const std::string &fn_name, DynCallback callback);
+        ///
+        /// If borrow_typed_arrays is set, typed array arguments are passed as JSArgTypedArrayView.
+        void register_callback(const std::string &fn_name, DynCallback callback, bool borrow_typed_arrays = false);
+
+        /// @brief register a callback with a fixed signature, e.g. register_callback<int(int, int)>("add", add).
+        ///
+        /// Arguments are converted straight into the parameter types, no JSArg or std::vector is built.
+        /// Supported types are the ones with a JSConvert.
+        template<typename Sig, typename F>
+        void register_callback(const std::string &fn_name, F &&callback) {
+            this->register_typed_callback(fn_name, std::forward<F>(callback), static_cast<Sig *>(nullptr));
+        }
+
+        /// @brief register a function pointer as a typed callback, the signature is deduced.
+        template<typename R, typename... Args, typename = std::enable_if_t<!std::is_convertible_v<R (*)(Args...), DynCallback>>>
+        void register_callback(const std::string &fn_name, R (*callback)(Args...)) {
+            this->register_typed_callback(fn_name, callback, callback);
+        }
+
+        /// @brief register a callback that takes compact args.
+        ///
+        /// Avoids building a std::vector<JSArg> per call. The args are only valid during the call.
+        void register_compact_callback(const std::string &fn_name, CompactCallback callback);
+
+        /// @brief register a callback that converts its own arguments.
+        ///
+        /// Nothing is converted for it, opaque is passed through as is.
+        void register_raw_callback(const std::string &fn_name, RawCallback callback, void *opaque);
 
         /// @brief register a module 
         void register_module(const std::string &module_name, const std::vector<JSMethod> &methods);
 
+        /// @brief Register a native class T with the runtime, its instances own a T freed by the GC.
+        ///
+        /// `new class_name(...)` from JS calls T(CtorArgs...). With no CtorArgs and no default
+        /// constructor, the class can only be made through new_object.
+        ///
+        /// ```cpp
+        /// runtime.register_class<Counter, int>("Counter")
+        ///     .method("add", &Counter::add)
+        ///     .property("value", &Counter::get, &Counter::set);
+        /// ```
+        template<typename T, typename... CtorArgs>
+        ClassBinding<T> register_class(const std::string &class_name) {
+            JSClassID class_id = get_js_class_id<T>();
+            if constexpr (std::is_constructible_v<T, CtorArgs...>) {
+                using Constructor = ConstructorCallback<T, CtorArgs...>;
+                this->define_class(class_id, class_name, &ClassBinding<T>::finalize,
+                    std::make_unique<Constructor>(), &Constructor::call, sizeof...(CtorArgs));
+            } else {
+                this->define_class(class_id, class_name, &ClassBinding<T>::finalize, nullptr, nullptr, 0);
+            }
+            return ClassBinding<T>(this);
+        }
+
+        /// @brief Wrap a native object of a registered class, the JS object takes ownership of it.
+        template<typename T>
+        JSValue new_object(T *native) {
+            JSValue object = new_class_object(this->ctx, get_js_class_id<T>(), js_undefined(), native);
+            if (JS_IsException(object)) {
+                delete native;
+            }
+            return object;
+        }
+
+        /// @brief Get the native object of a JS object, nullptr if it is not a T.
+        template<typename T>
+        T *get_object(JSValueConst object) {
+            return static_cast<T *>(JS_GetOpaque(object, get_js_class_id<T>()));
+        }
+
+        /// @brief Register a class, exposing its constructor as a global.
+        ///
+        /// finalizer frees the opaque of each object. Without a constructor the global
+        /// throws when called, objects are made with new_class_object.
+        /// @return false if QuickJS refused the class, nothing is defined then.
+        bool define_class(JSClassID class_id, const std::string &class_name, JSClassFinalizer *finalizer,
+            std::unique_ptr<NativeCallback> constructor, JSCFunctionData *construct, int length);
+
+        /// @brief Add a method to the prototype of a registered class.
+        void define_class_method(JSClassID class_id, const std::string &name,
+            std::unique_ptr<NativeCallback> native, JSCFunctionData *call, int length);
+
+        /// @brief Add a accessor property to the prototype of a registered class. setter may be null.
+        void define_class_property(JSClassID class_id, const std::string &name,
+            std::unique_ptr<NativeCallback> getter, JSCFunctionData *get,
+            std::unique_ptr<NativeCallback> setter, JSCFunctionData *set);
+
         /// @brief Await a promise.
         ///
         /// Does not free the passed in value.
         JSValue await_promise(JSValue value);
+    };
+
+    /// @brief A prelude captured once and stamped into new runtimes, see EasyJSR(const ContextTemplate &).
+    ///
+    /// Holds the native registrations in order and the prelude scripts compiled to bytecode, so a new runtime
+    /// skips parsing them. QuickJS can not snapshot a context, each runtime still builds its own built-ins:
+    /// leave out the ones the prelude does not need with set_intrinsics, and prewarm runtimes ahead of time to
+    /// hand them out in microseconds. Set the template up from one thread, instantiate and prewarm are then
+    /// safe from many.
+    class ContextTemplate
+    {
+    public:
+        /// @brief Optional built-ins. The base objects, eval, JSON and Promise are always there.
+        enum Intrinsic : uint32_t
+        {
+            Date = 1 << 0,
+            RegExp = 1 << 1,
+            Proxy = 1 << 2,
+            MapSet = 1 << 3,
+            /// @brief Also ArrayBuffer, typed array JSArgs need it.
+            TypedArrays = 1 << 4,
+            WeakRef = 1 << 5,
+            AllIntrinsics = (1 << 6) - 1
+        };
+
+        /// @brief A step of the prelude, run on every new runtime.
+        using Step = std::function<void(EasyJSR &)>;
+
+        ContextTemplate() = default;
+        ContextTemplate(const ContextTemplate &) = delete;
+        ContextTemplate &operator=(const ContextTemplate &) = delete;
+        ~ContextTemplate();
+
+        /// @brief Pick the optional built-ins, a mask of Intrinsic. All of them by default.
+        void set_intrinsics(uint32_t intrinsics);
+
+        /// @brief The optional built-ins.
+        uint32_t get_intrinsics() const;
+
+        /// @brief Register a callback in every runtime, see EasyJSR::register_callback.
+        void register_callback(const std::string &fn_name, DynCallback callback, bool borrow_typed_arrays = false);
+
+        /// @brief Register a compact callback in every runtime, see EasyJSR::register_compact_callback.
+        void register_compact_callback(const std::string &fn_name, CompactCallback callback);
+
+        /// @brief Register a raw callback in every runtime, see EasyJSR::register_raw_callback.
+        void register_raw_callback(const std::string &fn_name, RawCallback callback, void *opaque);
+
+        /// @brief Register a module in every runtime, see EasyJSR::register_module.
+        void register_module(const std::string &module_name, const std::vector<JSMethod> &methods);
+
+        /// @brief Run step on every runtime, for anything else like register_class or set_file_loader.
+        void add_step(Step step);
+
+        /// @brief Compile a prelude script once, every runtime then runs its bytecode.
+        ///
+        /// It is run once here too, returns false with get_error set if it does not compile or throws.
+        bool add_prelude_script(const std::string &js, const std::string &file_name);
+
+        /// @brief Compile a prelude module once, see add_prelude_script.
+        bool add_prelude_module(const std::string &js, const std::string &file_name);
+
+        /// @brief Why the last add_prelude_script or add_prelude_module failed.
+        const std::string &get_error() const;
+
+        /// @brief Run the registrations and the prelude on runtime.
+        void apply(EasyJSR &runtime) const;
+
+        /// @brief A new runtime, a prewarmed one if there is any.
+        std::unique_ptr<EasyJSR> instantiate();
+
+        /// @brief Make count runtimes ahead of time for instantiate, e.g. from a background thread.
+        void prewarm(size_t count);
+
+        /// @brief Number of prewarmed runtimes left.
+        size_t prewarmed() const;
+
+    private:
+        uint32_t intrinsics = AllIntrinsics;
+        std::vector<Step> steps;
+        std::string error;
 
-        // /// @brief register a CPP class (Runtime only).
-        // template<typename T>
-        // inline void register_class(const std::string &class_name, std::vector<PublicMethod> public_methods) {
-        //     // Register a new class id
-        //     static JSClassID class_id = get_js_class_id<T>();
-
-        //     // Register the class definition
-        //     JSClassDef def{};
-        //     def.class_name = class_name.c_str();
-        //     def.finalizer = [](JSRuntime* rt, JSValue val) {
-        //         // Free memory
-        //         if (auto* t = static_cast<T*>(JS_GetOpaque(val, class_id))) {
-        //             delete t;
-        //         }
-        //     };
-
-        //     // Register new class
-        //     if (JS_NewClass(this->runtime, class_id, &def) < 0) {
-        //         // Some kind of error happened here
-        //         // TODO: save some kind of error.
-        //         return;
-        //     }
-
-        //     // Constructor
-        //     auto t_ctor = [](JSContext* ctx, JSValueConst new_target, int argc, JSValueConst* argv) {
-        //         // Build vector<JSArg>
-        //         std::vector<JSArg> args;
-        //         args.reserve(argc);
-        //         for (int i = 0; i < argc; ++i) {
-        //             args.push_back(from_js(ctx, argv[i]));
-        //         }
-
-        //         // Allocate JS Object
-        //         JSValue obj = JS_NewObjectClass(ctx, class_id);
-        //         if (JS_IsException(obj)) {
-        //             return obj;
-        //         }
-
-        //         // Construct native object
-        //         T* t = nullptr;
-        //         try {
-        //             t = new T(args);
-        //         } catch (const std::exception& e) {
-        //             JS_FreeValue(ctx, obj);
-        //             return JS_ThrowInternalError(ctx, ("Constructor failed: " + std::string(e.what())).c_str());
-        //         }
-
-        //         // Link native object to JS object
-        //         JS_SetOpaque(obj, t);
-
-        //         return obj;
-        //     };
-
-        //     // Constructor func
-        //     JSValue t_ctor_func = JS_NewCFunction2(
-        //         this->ctx,
-        //         t_ctor,
-        //         class_name.c_str(),
-        //         1,
-        //         JS_CFUNC_constructor,
-        //         0
-        //     );
-
-        //     // Create prototype object
-        //     JSValue proto = JS_NewObject(this->ctx);
-
-        //     // Mangle the prototype name to the callbcks names
-        //     std::string mangled_name = "___" + class_name + "___";
-
-        //     // Bind methods to prototype
-        //     for (size_t i = 0 ; i < public_methods.size(); i++) {
-        //         auto& m = public_methods[i];
-
-        //         auto method_wrapper = [](JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv, int magic, JSValue* func_data) -> JSValue {
-        //             std::cout << "Before recover PublicMethod ptr" << std::endl;
-        //             EasyJSR *self = reinterpret_cast<EasyJSR *>(JS_VALUE_GET_PTR(func_data[0]));
-
-        //             // Collect args as JSArg
-        //             std::vector<JSArg> args;
-        //             args.reserve(argc + 1);
-        //             std::cout << "Here 3" << std::endl;
-
-        //             // Push "this" pointer
-        //             if (T* obj_ptr = static_cast<T*>(JS_GetOpaque(this_val, class_id))) {
-        //                 args.push_back(reinterpret_cast<uintptr_t>(obj_ptr));
-        //             }
-        //             std::cout << "Here 4" << std::endl;
-
-        //             // Convert argv[]
-        //             for (int i = 0; i < argc; ++i) {
-        //                 args.push_back(from_js(ctx, argv[i], false));
-        //             }
-        //             std::cout << "Here 5" << std::endl;
-
-        //             // Lookup callback by magic
-        //             const char *cbname_cstr = JS_ToCString(ctx, func_data[1]);
-        //             std::string cb_name(cbname_cstr);
-        //             JS_FreeCString(ctx, cbname_cstr);
-
-        //             auto it = self->callbacks.find(cb_name);
-        //             if (it == self->callbacks.end())
-        //             {
-        //                 return js_undefined();
-        //             }
-
-        //             // Call C++ callback
-        //             JSArg result = it->second(args);
-
-        //             // Convert result back to JS
-        //             return to_js(ctx, result);
-        //         };
-
-        //         // Copy callback into callbcaks
-        //         std::string mangled_callback_name = mangled_name + m.name;
-        //         this->callbacks[mangled_callback_name] = public_methods[i].callback;
-
-        //         // Store pointer in func_data
-        //         JSValue func_data[2];
-
-        //         // Store name and EasyJSR pointer
-        //         func_data[0] = this->js_ptr;
-        //         func_data[1] = JS_NewString(this->ctx, mangled_callback_name.c_str());
-
-        //         JSValue fn = JS_NewCFunctionData(this->ctx, method_wrapper, 0, 0, 2, func_data);
-
-        //         JS_SetPropertyStr(this->ctx, proto, m.name.c_str(), fn);
-        //     }
-
-        //     // Attach prototype constructor
-        //     JS_SetConstructor(this->ctx, t_ctor_func, proto);
-
-        //     // Expose globally
-        //     auto global = JS_GetGlobalObject(this->ctx);
-        //     JS_SetPropertyStr(this->ctx, global, class_name.c_str(), t_ctor_func);
-
-        //     // Free global
-        //     this->free_jsval(global);
-        // }
-
-        // /// @brief Register a class dynamically (Runtime only)
-        // void register_dynamic_class();
+        mutable std::mutex pool_mutex;
+        std::vector<std::unique_ptr<EasyJSR>> pool;
+
+        bool add_prelude(const std::string &js, const std::string &file_name, int eval_flags);
+
+        /// @brief Add a step, prewarmed runtimes miss it so they are dropped.
+        void add(Step step);
     };
+
+    template<typename T>
+    FieldTable<T>::FieldTable(EasyJSR &runtime) : ctx(runtime.get_context()), runtime(&runtime) {}
+
+    template<typename T>
+    template<typename V>
+    FieldTable<T> &FieldTable<T>::field(const std::string &name, V T::*member) {
+        auto read = [member](JSContext *ctx, JSValueConst value, T &out) {
+            return JSConvert<V>::from_js_value(ctx, value, out.*member);
+        };
+        this->fields.push_back(Field{this->runtime->intern_key(name), read});
+        return *this;
+    }
+
+    template<typename T>
+    bool FieldTable<T>::read(JSValueConst object, T &out) const {
+        for (const Field &field : this->fields) {
+            JSValue value = JS_GetProperty(this->ctx, object, field.key.get_atom());
+            if (JS_IsException(value)) {
+                return false;
+            }
+            bool converted = field.read(this->ctx, value, out);
+            JS_FreeValue(this->ctx, value);
+            if (!converted) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template<typename T>
+    template<typename R, typename... Args>
+    ClassBinding<T> &ClassBinding<T>::method(const std::string &name, R (T::*method)(Args...)) {
+        using Callback = MethodCallback<T, R (T::*)(Args...), R, Args...>;
+        this->owner->define_class_method(get_js_class_id<T>(), name, std::make_unique<Callback>(method), &Callback::call, sizeof...(Args));
+        return *this;
+    }
+
+    template<typename T>
+    template<typename R, typename... Args>
+    ClassBinding<T> &ClassBinding<T>::method(const std::string &name, R (T::*method)(Args...) const) {
+        using Callback = MethodCallback<T, R (T::*)(Args...) const, R, Args...>;
+        this->owner->define_class_method(get_js_class_id<T>(), name, std::make_unique<Callback>(method), &Callback::call, sizeof...(Args));
+        return *this;
+    }
+
+    template<typename T>
+    template<typename V>
+    ClassBinding<T> &ClassBinding<T>::property(const std::string &name, V (T::*getter)() const) {
+        using Getter = MethodCallback<T, V (T::*)() const, V>;
+        this->owner->define_class_property(get_js_class_id<T>(), name, std::make_unique<Getter>(getter), &Getter::call, nullptr, nullptr);
+        return *this;
+    }
+
+    template<typename T>
+    template<typename V, typename S>
+    ClassBinding<T> &ClassBinding<T>::property(const std::string &name, V (T::*getter)() const, void (T::*setter)(S)) {
+        using Getter = MethodCallback<T, V (T::*)() const, V>;
+        using Setter = MethodCallback<T, void (T::*)(S), void, S>;
+        this->owner->define_class_property(get_js_class_id<T>(), name,
+            std::make_unique<Getter>(getter), &Getter::call,
+            std::make_unique<Setter>(setter), &Setter::call);
+        return *this;
+    }
 };
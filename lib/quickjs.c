@@ -8882,6 +8882,79 @@ static JSValue js_allocate_fast_array(JSContext *ctx, int64_t len)
     return arr;
 }
 
+/* Create a fast array of 'len' undefined elements. Its storage is
+   returned in '*pvalues' so that the caller can fill it in place. The
+   storage is only valid until the array is modified. */
+JSValue JS_NewFastArray(JSContext *ctx, uint32_t len, JSValue **pvalues)
+{
+    JSValue arr;
+    JSObject *p;
+    uint32_t i;
+
+    *pvalues = NULL;
+    arr = js_allocate_fast_array(ctx, len);
+    if (JS_IsException(arr))
+        return arr;
+    if (len > 0) {
+        p = JS_VALUE_GET_OBJ(arr);
+        for(i = 0; i < len; i++)
+            p->u.array.u.values[i] = JS_UNDEFINED;
+        p->prop[0].u.value = JS_NewInt32(ctx, len);
+        *pvalues = p->u.array.u.values;
+    }
+    return arr;
+}
+
+/* Access an Array's internal JSValue array if it is a fast array. The
+   values are not duplicated and are only valid until the array is
+   modified. */
+JS_BOOL JS_GetFastArray(JSContext *ctx, JSValueConst obj,
+                        JSValue **arrpp, uint32_t *countp)
+{
+    return js_get_fast_array(ctx, obj, arrpp, countp);
+}
+
+/* Create a plain object with the same shape as 'template_obj'. Its
+   properties must all be configurable, writable and enumerable data
+   properties. 'values' gets one value per property, in definition order,
+   and is always freed. The objects share the template's shape, so no
+   property is looked up or added one by one. */
+JSValue JS_NewObjectFromTemplate(JSContext *ctx, JSValueConst template_obj,
+                                 JSValue *values, int count)
+{
+    JSObject *p, *tp;
+    JSShape *sh;
+    JSShapeProperty *prs;
+    JSValue obj;
+    int i;
+
+    if (JS_VALUE_GET_TAG(template_obj) != JS_TAG_OBJECT)
+        goto fail;
+    tp = JS_VALUE_GET_OBJ(template_obj);
+    sh = tp->shape;
+    if (tp->class_id != JS_CLASS_OBJECT || !sh->is_hashed ||
+        sh->deleted_prop_count != 0 || sh->prop_count != count)
+        goto fail;
+    prs = get_shape_prop(sh);
+    for(i = 0; i < count; i++) {
+        if ((prs[i].flags & (JS_PROP_TMASK | JS_PROP_C_W_E)) != JS_PROP_C_W_E)
+            goto fail;
+    }
+    obj = JS_NewObjectFromShape(ctx, js_dup_shape(sh), JS_CLASS_OBJECT);
+    if (JS_IsException(obj))
+        goto free_values;
+    p = JS_VALUE_GET_OBJ(obj);
+    for(i = 0; i < count; i++)
+        p->prop[i].u.value = values[i];
+    return obj;
+ fail:
+    JS_ThrowTypeError(ctx, "invalid object template");
+ free_values:
+    for(i = 0; i < count; i++)
+        JS_FreeValue(ctx, values[i]);
+    return JS_EXCEPTION;
+}
+
 static void js_free_desc(JSContext *ctx, JSPropertyDescriptor *desc)
 {
     JS_FreeValue(ctx, desc->getter);
@@ -53170,6 +53243,15 @@ JSValue JS_GetTypedArrayBuffer(JSContext *ctx, JSValueConst obj,
     return JS_DupValue(ctx, JS_MKPTR(JS_TAG_OBJECT, ta->buffer));
 }
 
+/* return the JSTypedArrayEnum of 'obj' or -1 if it is not a typed array */
+int JS_GetTypedArrayType(JSValueConst obj)
+{
+    JSClassID class_id = JS_GetClassID(obj);
+    if (class_id >= JS_CLASS_UINT8C_ARRAY && class_id <= JS_CLASS_FLOAT64_ARRAY)
+        return class_id - JS_CLASS_UINT8C_ARRAY;
+    return -1;
+}
+
 static JSValue js_typed_array_get_toStringTag(JSContext *ctx,
                                               JSValueConst this_val)
 {
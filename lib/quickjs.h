@@ -762,6 +762,14 @@ JS_BOOL JS_SetConstructorBit(JSContext *ctx, JSValueConst func_obj, JS_BOOL val)
 
 JSValue JS_NewArray(JSContext *ctx);
 int JS_IsArray(JSContext *ctx, JSValueConst val);
+/* create a fast array of 'len' undefined elements and return its storage */
+JSValue JS_NewFastArray(JSContext *ctx, uint32_t len, JSValue **pvalues);
+/* return TRUE and the internal values if 'obj' is a fast array */
+JS_BOOL JS_GetFastArray(JSContext *ctx, JSValueConst obj,
+                        JSValue **arrpp, uint32_t *countp);
+/* create a plain object sharing the shape of 'template_obj', 'values' are freed */
+JSValue JS_NewObjectFromTemplate(JSContext *ctx, JSValueConst template_obj,
+                                 JSValue *values, int count);
 
 JSValue JS_NewDate(JSContext *ctx, double epoch_ms);
 
@@ -888,6 +896,8 @@ JSValue JS_GetTypedArrayBuffer(JSContext *ctx, JSValueConst obj,
                                size_t *pbyte_offset,
                                size_t *pbyte_length,
                                size_t *pbytes_per_element);
+/* return the JSTypedArrayEnum of 'obj' or -1 if it is not a typed array */
+int JS_GetTypedArrayType(JSValueConst obj);
 typedef struct {
     void *(*sab_alloc)(void *opaque, size_t size);
     void (*sab_free)(void *opaque, void *ptr);
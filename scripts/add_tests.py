@@ -61,6 +61,9 @@ for test in tests:
     python_functions.append(pyfunc)
 
     test_stuff = test_skeleton.format(name=name,file_path=file_path)
+    # Rules a test needs on top of the skeleton (generated files, defines) live next to it
+    if os.path.exists("tests/{name}.cmake".format(name=name)):
+        test_stuff += "    include(tests/{name}.cmake)\n".format(name=name)
     nlines = test_stuff.split('\n')
     for nline in nlines:
         cmake_file_lines.append(nline)
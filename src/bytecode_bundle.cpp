@@ -0,0 +1,209 @@
+#include <include/ejr.hpp>
+#include <cstring>
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace ejr;
+using namespace std;
+
+/// @brief Start of every bundle.
+struct BundleHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t entry_count;
+    uint32_t reserved;
+};
+
+/// @brief A entry of the index, offsets are from the start of the bundle.
+struct BundleIndexEntry
+{
+    uint32_t flags;
+    uint32_t name_size;
+    uint64_t name_offset;
+    uint64_t bytecode_offset;
+    uint64_t bytecode_size;
+};
+
+static const char bundle_magic[4] = {'E', 'J', 'R', 'C'};
+static const uint32_t bundle_version = 1;
+static const uint32_t bundle_flag_module = 1;
+
+/// @brief Bytecode starts 8 byte aligned.
+static size_t align_up(size_t offset)
+{
+    return (offset + 7) & ~static_cast<size_t>(7);
+}
+
+/// @brief Is [offset, offset + length) inside a bundle of size bytes.
+static bool in_bounds(uint64_t offset, uint64_t length, size_t size)
+{
+    return offset <= size && length <= size - offset;
+}
+
+void ejr::write_bytecode_bundle(const vector<BytecodeBundleEntry> &entries, vector<uint8_t> &out)
+{
+    size_t names_offset = sizeof(BundleHeader) + entries.size() * sizeof(BundleIndexEntry);
+    size_t bytecode_offset = names_offset;
+    for (const BytecodeBundleEntry &entry : entries)
+    {
+        bytecode_offset += entry.name.size() + 1;
+    }
+    bytecode_offset = align_up(bytecode_offset);
+
+    size_t total = bytecode_offset;
+    for (const BytecodeBundleEntry &entry : entries)
+    {
+        total = align_up(total + entry.size);
+    }
+    out.assign(total, 0);
+
+    BundleHeader header;
+    memcpy(header.magic, bundle_magic, sizeof(header.magic));
+    header.version = bundle_version;
+    header.entry_count = static_cast<uint32_t>(entries.size());
+    header.reserved = 0;
+    memcpy(out.data(), &header, sizeof(header));
+
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        const BytecodeBundleEntry &entry = entries[i];
+
+        BundleIndexEntry index;
+        index.flags = entry.is_module ? bundle_flag_module : 0;
+        index.name_size = static_cast<uint32_t>(entry.name.size());
+        index.name_offset = names_offset;
+        index.bytecode_offset = bytecode_offset;
+        index.bytecode_size = entry.size;
+        memcpy(out.data() + sizeof(BundleHeader) + i * sizeof(BundleIndexEntry), &index, sizeof(index));
+
+        // Names are '\0' terminated, so they can be passed to QuickJS as is.
+        memcpy(out.data() + names_offset, entry.name.data(), entry.name.size());
+        names_offset += entry.name.size() + 1;
+        memcpy(out.data() + bytecode_offset, entry.bytecode, entry.size);
+        bytecode_offset = align_up(bytecode_offset + entry.size);
+    }
+}
+
+bool ejr::read_bytecode_bundle(const uint8_t *bundle, size_t size, vector<BytecodeBundleEntry> &out)
+{
+    out.clear();
+
+    BundleHeader header;
+    if (!bundle || size < sizeof(header))
+    {
+        return false;
+    }
+    memcpy(&header, bundle, sizeof(header));
+    if (memcmp(header.magic, bundle_magic, sizeof(header.magic)) != 0 || header.version != bundle_version ||
+        header.entry_count > (size - sizeof(header)) / sizeof(BundleIndexEntry))
+    {
+        return false;
+    }
+
+    out.reserve(header.entry_count);
+    for (uint32_t i = 0; i < header.entry_count; i++)
+    {
+        BundleIndexEntry index;
+        memcpy(&index, bundle + sizeof(header) + i * sizeof(BundleIndexEntry), sizeof(index));
+        if (!in_bounds(index.name_offset, static_cast<uint64_t>(index.name_size) + 1, size) ||
+            bundle[index.name_offset + index.name_size] != '\0' ||
+            !in_bounds(index.bytecode_offset, index.bytecode_size, size))
+        {
+            out.clear();
+            return false;
+        }
+
+        BytecodeBundleEntry entry;
+        entry.name = string_view(reinterpret_cast<const char *>(bundle + index.name_offset), index.name_size);
+        entry.is_module = (index.flags & bundle_flag_module) != 0;
+        entry.bytecode = bundle + index.bytecode_offset;
+        entry.size = index.bytecode_size;
+        out.push_back(entry);
+    }
+    return true;
+}
+
+MappedBytecodeBundle::~MappedBytecodeBundle()
+{
+#ifdef _WIN32
+    delete[] this->data;
+#else
+    if (this->data)
+    {
+        munmap(const_cast<uint8_t *>(this->data), this->size);
+    }
+#endif
+}
+
+shared_ptr<MappedBytecodeBundle> MappedBytecodeBundle::open(const string &path)
+{
+    shared_ptr<MappedBytecodeBundle> bundle(new MappedBytecodeBundle());
+#ifdef _WIN32
+    // No mmap, read it whole instead.
+    ifstream file(path, ios::binary | ios::ate);
+    if (!file.is_open())
+    {
+        return nullptr;
+    }
+    bundle->size = static_cast<size_t>(file.tellg());
+    uint8_t *data = new uint8_t[bundle->size];
+    bundle->data = data;
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char *>(data), bundle->size))
+    {
+        return nullptr;
+    }
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return nullptr;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0)
+    {
+        close(fd);
+        return nullptr;
+    }
+    void *mapped = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    // The mapping keeps the file open.
+    close(fd);
+    if (mapped == MAP_FAILED)
+    {
+        return nullptr;
+    }
+    bundle->data = static_cast<const uint8_t *>(mapped);
+    bundle->size = static_cast<size_t>(info.st_size);
+#endif
+
+    if (!read_bytecode_bundle(bundle->data, bundle->size, bundle->entries))
+    {
+        return nullptr;
+    }
+    for (size_t i = 0; i < bundle->entries.size(); i++)
+    {
+        if (bundle->entries[i].is_module)
+        {
+            bundle->modules_by_name.emplace(bundle->entries[i].name, i);
+        }
+    }
+    return bundle;
+}
+
+const BytecodeBundleEntry *MappedBytecodeBundle::find_module(string_view name) const
+{
+    auto it = this->modules_by_name.find(name);
+    return it == this->modules_by_name.end() ? nullptr : &this->entries[it->second];
+}
+
+size_t MappedBytecodeBundle::entry_count() const
+{
+    return this->entries.size();
+}
@@ -0,0 +1,135 @@
+#include <include/ejr.hpp>
+#include <lib/quickjs_config.h>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+using namespace ejr;
+using namespace std;
+
+/// @brief Written before the bytecode of every cache file.
+struct BytecodeFileHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    uint64_t size;
+};
+
+static const char bytecode_file_magic[4] = {'E', 'J', 'R', 'B'};
+static const uint32_t bytecode_file_version = 1;
+
+/// @brief FNV-1a, continued from hash.
+static uint64_t fnv1a(uint64_t hash, const void *data, size_t length)
+{
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    for (size_t i = 0; i < length; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+BytecodeCache::BytecodeCache(const string &directory) : directory(directory)
+{
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+}
+
+uint64_t BytecodeCache::key_of(const char *source, size_t length, const string &file_name, int eval_flags)
+{
+    // The bytecode format changes between QuickJS versions and pointer sizes.
+    uint64_t hash = fnv1a(0xcbf29ce484222325ULL, CONFIG_VERSION, sizeof(CONFIG_VERSION));
+    uint32_t pointer_size = sizeof(void *);
+    hash = fnv1a(hash, &pointer_size, sizeof(pointer_size));
+    hash = fnv1a(hash, &eval_flags, sizeof(eval_flags));
+    hash = fnv1a(hash, file_name.c_str(), file_name.size() + 1);
+    uint64_t source_length = length;
+    hash = fnv1a(hash, &source_length, sizeof(source_length));
+    return fnv1a(hash, source, length);
+}
+
+string BytecodeCache::path_of(uint64_t key) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.jsbc", static_cast<unsigned long long>(key));
+    return (std::filesystem::path(this->directory) / name).string();
+}
+
+bool BytecodeCache::load(uint64_t key, vector<uint8_t> &out)
+{
+    string path = this->path_of(key);
+    std::error_code error;
+    uintmax_t file_size = std::filesystem::file_size(path, error);
+
+    ifstream file(path, ios::binary);
+    BytecodeFileHeader header;
+    // The size check catches files that were cut off, before anything is allocated.
+    bool valid = !error && file.is_open() && file.read(reinterpret_cast<char *>(&header), sizeof(header)) &&
+                 memcmp(header.magic, bytecode_file_magic, sizeof(header.magic)) == 0 &&
+                 header.version == bytecode_file_version && header.key == key &&
+                 file_size == sizeof(header) + header.size;
+    if (valid)
+    {
+        out.resize(header.size);
+        valid = static_cast<bool>(file.read(reinterpret_cast<char *>(out.data()), header.size));
+    }
+    return valid;
+}
+
+bool BytecodeCache::store(uint64_t key, const uint8_t *bytecode, size_t size)
+{
+    string path = this->path_of(key);
+    // Unique per process and thread, so concurrent stores of the same key never share a file.
+    string temp_path = path + "." + to_string(getpid()) + "." +
+                       to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+
+    BytecodeFileHeader header;
+    memcpy(header.magic, bytecode_file_magic, sizeof(header.magic));
+    header.version = bytecode_file_version;
+    header.key = key;
+    header.size = size;
+
+    {
+        ofstream file(temp_path, ios::binary | ios::trunc);
+        if (!file.is_open() ||
+            !file.write(reinterpret_cast<const char *>(&header), sizeof(header)) ||
+            !file.write(reinterpret_cast<const char *>(bytecode), size))
+        {
+            file.close();
+            std::remove(temp_path.c_str());
+            return false;
+        }
+    }
+
+    if (std::rename(temp_path.c_str(), path.c_str()) != 0)
+    {
+        std::remove(temp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+void BytecodeCache::count_lookup(bool hit)
+{
+    (hit ? this->hit_count : this->miss_count)++;
+}
+
+size_t BytecodeCache::hits() const
+{
+    return this->hit_count.load();
+}
+
+size_t BytecodeCache::misses() const
+{
+    return this->miss_count.load();
+}
@@ -0,0 +1,152 @@
+#include <include/ejr.hpp>
+
+using namespace ejr;
+using namespace std;
+
+ContextTemplate::~ContextTemplate() = default;
+
+void ContextTemplate::set_intrinsics(uint32_t intrinsics)
+{
+    this->intrinsics = intrinsics & AllIntrinsics;
+    lock_guard<mutex> lock(this->pool_mutex);
+    this->pool.clear();
+}
+
+uint32_t ContextTemplate::get_intrinsics() const
+{
+    return this->intrinsics;
+}
+
+void ContextTemplate::register_callback(const string &fn_name, DynCallback callback, bool borrow_typed_arrays)
+{
+    this->add([fn_name, callback, borrow_typed_arrays](EasyJSR &runtime) {
+        runtime.register_callback(fn_name, callback, borrow_typed_arrays);
+    });
+}
+
+void ContextTemplate::register_compact_callback(const string &fn_name, CompactCallback callback)
+{
+    this->add([fn_name, callback](EasyJSR &runtime) {
+        runtime.register_compact_callback(fn_name, callback);
+    });
+}
+
+void ContextTemplate::register_raw_callback(const string &fn_name, RawCallback callback, void *opaque)
+{
+    this->add([fn_name, callback, opaque](EasyJSR &runtime) {
+        runtime.register_raw_callback(fn_name, callback, opaque);
+    });
+}
+
+void ContextTemplate::register_module(const string &module_name, const vector<JSMethod> &methods)
+{
+    this->add([module_name, methods](EasyJSR &runtime) {
+        runtime.register_module(module_name, methods);
+    });
+}
+
+void ContextTemplate::add_step(Step step)
+{
+    this->add(std::move(step));
+}
+
+bool ContextTemplate::add_prelude_script(const string &js, const string &file_name)
+{
+    return this->add_prelude(js, file_name, JS_EVAL_TYPE_GLOBAL);
+}
+
+bool ContextTemplate::add_prelude_module(const string &js, const string &file_name)
+{
+    return this->add_prelude(js, file_name, JS_EVAL_TYPE_MODULE);
+}
+
+bool ContextTemplate::add_prelude(const string &js, const string &file_name, int eval_flags)
+{
+    // Compiled and checked in a runtime with everything before it, modules can import the registered ones.
+    EasyJSR check(*this);
+    JSContext *ctx = check.get_context();
+
+    vector<uint8_t> bytecode;
+    if (!check.compile_bytecode(js, file_name, eval_flags, bytecode))
+    {
+        this->error = check.val_to_string(JS_GetException(ctx));
+        return false;
+    }
+    auto bundle = make_shared<vector<uint8_t>>();
+    write_bytecode_bundle({{file_name, eval_flags == JS_EVAL_TYPE_MODULE, bytecode.data(), bytecode.size()}}, *bundle);
+
+    JSValue result = check.eval_bytecode(bundle->data(), bundle->size());
+    if (JS_IsException(result))
+    {
+        this->error = check.val_to_string(JS_GetException(ctx));
+        return false;
+    }
+    bool rejected = JS_PromiseState(ctx, result) == JS_PROMISE_REJECTED;
+    if (rejected)
+    {
+        this->error = check.val_to_string(JS_PromiseResult(ctx, result));
+    }
+    check.free_jsval(result);
+    if (rejected)
+    {
+        return false;
+    }
+
+    this->add([bundle](EasyJSR &runtime) {
+        runtime.free_jsval(runtime.eval_bytecode(bundle->data(), bundle->size()));
+    });
+    return true;
+}
+
+const string &ContextTemplate::get_error() const
+{
+    return this->error;
+}
+
+void ContextTemplate::apply(EasyJSR &runtime) const
+{
+    for (const Step &step : this->steps)
+    {
+        step(runtime);
+    }
+}
+
+unique_ptr<EasyJSR> ContextTemplate::instantiate()
+{
+    {
+        lock_guard<mutex> lock(this->pool_mutex);
+        if (!this->pool.empty())
+        {
+            unique_ptr<EasyJSR> runtime = std::move(this->pool.back());
+            this->pool.pop_back();
+            // It may have been made on another thread, with another stack.
+            JS_UpdateStackTop(JS_GetRuntime(runtime->get_context()));
+            return runtime;
+        }
+    }
+    return make_unique<EasyJSR>(*this);
+}
+
+void ContextTemplate::prewarm(size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        // Made outside the lock, so instantiate is not held up.
+        auto runtime = make_unique<EasyJSR>(*this);
+        lock_guard<mutex> lock(this->pool_mutex);
+        this->pool.push_back(std::move(runtime));
+    }
+}
+
+size_t ContextTemplate::prewarmed() const
+{
+    lock_guard<mutex> lock(this->pool_mutex);
+    return this->pool.size();
+}
+
+void ContextTemplate::add(Step step)
+{
+    this->steps.push_back(std::move(step));
+    lock_guard<mutex> lock(this->pool_mutex);
+    this->pool.clear();
+}
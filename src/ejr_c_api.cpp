@@ -4,27 +4,136 @@
 #include <memory>
 #include <string>
 #include <cstdlib>
+#include <cstddef>
+#include <new>
 #include <cstring>
+#include <unordered_set>
+#include <climits>
+#include <cmath>
+#include <algorithm>
+#include <initializer_list>
 #include "ejr.h"
 
+/// @brief The JSValues handed out to C, by id.
+///
+/// A slab of slots with a free list. A id is the slot index plus the slots
+/// generation, which changes every time the slot is freed, so ids of freed
+/// values stay invalid after their slot is reused. Freed slots are reused
+/// oldest first, and only once min_free_slots are free, so a slot goes through
+/// its 2048 generations in no less than 2048 * min_free_slots frees.
+///
+/// Values added inside a scope (see begin_scope) are logged and freed by end_scope.
 struct JSValueAD
 {
-    /// @brief id -> value map
-    std::unordered_map<int, JSValue> id_to_value;
+    explicit JSValueAD(JSContext *ctx) : ctx(ctx) {}
 
     /// @brief Add a new value.
     /// @param value the value.
-    /// @return the values id in the map.
+    /// @return the values id, -1 if every slot is in use (the value is freed).
     int add_value(JSValue value)
     {
-        int id = this->next_id;
-        this->id_to_value[id] = value;
-        this->next_id++;
+        uint32_t index;
+        if (this->free_count >= min_free_slots || (this->free_count > 0 && this->slots.size() == max_slots))
+        {
+            index = this->free_head;
+            this->free_head = this->slots[index].next_free;
+            if (this->free_head == no_slot)
+            {
+                this->free_tail = no_slot;
+            }
+            this->free_count--;
+        }
+        else if (this->slots.size() < max_slots)
+        {
+            index = static_cast<uint32_t>(this->slots.size());
+            this->slots.push_back(Slot{});
+        }
+        else
+        {
+            JS_FreeValue(this->ctx, value);
+            return -1;
+        }
+
+        Slot &slot = this->slots[index];
+        slot.value = value;
+        slot.live = true;
+        slot.scope = this->scope_depth;
+
+        int id = make_id(index, slot.generation);
+        if (this->scope_depth > 0)
+        {
+            this->scope_log.push_back(id);
+        }
         return id;
     }
 
+    /// @brief Start a scope, values added until end_scope belong to it.
+    void begin_scope()
+    {
+        this->scope_marks.push_back(this->scope_log.size());
+        this->scope_depth++;
+    }
+
+    /// @brief Free the values of the innermost scope, escaped ones move to the parent scope.
+    void end_scope(ejr::EasyJSR *ejsr)
+    {
+        if (!ejsr || this->scope_depth == 0)
+        {
+            return;
+        }
+
+        size_t mark = this->scope_marks.back();
+        this->scope_marks.pop_back();
+        this->scope_depth--;
+
+        size_t kept = mark;
+        for (size_t i = mark; i < this->scope_log.size(); i++)
+        {
+            int id = this->scope_log[i];
+            Slot *slot = this->find(id);
+            if (!slot)
+            {
+                // Freed already
+                continue;
+            }
+
+            if (slot->scope > this->scope_depth)
+            {
+                ejsr->free_jsval(slot->value);
+                this->release(*slot, id_index(id));
+            }
+            else if (this->scope_depth > 0)
+            {
+                // Escaped, now logged in the parent scope
+                this->scope_log[kept++] = id;
+            }
+        }
+        this->scope_log.resize(kept);
+        if (this->scope_depth == 0)
+        {
+            this->scope_log_stale = 0;
+        }
+    }
+
+    /// @brief Move a value of the innermost scope to its parent scope.
+    /// @return false if id is not a value.
+    bool escape(int id)
+    {
+        Slot *slot = this->find(id);
+        if (!slot)
+        {
+            return false;
+        }
+
+        if (this->scope_depth > 0 && slot->scope == this->scope_depth)
+        {
+            slot->scope = this->scope_depth - 1;
+        }
+        return true;
+    }
+
     /// @brief Free a JSValue
-    /// @param id The value id in the map
+    /// @param id The value id
     void free_value(ejr::EasyJSR *ejsr, int id)
     {
         if (!ejsr)
@@ -32,11 +141,17 @@ struct JSValueAD
             return;
         }
 
-        auto it = this->id_to_value.find(id);
-        if (it != this->id_to_value.end())
+        Slot *slot = this->find(id);
+        if (slot)
         {
-            ejsr->free_jsval(it->second);
-            this->id_to_value.erase(id);
+            ejsr->free_jsval(slot->value);
+            this->release(*slot, id_index(id));
+
+            // Its scope_log entry is stale now, drop those once they are most of the log.
+            if (this->scope_depth > 0 && ++this->scope_log_stale > this->scope_log.size() / 2)
+            {
+                this->compact_scope_log();
+            }
         }
     }
 
@@ -47,29 +162,315 @@ struct JSValueAD
             return;
         }
 
-        for (auto &pair : this->id_to_value)
+        for (uint32_t i = 0; i < this->slots.size(); i++)
         {
-            ejsr->free_jsval(pair.second);
+            Slot &slot = this->slots[i];
+            if (slot.live)
+            {
+                ejsr->free_jsval(slot.value);
+                this->release(slot, i);
+            }
         }
 
-        this->id_to_value.clear();
-        this->next_id = 0;
+        this->scope_log.clear();
+        this->scope_marks.clear();
+        this->scope_log_stale = 0;
+        this->scope_depth = 0;
     }
 
     JSValue get(int id)
     {
-        auto it = this->id_to_value.find(id);
-        if (it != this->id_to_value.end())
+        Slot *slot = this->find(id);
+        if (slot)
         {
-            return it->second;
+            return slot->value;
         }
 
         return js_undefined();
     }
 
+    /// @brief If id is a value that has not been freed.
+    bool contains(int id)
+    {
+        return this->find(id) != nullptr;
+    }
+
+private:
+    // 20 bits of index and 11 of generation, so ids stay positive.
+    static constexpr uint32_t index_bits = 20;
+    static constexpr uint32_t index_mask = (1u << index_bits) - 1;
+    static constexpr uint32_t generation_mask = 0x7ff;
+    static constexpr uint32_t min_free_slots = 1024;
+    static constexpr uint32_t max_slots = index_mask + 1;
+    static_assert(max_slots == EJR_MAX_LIVE_VALUES, "ejr.h documents the number of slots");
+    static constexpr uint32_t no_slot = UINT32_MAX;
+
+    struct Slot
+    {
+        JSValue value;
+        uint32_t next_free = no_slot;
+        uint32_t scope = 0;
+        uint16_t generation = 0;
+        bool live = false;
+    };
+
+    static int make_id(uint32_t index, uint16_t generation)
+    {
+        return static_cast<int>((static_cast<uint32_t>(generation) << index_bits) | index);
+    }
+
+    static uint32_t id_index(int id)
+    {
+        return static_cast<uint32_t>(id) & index_mask;
+    }
+
+    Slot *find(int id)
+    {
+        if (id < 0)
+        {
+            return nullptr;
+        }
+
+        uint32_t index = id_index(id);
+        if (index >= this->slots.size())
+        {
+            return nullptr;
+        }
+
+        Slot &slot = this->slots[index];
+        if (!slot.live || slot.generation != (static_cast<uint32_t>(id) >> index_bits))
+        {
+            return nullptr;
+        }
+        return &slot;
+    }
+
+    /// @brief Drop the ids of freed values from scope_log, moving the scope marks along.
+    void compact_scope_log()
+    {
+        size_t kept = 0;
+        size_t mark = 0;
+        for (size_t i = 0; i < this->scope_log.size(); i++)
+        {
+            while (mark < this->scope_marks.size() && this->scope_marks[mark] == i)
+            {
+                this->scope_marks[mark++] = kept;
+            }
+            if (this->find(this->scope_log[i]))
+            {
+                this->scope_log[kept++] = this->scope_log[i];
+            }
+        }
+        while (mark < this->scope_marks.size())
+        {
+            this->scope_marks[mark++] = kept;
+        }
+        this->scope_log.resize(kept);
+        this->scope_log_stale = 0;
+    }
+
+    /// @brief Put a slot at the end of the free list, invalidating its id.
+    void release(Slot &slot, uint32_t index)
+    {
+        slot.value = js_undefined();
+        slot.live = false;
+        slot.generation = (slot.generation + 1) & generation_mask;
+        slot.next_free = no_slot;
+        if (this->free_tail == no_slot)
+        {
+            this->free_head = index;
+        }
+        else
+        {
+            this->slots[this->free_tail].next_free = index;
+        }
+        this->free_tail = index;
+        this->free_count++;
+    }
+
+    /// @brief Context add_value frees into when out of slots.
+    JSContext *ctx;
+    /// @brief The slots, ids index into it.
+    std::vector<Slot> slots;
+    /// @brief Oldest and newest free slot, no_slot if none.
+    uint32_t free_head = no_slot;
+    uint32_t free_tail = no_slot;
+    /// @brief Number of slots in the free list.
+    uint32_t free_count = 0;
+
+    /// @brief Number of open scopes, 0 when values are not scoped.
+    uint32_t scope_depth = 0;
+    /// @brief Ids added in the open scopes, in order.
+    std::vector<int> scope_log;
+    /// @brief Where each open scope starts in scope_log.
+    std::vector<size_t> scope_marks;
+    /// @brief Values freed by hand since scope_log was last compacted, their entries are stale.
+    size_t scope_log_stale = 0;
+};
+
+/// @brief A bump allocator for JSArgs, everything is released at once.
+struct EJRArena
+{
+    /// @brief A position in the arena, see mark and rewind.
+    struct Mark
+    {
+        size_t block;
+        size_t offset;
+    };
+
+    explicit EJRArena(size_t block_size) : block_size(block_size ? block_size : 4096) {}
+
+    /// @brief Allocate size bytes, aligned for any type.
+    void *allocate(size_t size)
+    {
+        const size_t align = alignof(std::max_align_t);
+        size = (size + align - 1) & ~(align - 1);
+
+        while (this->block < this->blocks.size())
+        {
+            Block &current = this->blocks[this->block];
+            if (this->offset + size <= current.size)
+            {
+                void *ptr = current.data.get() + this->offset;
+                this->offset += size;
+                return ptr;
+            }
+            // Move on to the next retained block
+            this->block++;
+            this->offset = 0;
+        }
+
+        // Out of blocks, oversized allocations get a block of their own.
+        size_t new_size = size > this->block_size ? size : this->block_size;
+        this->blocks.push_back(Block{std::unique_ptr<unsigned char[]>(new unsigned char[new_size]), new_size});
+        this->block = this->blocks.size() - 1;
+        this->offset = size;
+        return this->blocks.back().data.get();
+    }
+
+    /// @brief Allocate a array of count T, value initialized.
+    template <typename T>
+    T *allocate_array(size_t count)
+    {
+        T *items = static_cast<T *>(this->allocate(count * sizeof(T)));
+        for (size_t i = 0; i < count; i++)
+        {
+            new (&items[i]) T();
+        }
+        return items;
+    }
+
+    Mark mark() const
+    {
+        return Mark{this->block, this->offset};
+    }
+
+    /// @brief Release everything allocated after mark. Blocks are kept for reuse.
+    void rewind(Mark mark)
+    {
+        this->block = mark.block;
+        this->offset = mark.offset;
+    }
+
+    void reset()
+    {
+        this->rewind(Mark{0, 0});
+    }
+
 private:
-    /// @brief Next id
-    int next_id = 0;
+    struct Block
+    {
+        std::unique_ptr<unsigned char[]> data;
+        size_t size;
+    };
+
+    std::vector<Block> blocks;
+    size_t block = 0;
+    size_t offset = 0;
+    size_t block_size;
+};
+
+/// @brief A registered C callback, the JS function points at it.
+struct CCallback
+{
+    C_Callback cb;
+    void *opaque;
+    bool borrow_typed_arrays;
+    /// @brief Where object arguments are converted into, rewound after each call.
+    EJRArena *arena;
+};
+
+/// @brief C callbacks of a runtime made from a template, kept alive by the runtime.
+struct CCallbackSet
+{
+    /// @brief Each runtime converts its arguments into its own arena.
+    EJRArena arena{0};
+    std::vector<std::unique_ptr<CCallback>> callbacks;
+
+    CCallback *add(C_Callback cb, void *opaque)
+    {
+        this->callbacks.push_back(std::unique_ptr<CCallback>(new CCallback{cb, opaque, false, &this->arena}));
+        return this->callbacks.back().get();
+    }
+};
+
+/// @brief A context template, see ejr_template_new.
+struct EJRContextTemplate
+{
+    ejr::ContextTemplate context_template;
+};
+
+/// @brief A prepared JS function, see ejr_prepare_function.
+struct EJRPreparedFunction
+{
+    ejr::PreparedFunction function;
+};
+
+/// @brief A interned property key, see ejr_intern_key.
+struct EJRKey
+{
+    ejr::PropertyKey key;
+};
+
+/// @brief A serialized value, not tied to any runtime.
+struct EJRSerializedValue
+{
+    ejr::SerializedValue value;
+};
+
+/// @brief A C class, see ejr_register_class.
+struct EJRClass
+{
+    EasyJSRHandle *handle;
+    JSClassID class_id;
+    C_Constructor constructor;
+    C_Finalizer finalizer;
+    void *opaque;
+};
+
+/// @brief The class id of a C class by name.
+///
+/// Class ids are process wide and QuickJS has at most 65536 of them, so a name gets its id once,
+/// not once per runtime.
+static JSClassID c_class_id(const std::string &class_name)
+{
+    static std::mutex ids_mutex;
+    static std::unordered_map<std::string, JSClassID> ids;
+
+    std::lock_guard<std::mutex> lock(ids_mutex);
+    JSClassID &class_id = ids[class_name];
+    if (class_id == 0)
+    {
+        JS_NewClassID(&class_id);
+    }
+    return class_id;
+}
+
+/// @brief The opaque of every JS object of a C class.
+struct CObject
+{
+    void *native;
+    EJRClass *cls;
 };
 
 struct EasyJSRHandle
@@ -80,13 +481,36 @@ struct EasyJSRHandle
     /// @brief the JSVAD
     JSValueAD *jsvad;
 
+    /// @brief C callbacks, alive as long as the handle.
+    std::vector<std::unique_ptr<CCallback>> c_callbacks;
+
+    /// @brief Shared by the C callbacks for their arguments.
+    EJRArena callback_arena{0};
+
+    /// @brief Prepared functions not freed yet, they must go before the runtime.
+    std::unordered_set<EJRPreparedFunction *> prepared_functions;
+
+    /// @brief Interned keys not freed yet, they must go before the runtime.
+    std::unordered_set<EJRKey *> keys;
+
+    /// @brief C classes, alive as long as the handle (their finalizers run with the runtime).
+    std::vector<std::unique_ptr<EJRClass>> classes;
+
     EasyJSRHandle(ejr::EasyJSR *instance, JSValueAD *jsvad) : instance(instance), jsvad(jsvad) {}
+
+    /// @brief Keep a C callback alive.
+    /// @return the stored callback
+    CCallback *add_c_callback(C_Callback cb, void *opaque, bool borrow_typed_arrays)
+    {
+        this->c_callbacks.push_back(std::unique_ptr<CCallback>(new CCallback{cb, opaque, borrow_typed_arrays, &this->callback_arena}));
+        return this->c_callbacks.back().get();
+    }
 };
 
 /// @brief Make sure all pointers are valid.
 /// @param ptrs pointers
 /// @return true if valid, false if not.
-bool valid_ptrs(const std::vector<void *> &ptrs)
+bool valid_ptrs(std::initializer_list<const void *> ptrs)
 {
     for (const auto &ptr : ptrs)
     {
@@ -99,6 +523,50 @@ bool valid_ptrs(const std::vector<void *> &ptrs)
     return true;
 }
 
+/// @brief Allocate a JSArg in arena, or on the heap if arena is nullptr.
+/// @param arena the arena or nullptr
+/// @param type the JSArg type
+/// @return the JSArg
+JSArg *new_jsarg(EJRArena *arena, JSArgType type)
+{
+    JSArg *arg;
+    if (arena)
+    {
+        arg = arena->allocate_array<JSArg>(1);
+        arg->in_arena = true;
+    }
+    else
+    {
+        arg = new JSArg();
+    }
+    arg->type = type;
+
+    return arg;
+}
+
+/// @brief Copy count items into arena, or onto the heap if arena is nullptr.
+/// @param arena the arena or nullptr
+/// @param items the items to copy
+/// @param count number of items
+/// @return the copy
+template <typename T>
+T *copy_items(EJRArena *arena, const T *items, size_t count)
+{
+    T *copy = arena ? static_cast<T *>(arena->allocate(count * sizeof(T))) : new T[count];
+    if (count > 0)
+    {
+        std::memcpy(copy, items, count * sizeof(T));
+    }
+
+    return copy;
+}
+
+/// @brief Copy a c string into arena, or onto the heap if arena is nullptr.
+const char *copy_str(EJRArena *arena, const char *value)
+{
+    return copy_items<char>(arena, value, strlen(value) + 1);
+}
+
 /// @brief Convert JSArg to ejr::JSArg
 /// @param arg the JSArg
 /// @return the ejr::JSArg
@@ -264,6 +732,23 @@ ejr::JSArg jsarg_to_ejr(JSArg arg)
 
         return ejr::JSArg(ejr::JSArgException(message, name));
     }
+    case JSARG_TYPE_ARRAY_VIEW:
+    {
+        return ejr::JSArg(ejr::JSArgTypedArrayView(
+            static_cast<uint8_t *>(arg.value.array_view_val.items),
+            arg.value.array_view_val.count,
+            static_cast<JSTypedArrayEnum>(arg.value.array_view_val.element_type)));
+    }
+    case JSARG_TYPE_OBJECT:
+    {
+        ejr::JSArgObject object;
+        for (size_t i = 0; i < arg.value.object_val.count; ++i)
+        {
+            object.set(arg.value.object_val.keys[i], jsarg_to_ejr(*arg.value.object_val.values[i]));
+        }
+
+        return ejr::JSArg(std::move(object));
+    }
 
     default:
     {
@@ -273,7 +758,7 @@ ejr::JSArg jsarg_to_ejr(JSArg arg)
     }
 }
 
-JSArg *ejr_to_jsarg(ejr::JSArg ejr_arg)
+JSArg *ejr_to_jsarg_in(EJRArena *arena, const ejr::JSArg &ejr_arg)
 {
     JSArg *arg;
 
@@ -281,676 +766,2097 @@ JSArg *ejr_to_jsarg(ejr::JSArg ejr_arg)
                {
         using T = std::decay_t<decltype(value)>;
         if constexpr (std::is_same_v<T, int>) {
-            arg = jsarg_int(value);
+            arg = jsarg_int_in(arena, value);
         } else if constexpr (std::is_same_v<T, float>) {
-            arg = jsarg_float(value);
+            arg = jsarg_float_in(arena, value);
         } else if constexpr (std::is_same_v<T, double>) {
-            arg = jsarg_double(value);
+            arg = jsarg_double_in(arena, value);
         } else if constexpr (std::is_same_v<T, bool>) {
-            arg = jsarg_bool(value);
+            arg = jsarg_bool_in(arena, value);
         } else if constexpr (std::is_same_v<T, std::string>) {
-            char* c_str = new char[value.size() + 1];
-            std::memcpy(c_str, value.c_str(), value.size() + 1);
-            arg = jsarg_str(c_str);
+            arg = jsarg_str_in(arena, value.c_str());
         } else if constexpr (std::is_same_v<T, int64_t>) {
-            arg = jsarg_int64t(value);
+            arg = jsarg_int64t_in(arena, value);
         } else if constexpr (std::is_same_v<T, uint32_t>) {
-            arg = jsarg_uint32t(value);
+            arg = jsarg_uint32t_in(arena, value);
         } else if constexpr (std::is_same_v<T, ejr::JSArgNull>) {
-            arg = jsarg_null();
+            arg = jsarg_null_in(arena);
         } else if constexpr (std::is_same_v<T, ejr::JSArgUndefined>) {
-            arg = jsarg_undefined();
+            arg = jsarg_undefined_in(arena);
         } else if constexpr (std::is_same_v<T, std::shared_ptr<std::vector<ejr::JSArg>>>) {
-            arg = jsarg_carray(value->size());
+            arg = jsarg_carray_in(arena, value->size());
             for (size_t i = 0; i < value->size(); i++) {
-                JSArg* i_arg = ejr_to_jsarg((*value)[i]);
+                JSArg* i_arg = ejr_to_jsarg_in(arena, (*value)[i]);
                 jsarg_add_value_to_c_array(arg, i_arg);
             }
         } else if constexpr (std::is_same_v<T, ejr::JSArgTypedArray<uint8_t>>) {
-            arg = jsarg_u8_array(value.values.data(), value.values.size());
+            arg = jsarg_u8_array_in(arena, value.values.data(), value.values.size());
         } else if constexpr (std::is_same_v<T, ejr::JSArgTypedArray<int32_t>>) {
-            arg = jsarg_i32_array(value.values.data(), value.values.size());
+            arg = jsarg_i32_array_in(arena, value.values.data(), value.values.size());
         } else if constexpr (std::is_same_v<T, ejr::JSArgTypedArray<uint32_t>>) {
-            arg = jsarg_u32_array(value.values.data(), value.values.size());
+            arg = jsarg_u32_array_in(arena, value.values.data(), value.values.size());
         } else if constexpr (std::is_same_v<T, ejr::JSArgTypedArray<int64_t>>) {
-            arg = jsarg_i64_array(value.values.data(), value.values.size());
+            arg = jsarg_i64_array_in(arena, value.values.data(), value.values.size());
         } else if constexpr (std::is_same_v<T, ejr::JSArgTypedArray<int8_t>>) {
-            arg = jsarg_i8_array(value.values.data(), value.values.size());
+            arg = jsarg_i8_array_in(arena, value.values.data(), value.values.size());
         } else if constexpr (std::is_same_v<T, ejr::JSArgTypedArray<int16_t>>) {
-            arg = jsarg_i16_array(value.values.data(), value.values.size());
+            arg = jsarg_i16_array_in(arena, value.values.data(), value.values.size());
         } else if constexpr (std::is_same_v<T, ejr::JSArgTypedArray<uint16_t>>) {
-            arg = jsarg_u16_array(value.values.data(), value.values.size());
+            arg = jsarg_u16_array_in(arena, value.values.data(), value.values.size());
         } else if constexpr (std::is_same_v<T, ejr::JSArgTypedArray<uint64_t>>) {
-            arg = jsarg_u64_array(value.values.data(), value.values.size());
+            arg = jsarg_u64_array_in(arena, value.values.data(), value.values.size());
         } else if constexpr (std::is_same_v<T, ejr::JSArgTypedArray<float>>) {
-            arg = jsarg_float_array(value.values.data(), value.values.size());
+            arg = jsarg_float_array_in(arena, value.values.data(), value.values.size());
         } else if constexpr (std::is_same_v<T, ejr::JSArgException>) {
-            arg = jsarg_exception(value.msg.c_str(), value.name.c_str());
+            arg = jsarg_exception_in(arena, value.msg.c_str(), value.name.c_str());
+        } else if constexpr (std::is_same_v<T, ejr::JSArgTypedArrayView>) {
+            arg = jsarg_array_view_in(arena, value.data, value.length, static_cast<JSArgTypedArrayType>(value.type));
+        } else if constexpr (std::is_same_v<T, std::shared_ptr<ejr::JSArgObject>>) {
+            arg = jsarg_object_in(arena, value->size());
+            for (size_t i = 0; i < value->size(); i++) {
+                JSArg* i_arg = ejr_to_jsarg_in(arena, value->values[i]);
+                jsarg_add_entry_to_object_in(arena, arg, value->keys[i].c_str(), i_arg);
+            }
         }
         else {
-            arg = jsarg_null();
+            arg = jsarg_null_in(arena);
         } }, ejr_arg.value);
 
     return arg;
 }
 
-extern "C"
+JSArg *ejr_to_jsarg(const ejr::JSArg &ejr_arg)
 {
-    // Constructors
-    EasyJSRHandle *ejr_new()
-    {
-        ejr::EasyJSR *instance = new ejr::EasyJSR();
-        JSValueAD *jsvad = new JSValueAD();
-        EasyJSRHandle *handle = new EasyJSRHandle(instance, jsvad);
-        return handle;
-    }
+    return ejr_to_jsarg_in(nullptr, ejr_arg);
+}
 
-    JSArg *jsarg_int(int value)
+/// @brief The C args of one callback call, converted straight from the JSValues.
+///
+/// Scalars and strings are JSArg structs on the stack, strings point at QuickJS's UTF-8 copy.
+/// Objects still go through from_js and land in the callbacks arena. Everything is released with the frame.
+class CArgFrame
+{
+public:
+    CArgFrame(JSContext *ctx, int argc, JSValueConst *argv, bool borrow_typed_arrays, EJRArena *arena)
+        : ctx(ctx), argc(argc), arena(arena), arena_mark(arena->mark())
     {
-        JSArg *arg = new JSArg();
-        arg->type = JSARG_TYPE_INT;
-        arg->value.int_val = value;
+        if (argc > inline_count)
+        {
+            this->heap_args.resize(argc);
+            this->heap_ptrs.resize(argc);
+            this->heap_owners.resize(argc);
+        }
+        JSArg *args = argc > inline_count ? this->heap_args.data() : this->inline_args;
+        this->ptrs = argc > inline_count ? this->heap_ptrs.data() : this->inline_ptrs;
+        this->owners = argc > inline_count ? this->heap_owners.data() : this->inline_owners;
 
-        return arg;
+        for (int i = 0; i < argc; i++)
+        {
+            this->ptrs[i] = &args[i];
+            this->owners[i] = this->marshal(argv[i], &this->ptrs[i], borrow_typed_arrays);
+        }
     }
 
-    JSArg *jsarg_str(const char *value)
+    ~CArgFrame()
     {
-        JSArg *arg = new JSArg();
-        arg->type = JSARG_TYPE_STRING;
-        
-        char* value_copy = new char[strlen(value) + 1];
-        std::memcpy(value_copy, value, strlen(value) + 1);
-        
-        arg->value.str_val = value_copy;
-
-        return arg;
+        for (int i = 0; i < this->argc; i++)
+        {
+            if (this->owners[i] == OWNER_CSTRING)
+            {
+                JS_FreeCString(this->ctx, this->ptrs[i]->value.str_val);
+            }
+        }
+        // Nested calls rewind to their own mark first.
+        this->arena->rewind(this->arena_mark);
     }
 
-    JSArg *jsarg_double(double value)
-    {
-        JSArg *arg = new JSArg();
-        arg->type = JSARG_TYPE_DOUBLE;
-        arg->value.double_val = value;
+    CArgFrame(const CArgFrame &) = delete;
+    CArgFrame &operator=(const CArgFrame &) = delete;
 
-        return arg;
-    }
-    JSArg *jsarg_float(float value)
+    JSArg **data()
     {
-        JSArg *arg = new JSArg();
-        arg->type = JSARG_TYPE_FLOAT;
-        arg->value.float_val = value;
-
-        return arg;
+        return this->ptrs;
     }
 
-    JSArg *jsarg_int64t(int64_t value)
+private:
+    enum Owner : uint8_t
     {
-        JSArg *arg = new JSArg();
-        arg->type = JSARG_TYPE_INT64_T;
-        arg->value.int64_t_val = value;
+        OWNER_NONE,
+        OWNER_CSTRING
+    };
 
-        return arg;
-    }
+    static constexpr int inline_count = 8;
 
-    JSArg *jsarg_uint32t(uint32_t value)
-    {
-        JSArg *arg = new JSArg();
-        arg->type = JSARG_TYPE_UINT32_T;
-        arg->value.uint32_t_val = value;
+    JSContext *ctx;
+    int argc;
+    EJRArena *arena;
+    EJRArena::Mark arena_mark;
+    JSArg **ptrs;
+    Owner *owners;
 
-        return arg;
-    }
+    JSArg inline_args[inline_count]{};
+    JSArg *inline_ptrs[inline_count];
+    Owner inline_owners[inline_count];
 
-    JSArg *jsarg_bool(bool value)
+    std::vector<JSArg> heap_args;
+    std::vector<JSArg *> heap_ptrs;
+    std::vector<Owner> heap_owners;
+
+    /// @brief Fill *slot from value, same conversions as from_js.
+    Owner marshal(JSValueConst value, JSArg **slot, bool borrow_typed_arrays)
     {
-        JSArg *arg = new JSArg();
-        arg->type = JSARG_TYPE_BOOL;
-        arg->value.bool_val = value;
+        JSArg *arg = *slot;
 
-        return arg;
+        switch (JS_VALUE_GET_NORM_TAG(value))
+        {
+        case JS_TAG_INT:
+            arg->type = JSARG_TYPE_INT;
+            arg->value.int_val = JS_VALUE_GET_INT(value);
+            return OWNER_NONE;
+        case JS_TAG_FLOAT64:
+            arg->type = JSARG_TYPE_DOUBLE;
+            arg->value.double_val = JS_VALUE_GET_FLOAT64(value);
+            return OWNER_NONE;
+        case JS_TAG_BOOL:
+            arg->type = JSARG_TYPE_BOOL;
+            arg->value.bool_val = JS_VALUE_GET_BOOL(value);
+            return OWNER_NONE;
+        case JS_TAG_NULL:
+            // from_js hands these out as strings.
+            arg->type = JSARG_TYPE_STRING;
+            arg->value.str_val = "null";
+            return OWNER_NONE;
+        case JS_TAG_UNDEFINED:
+            arg->type = JSARG_TYPE_STRING;
+            arg->value.str_val = "undefined";
+            return OWNER_NONE;
+        case JS_TAG_STRING:
+        case JS_TAG_STRING_ROPE:
+        {
+            const char *str = JS_ToCString(this->ctx, value);
+            if (!str)
+            {
+                JS_FreeValue(this->ctx, JS_GetException(this->ctx));
+                break;
+            }
+            arg->type = JSARG_TYPE_STRING;
+            arg->value.str_val = str;
+            return OWNER_CSTRING;
+        }
+        case JS_TAG_SHORT_BIG_INT:
+        case JS_TAG_BIG_INT:
+            arg->type = JSARG_TYPE_INT64_T;
+            arg->value.int64_t_val = 0;
+            JS_ToBigInt64(this->ctx, &arg->value.int64_t_val, value);
+            return OWNER_NONE;
+        default:
+            break;
+        }
+
+        // Objects and everything else
+        *slot = ejr_to_jsarg_in(this->arena, ejr::from_js(this->ctx, value, false, borrow_typed_arrays));
+        return OWNER_NONE;
     }
+};
 
-    JSArg *jsarg_carray(size_t count)
-    {
-        JSArg *arg = new JSArg;
-        arg->type = JSARG_TYPE_C_ARRAY;
-        arg->value.c_array_val.capacity = count;
-        arg->value.c_array_val.count = 0;
-        arg->value.c_array_val.items = new JSArg *[count]{nullptr};
+/// @brief Create a Typed Array from C items, copying them.
+static JSValue typed_array_to_js(JSContext *ctx, const void *items, size_t count, JSTypedArrayEnum array_type)
+{
+    size_t size = count * ejr::typed_array_element_size(array_type);
+    JSValue buffer = JS_NewArrayBufferCopy(ctx, static_cast<const uint8_t *>(items), size);
+    return ejr::new_typed_array_from_buffer(ctx, buffer, array_type);
+}
+
+/// @brief Convert a C JSArg straight into a JSValue, same conversions as to_js.
+/// @param ctx the context
+/// @param arg the JSArg
+/// @return a new JSValue
+JSValue jsarg_to_js(JSContext *ctx, const JSArg *arg)
+{
+    if (!arg)
+    {
+        return js_undefined();
+    }
+
+    switch (arg->type)
+    {
+    case JSARG_TYPE_INT:
+        return JS_NewInt32(ctx, arg->value.int_val);
+    case JSARG_TYPE_DOUBLE:
+        return JS_NewFloat64(ctx, arg->value.double_val);
+    case JSARG_TYPE_FLOAT:
+        return JS_NewFloat64(ctx, static_cast<double>(arg->value.float_val));
+    case JSARG_TYPE_STRING:
+        return JS_NewString(ctx, arg->value.str_val ? arg->value.str_val : "");
+    case JSARG_TYPE_BOOL:
+        return JS_NewBool(ctx, arg->value.bool_val);
+    case JSARG_TYPE_INT64_T:
+        return JS_NewBigInt64(ctx, arg->value.int64_t_val);
+    case JSARG_TYPE_UINT32_T:
+        return JS_NewUint32(ctx, arg->value.uint32_t_val);
+    case JSARG_TYPE_NULL:
+        return js_null();
+    case JSARG_TYPE_C_ARRAY:
+    {
+        size_t count = arg->value.c_array_val.items ? arg->value.c_array_val.count : 0;
+        JSValue *values;
+        JSValue array = JS_NewFastArray(ctx, count, &values);
+        if (JS_IsException(array))
+        {
+            return array;
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            values[i] = jsarg_to_js(ctx, arg->value.c_array_val.items[i]);
+        }
+        return array;
+    }
+    case JSARG_TYPE_UINT8_ARRAY:
+        return typed_array_to_js(ctx, arg->value.u8_array_val.items, arg->value.u8_array_val.count, JS_TYPED_ARRAY_UINT8);
+    case JSARG_TYPE_INT32_ARRAY:
+        return typed_array_to_js(ctx, arg->value.i32_array_val.items, arg->value.i32_array_val.count, JS_TYPED_ARRAY_INT32);
+    case JSARG_TYPE_UINT32_ARRAY:
+        return typed_array_to_js(ctx, arg->value.u32_array_val.items, arg->value.u32_array_val.count, JS_TYPED_ARRAY_UINT32);
+    case JSARG_TYPE_INT64_ARRAY:
+        return typed_array_to_js(ctx, arg->value.i64_array_val.items, arg->value.i64_array_val.count, JS_TYPED_ARRAY_BIG_INT64);
+    case JSARG_TYPE_INT8_ARRAY:
+        return typed_array_to_js(ctx, arg->value.i8_array_val.items, arg->value.i8_array_val.count, JS_TYPED_ARRAY_INT8);
+    case JSARG_TYPE_UINT16_ARRAY:
+        return typed_array_to_js(ctx, arg->value.u16_array_val.items, arg->value.u16_array_val.count, JS_TYPED_ARRAY_UINT16);
+    case JSARG_TYPE_INT16_ARRAY:
+        return typed_array_to_js(ctx, arg->value.i16_array_val.items, arg->value.i16_array_val.count, JS_TYPED_ARRAY_INT16);
+    case JSARG_TYPE_UINT64_ARRAY:
+        return typed_array_to_js(ctx, arg->value.u64_array_val.items, arg->value.u64_array_val.count, JS_TYPED_ARRAY_BIG_UINT64);
+    case JSARG_TYPE_FLOAT_ARRAY:
+        return typed_array_to_js(ctx, arg->value.float_array_val.items, arg->value.float_array_val.count, JS_TYPED_ARRAY_FLOAT32);
+    case JSARG_TYPE_ARRAY_VIEW:
+        // A view can not be handed back, the memory is not ours.
+        return typed_array_to_js(ctx, arg->value.array_view_val.items, arg->value.array_view_val.count,
+                                 static_cast<JSTypedArrayEnum>(arg->value.array_view_val.element_type));
+    case JSARG_TYPE_EXCEPTION:
+    {
+        const char *message = arg->value.exception_val.msg ? arg->value.exception_val.msg : "Exception";
+        const char *name = arg->value.exception_val.name ? arg->value.exception_val.name : "Exception";
+        JSValue error = JS_NewError(ctx);
+        const ejr::CommonAtoms &atoms = ejr::common_atoms(ctx);
+        JS_SetProperty(ctx, error, atoms.message, JS_NewString(ctx, message));
+        JS_SetProperty(ctx, error, atoms.name, JS_NewString(ctx, name));
+
+        return error;
+    }
+    case JSARG_TYPE_OBJECT:
+    {
+        const char *const *keys = arg->value.object_val.keys;
+        JSArg *const *values = arg->value.object_val.values;
+        return ejr::record_to_js(
+            ctx, keys ? arg->value.object_val.count : 0,
+            [&](size_t i) { return std::string_view(keys[i]); },
+            [&](size_t i) { return jsarg_to_js(ctx, values[i]); });
+    }
+    default:
+        return js_undefined();
+    }
+}
+
+/// @brief A flat array of C args converted straight into JSValues, freed with the FlatArgs.
+class FlatArgs
+{
+public:
+    FlatArgs(JSContext *ctx, const JSArg *args, size_t arg_count) : ctx(ctx), count(arg_count)
+    {
+        // On the stack for the common case.
+        this->values = this->inline_values;
+        if (arg_count > inline_count)
+        {
+            this->heap_values.resize(arg_count);
+            this->values = this->heap_values.data();
+        }
+        for (size_t i = 0; i < arg_count; i++)
+        {
+            this->values[i] = jsarg_to_js(ctx, &args[i]);
+        }
+    }
+
+    ~FlatArgs()
+    {
+        for (size_t i = 0; i < this->count; i++)
+        {
+            JS_FreeValue(this->ctx, this->values[i]);
+        }
+    }
+
+    FlatArgs(const FlatArgs &) = delete;
+    FlatArgs &operator=(const FlatArgs &) = delete;
+
+    int size() const
+    {
+        return static_cast<int>(this->count);
+    }
+
+    JSValue *data()
+    {
+        return this->values;
+    }
+
+private:
+    static constexpr size_t inline_count = 8;
+
+    JSContext *ctx;
+    size_t count;
+    JSValue *values;
+    JSValue inline_values[inline_count];
+    std::vector<JSValue> heap_values;
+};
+
+/// @brief Number of rows in a batch column, SIZE_MAX if arg is not a column.
+static size_t column_length(const JSArg *column)
+{
+    switch (column->type)
+    {
+    case JSARG_TYPE_C_ARRAY:
+        return column->value.c_array_val.count;
+    case JSARG_TYPE_UINT8_ARRAY:
+        return column->value.u8_array_val.count;
+    case JSARG_TYPE_INT32_ARRAY:
+        return column->value.i32_array_val.count;
+    case JSARG_TYPE_UINT32_ARRAY:
+        return column->value.u32_array_val.count;
+    case JSARG_TYPE_INT64_ARRAY:
+        return column->value.i64_array_val.count;
+    case JSARG_TYPE_INT8_ARRAY:
+        return column->value.i8_array_val.count;
+    case JSARG_TYPE_UINT16_ARRAY:
+        return column->value.u16_array_val.count;
+    case JSARG_TYPE_INT16_ARRAY:
+        return column->value.i16_array_val.count;
+    case JSARG_TYPE_UINT64_ARRAY:
+        return column->value.u64_array_val.count;
+    case JSARG_TYPE_FLOAT_ARRAY:
+        return column->value.float_array_val.count;
+    case JSARG_TYPE_ARRAY_VIEW:
+        return column->value.array_view_val.element_type == JSARG_TYPED_ARRAY_FLOAT16 ? SIZE_MAX : column->value.array_view_val.count;
+    default:
+        return SIZE_MAX;
+    }
+}
+
+/// @brief Element row of a typed array, as a JSValue.
+static JSValue typed_element_to_js(JSContext *ctx, const void *items, JSArgTypedArrayType type, size_t row)
+{
+    switch (type)
+    {
+    case JSARG_TYPED_ARRAY_UINT8C:
+    case JSARG_TYPED_ARRAY_UINT8:
+        return JS_NewInt32(ctx, static_cast<const uint8_t *>(items)[row]);
+    case JSARG_TYPED_ARRAY_INT8:
+        return JS_NewInt32(ctx, static_cast<const int8_t *>(items)[row]);
+    case JSARG_TYPED_ARRAY_INT16:
+        return JS_NewInt32(ctx, static_cast<const int16_t *>(items)[row]);
+    case JSARG_TYPED_ARRAY_UINT16:
+        return JS_NewInt32(ctx, static_cast<const uint16_t *>(items)[row]);
+    case JSARG_TYPED_ARRAY_INT32:
+        return JS_NewInt32(ctx, static_cast<const int32_t *>(items)[row]);
+    case JSARG_TYPED_ARRAY_UINT32:
+        return JS_NewUint32(ctx, static_cast<const uint32_t *>(items)[row]);
+    case JSARG_TYPED_ARRAY_BIG_INT64:
+        return JS_NewBigInt64(ctx, static_cast<const int64_t *>(items)[row]);
+    case JSARG_TYPED_ARRAY_BIG_UINT64:
+        return JS_NewBigUint64(ctx, static_cast<const uint64_t *>(items)[row]);
+    case JSARG_TYPED_ARRAY_FLOAT32:
+        return JS_NewFloat64(ctx, static_cast<const float *>(items)[row]);
+    case JSARG_TYPED_ARRAY_FLOAT64:
+        return JS_NewFloat64(ctx, static_cast<const double *>(items)[row]);
+    default:
+        return js_undefined();
+    }
+}
+
+/// @brief Value of a batch column at row, same conversions as the typed arrays elements.
+static JSValue column_value_to_js(JSContext *ctx, const JSArg *column, size_t row)
+{
+    switch (column->type)
+    {
+    case JSARG_TYPE_C_ARRAY:
+        return jsarg_to_js(ctx, column->value.c_array_val.items[row]);
+    case JSARG_TYPE_UINT8_ARRAY:
+        return typed_element_to_js(ctx, column->value.u8_array_val.items, JSARG_TYPED_ARRAY_UINT8, row);
+    case JSARG_TYPE_INT32_ARRAY:
+        return typed_element_to_js(ctx, column->value.i32_array_val.items, JSARG_TYPED_ARRAY_INT32, row);
+    case JSARG_TYPE_UINT32_ARRAY:
+        return typed_element_to_js(ctx, column->value.u32_array_val.items, JSARG_TYPED_ARRAY_UINT32, row);
+    case JSARG_TYPE_INT64_ARRAY:
+        return typed_element_to_js(ctx, column->value.i64_array_val.items, JSARG_TYPED_ARRAY_BIG_INT64, row);
+    case JSARG_TYPE_INT8_ARRAY:
+        return typed_element_to_js(ctx, column->value.i8_array_val.items, JSARG_TYPED_ARRAY_INT8, row);
+    case JSARG_TYPE_UINT16_ARRAY:
+        return typed_element_to_js(ctx, column->value.u16_array_val.items, JSARG_TYPED_ARRAY_UINT16, row);
+    case JSARG_TYPE_INT16_ARRAY:
+        return typed_element_to_js(ctx, column->value.i16_array_val.items, JSARG_TYPED_ARRAY_INT16, row);
+    case JSARG_TYPE_UINT64_ARRAY:
+        return typed_element_to_js(ctx, column->value.u64_array_val.items, JSARG_TYPED_ARRAY_BIG_UINT64, row);
+    case JSARG_TYPE_FLOAT_ARRAY:
+        return typed_element_to_js(ctx, column->value.float_array_val.items, JSARG_TYPED_ARRAY_FLOAT32, row);
+    case JSARG_TYPE_ARRAY_VIEW:
+        return typed_element_to_js(ctx, column->value.array_view_val.items, column->value.array_view_val.element_type, row);
+    default:
+        return js_undefined();
+    }
+}
+
+/// @brief Write a JS result into row of a array view output column.
+/// @return false with a pending exception if value could not be converted.
+static bool write_view_value(JSContext *ctx, JSArg *out, size_t row, JSValueConst value)
+{
+    void *items = out->value.array_view_val.items;
+    switch (out->value.array_view_val.element_type)
+    {
+    case JSARG_TYPED_ARRAY_FLOAT32:
+    case JSARG_TYPED_ARRAY_FLOAT64:
+    {
+        double number;
+        if (JS_ToFloat64(ctx, &number, value) < 0)
+        {
+            return false;
+        }
+        if (out->value.array_view_val.element_type == JSARG_TYPED_ARRAY_FLOAT32)
+        {
+            static_cast<float *>(items)[row] = static_cast<float>(number);
+        }
+        else
+        {
+            static_cast<double *>(items)[row] = number;
+        }
+        return true;
+    }
+    case JSARG_TYPED_ARRAY_BIG_INT64:
+    case JSARG_TYPED_ARRAY_BIG_UINT64:
+    {
+        int64_t number;
+        if (JS_ToInt64Ext(ctx, &number, value) < 0)
+        {
+            return false;
+        }
+        static_cast<int64_t *>(items)[row] = number;
+        return true;
+    }
+    case JSARG_TYPED_ARRAY_UINT8C:
+    {
+        // Like Uint8ClampedArray: clamped, then rounded half to even (NaN is 0).
+        double number;
+        if (JS_ToFloat64(ctx, &number, value) < 0)
+        {
+            return false;
+        }
+        uint8_t clamped = 0;
+        if (number >= 255)
+        {
+            clamped = 255;
+        }
+        else if (number > 0)
+        {
+            clamped = static_cast<uint8_t>(std::nearbyint(number));
+        }
+        static_cast<uint8_t *>(items)[row] = clamped;
+        return true;
+    }
+    default:
+        break;
+    }
+
+    int32_t number;
+    if (JS_ToInt32(ctx, &number, value) < 0)
+    {
+        return false;
+    }
+    switch (out->value.array_view_val.element_type)
+    {
+    case JSARG_TYPED_ARRAY_UINT8:
+    case JSARG_TYPED_ARRAY_INT8:
+        static_cast<uint8_t *>(items)[row] = static_cast<uint8_t>(number);
+        break;
+    case JSARG_TYPED_ARRAY_INT16:
+    case JSARG_TYPED_ARRAY_UINT16:
+        static_cast<uint16_t *>(items)[row] = static_cast<uint16_t>(number);
+        break;
+    default:
+        static_cast<int32_t *>(items)[row] = number;
+        break;
+    }
+    return true;
+}
+
+/// @brief Call object[fn_name] with a flat array of args. The args are only read.
+/// @param handle the easyjsr runtime
+/// @param object the this object
+/// @param fn_name the function name
+/// @param args the args
+/// @param arg_count number of args
+/// @return the id of the result
+int eval_function_flat(EasyJSRHandle *handle, JSValueConst object, const char *fn_name, const JSArg *args, size_t arg_count)
+{
+    JSContext *ctx = handle->instance->get_context();
+    JSValue function = JS_GetPropertyStr(ctx, object, fn_name);
+
+    JSValue value;
+    {
+        FlatArgs argv(ctx, args, arg_count);
+        value = JS_Call(ctx, function, object, argv.size(), argv.data());
+    }
+    JS_FreeValue(ctx, function);
+
+    return handle->jsvad->add_value(value);
+}
+
+/// @brief Call a C callback, the RawCallback of every C registered function.
+/// @param opaque the CCallback
+JSValue call_c_callback(JSContext *ctx, int argc, JSValueConst *argv, void *opaque)
+{
+    CCallback *callback = static_cast<CCallback *>(opaque);
+
+    JSArg *result;
+    {
+        // JS -> C, released right after the call
+        CArgFrame frame(ctx, argc, argv, callback->borrow_typed_arrays, callback->arena);
+        result = callback->cb(frame.data(), static_cast<size_t>(argc), callback->opaque);
+    }
+
+    // C -> JS
+    JSValue value = jsarg_to_js(ctx, result);
+    jsarg_free(result);
+
+    return value;
+}
+
+/// @brief Frees the native object of a C class object when it is collected.
+static void c_class_finalize(JSRuntime *rt, JSValue value)
+{
+    JSClassID class_id;
+    CObject *object = static_cast<CObject *>(JS_GetAnyOpaque(value, &class_id));
+    if (!object)
+    {
+        return;
+    }
+
+    if (object->cls->finalizer)
+    {
+        object->cls->finalizer(object->native, object->cls->opaque);
+    }
+    delete object;
+}
+
+/// @brief Wrap a native object of a C class, the JS object owns it from here on (even on failure).
+static JSValue new_c_object(JSContext *ctx, EJRClass *cls, JSValueConst new_target, void *native)
+{
+    CObject *object = new CObject{native, cls};
+    JSValue value = ejr::new_class_object(ctx, cls->class_id, new_target, object);
+    if (JS_IsException(value))
+    {
+        if (cls->finalizer)
+        {
+            cls->finalizer(native, cls->opaque);
+        }
+        delete object;
+    }
+    return value;
+}
+
+namespace
+{
+    /// @brief The constructor of a C class.
+    struct CConstructorSlot : ejr::NativeCallback
+    {
+        EJRClass *cls;
+
+        explicit CConstructorSlot(EJRClass *cls) : cls(cls) {}
+
+        /// @brief Only called with new, see EasyJSR::call_class_constructor.
+        static JSValue call(JSContext *ctx, JSValueConst new_target, int argc, JSValueConst *argv, int magic, JSValue *func_data)
+        {
+            auto *slot = static_cast<CConstructorSlot *>(ejr::pointer_from_js(func_data));
+            EJRClass *cls = slot->cls;
+
+            void *native;
+            {
+                // JS -> C, released right after the call
+                CArgFrame frame(ctx, argc, argv, false, &cls->handle->callback_arena);
+                native = cls->constructor(frame.data(), static_cast<size_t>(argc), cls->opaque);
+            }
+            if (!native)
+            {
+                return JS_ThrowInternalError(ctx, "Constructor failed");
+            }
+
+            return new_c_object(ctx, cls, new_target, native);
+        }
+    };
+
+    /// @brief A method, getter or setter of a C class.
+    struct CMethodSlot : ejr::NativeCallback
+    {
+        EJRClass *cls;
+        C_Method method;
+        void *opaque;
+
+        CMethodSlot(EJRClass *cls, C_Method method, void *opaque) : cls(cls), method(method), opaque(opaque) {}
+
+        static JSValue call(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv, int magic, JSValue *func_data)
+        {
+            auto *slot = static_cast<CMethodSlot *>(ejr::pointer_from_js(func_data));
+            // Throws a TypeError if this is not a object of the class.
+            CObject *object = static_cast<CObject *>(JS_GetOpaque2(ctx, this_val, slot->cls->class_id));
+            if (!object)
+            {
+                return JS_EXCEPTION;
+            }
+
+            JSArg *result;
+            {
+                CArgFrame frame(ctx, argc, argv, false, &slot->cls->handle->callback_arena);
+                result = slot->method(object->native, frame.data(), static_cast<size_t>(argc), slot->opaque);
+            }
+
+            // C -> JS
+            JSValue value = jsarg_to_js(ctx, result);
+            jsarg_free(result);
+            return value;
+        }
+    };
+}
+
+/// @brief Convert a JSARG_TYPE_ARRAY_VIEW into a string.
+/// @param arg the JSArg
+/// @return the string
+std::string array_view_to_string(const JSArg *arg)
+{
+    void *items = arg->value.array_view_val.items;
+    size_t count = arg->value.array_view_val.count;
+
+    switch (arg->value.array_view_val.element_type)
+    {
+    case JSARG_TYPED_ARRAY_UINT8C:
+    case JSARG_TYPED_ARRAY_UINT8:
+        return ejr::bytes_to_string<uint8_t>(static_cast<uint8_t *>(items), count);
+    case JSARG_TYPED_ARRAY_INT8:
+        return ejr::bytes_to_string<int8_t>(static_cast<int8_t *>(items), count);
+    case JSARG_TYPED_ARRAY_INT16:
+        return ejr::bytes_to_string<int16_t>(static_cast<int16_t *>(items), count);
+    case JSARG_TYPED_ARRAY_UINT16:
+    case JSARG_TYPED_ARRAY_FLOAT16:
+        return ejr::bytes_to_string<uint16_t>(static_cast<uint16_t *>(items), count);
+    case JSARG_TYPED_ARRAY_INT32:
+        return ejr::bytes_to_string<int32_t>(static_cast<int32_t *>(items), count);
+    case JSARG_TYPED_ARRAY_UINT32:
+        return ejr::bytes_to_string<uint32_t>(static_cast<uint32_t *>(items), count);
+    case JSARG_TYPED_ARRAY_BIG_INT64:
+        return ejr::bytes_to_string<int64_t>(static_cast<int64_t *>(items), count);
+    case JSARG_TYPED_ARRAY_BIG_UINT64:
+        return ejr::bytes_to_string<uint64_t>(static_cast<uint64_t *>(items), count);
+    case JSARG_TYPED_ARRAY_FLOAT32:
+        return ejr::bytes_to_string<float>(static_cast<float *>(items), count);
+    case JSARG_TYPED_ARRAY_FLOAT64:
+        return ejr::bytes_to_string<double>(static_cast<double *>(items), count);
+    default:
+        return "[]";
+    }
+}
+
+extern "C"
+{
+    // Constructors
+    EasyJSRHandle *ejr_new()
+    {
+        ejr::EasyJSR *instance = new ejr::EasyJSR();
+        JSValueAD *jsvad = new JSValueAD(instance->get_context());
+        EasyJSRHandle *handle = new EasyJSRHandle(instance, jsvad);
+        return handle;
+    }
+
+    EJRContextTemplate *ejr_template_new()
+    {
+        return new EJRContextTemplate();
+    }
+
+    void ejr_template_set_intrinsics(EJRContextTemplate *tmpl, uint32_t intrinsics)
+    {
+        if (!tmpl)
+        {
+            return;
+        }
+
+        tmpl->context_template.set_intrinsics(intrinsics);
+    }
+
+    void ejr_template_register_callback(EJRContextTemplate *tmpl, const char *fn_name, C_Callback cb, void *opaque)
+    {
+        if (!valid_ptrs({tmpl, fn_name}))
+        {
+            return;
+        }
+
+        std::string fn_name_str = std::string(fn_name);
+        tmpl->context_template.add_step([fn_name_str, cb, opaque](ejr::EasyJSR &runtime) {
+            auto set = std::make_shared<CCallbackSet>();
+            runtime.register_raw_callback(fn_name_str, call_c_callback, set->add(cb, opaque));
+            runtime.keep_alive(std::move(set));
+        });
+    }
+
+    void ejr_template_register_module(EJRContextTemplate *tmpl, const char *module_name, JSMethod *methods, size_t method_count)
+    {
+        if (!valid_ptrs({tmpl, module_name, methods}))
+        {
+            return;
+        }
+
+        // Copy the methods, the names may not outlive this call.
+        std::string module_name_str = std::string(module_name);
+        std::vector<std::string> names;
+        std::vector<JSMethod> c_methods(methods, methods + method_count);
+        for (const JSMethod &method : c_methods)
+        {
+            names.push_back(std::string(method.name));
+        }
+
+        tmpl->context_template.add_step([module_name_str, names, c_methods](ejr::EasyJSR &runtime) {
+            auto set = std::make_shared<CCallbackSet>();
+            std::vector<ejr::JSMethod> ejr_methods;
+            ejr_methods.reserve(c_methods.size());
+            for (size_t i = 0; i < c_methods.size(); ++i)
+            {
+                ejr_methods.push_back(ejr::JSMethod{names[i], call_c_callback, set->add(c_methods[i].cb, c_methods[i].opaque)});
+            }
+            runtime.register_module(module_name_str, ejr_methods);
+            runtime.keep_alive(std::move(set));
+        });
+    }
+
+    bool ejr_template_add_prelude(EJRContextTemplate *tmpl, const char *js, const char *file_name, bool is_module)
+    {
+        if (!valid_ptrs({tmpl, js, file_name}))
+        {
+            return false;
+        }
+
+        return is_module ? tmpl->context_template.add_prelude_module(js, file_name)
+                         : tmpl->context_template.add_prelude_script(js, file_name);
+    }
+
+    const char *ejr_template_error(EJRContextTemplate *tmpl)
+    {
+        if (!tmpl)
+        {
+            return "";
+        }
+
+        return tmpl->context_template.get_error().c_str();
+    }
+
+    void ejr_template_prewarm(EJRContextTemplate *tmpl, size_t count)
+    {
+        if (!tmpl)
+        {
+            return;
+        }
+
+        tmpl->context_template.prewarm(count);
+    }
+
+    EasyJSRHandle *ejr_new_from_template(EJRContextTemplate *tmpl)
+    {
+        if (!tmpl)
+        {
+            return nullptr;
+        }
+
+        ejr::EasyJSR *instance = tmpl->context_template.instantiate().release();
+        JSValueAD *jsvad = new JSValueAD(instance->get_context());
+        EasyJSRHandle *handle = new EasyJSRHandle(instance, jsvad);
+        return handle;
+    }
+
+    void ejr_template_free(EJRContextTemplate *tmpl)
+    {
+        delete tmpl;
+    }
+
+    JSArg *jsarg_int_in(EJRArena *arena, int value)
+    {
+        JSArg *arg = new_jsarg(arena, JSARG_TYPE_INT);
+        arg->value.int_val = value;
+
+        return arg;
+    }
+
+    JSArg *jsarg_int(int value)
+    {
+        return jsarg_int_in(nullptr, value);
+    }
+
+    JSArg *jsarg_str_in(EJRArena *arena, const char *value)
+    {
+        JSArg *arg = new_jsarg(arena, JSARG_TYPE_STRING);
+        arg->value.str_val = copy_str(arena, value);
+
+        return arg;
+    }
+
+    JSArg *jsarg_str(const char *value)
+    {
+        return jsarg_str_in(nullptr, value);
+    }
+
+    JSArg *jsarg_double_in(EJRArena *arena, double value)
+    {
+        JSArg *arg = new_jsarg(arena, JSARG_TYPE_DOUBLE);
+        arg->value.double_val = value;
+
+        return arg;
+    }
+
+    JSArg *jsarg_double(double value)
+    {
+        return jsarg_double_in(nullptr, value);
+    }
+
+    JSArg *jsarg_float_in(EJRArena *arena, float value)
+    {
+        JSArg *arg = new_jsarg(arena, JSARG_TYPE_FLOAT);
+        arg->value.float_val = value;
+
+        return arg;
+    }
+
+    JSArg *jsarg_float(float value)
+    {
+        return jsarg_float_in(nullptr, value);
+    }
+
+    JSArg *jsarg_int64t_in(EJRArena *arena, int64_t value)
+    {
+        JSArg *arg = new_jsarg(arena, JSARG_TYPE_INT64_T);
+        arg->value.int64_t_val = value;
+
+        return arg;
+    }
+
+    JSArg *jsarg_int64t(int64_t value)
+    {
+        return jsarg_int64t_in(nullptr, value);
+    }
+
+    JSArg *jsarg_uint32t_in(EJRArena *arena, uint32_t value)
+    {
+        JSArg *arg = new_jsarg(arena, JSARG_TYPE_UINT32_T);
+        arg->value.uint32_t_val = value;
+
+        return arg;
+    }
+
+    JSArg *jsarg_uint32t(uint32_t value)
+    {
+        return jsarg_uint32t_in(nullptr, value);
+    }
+
+    JSArg *jsarg_bool_in(EJRArena *arena, bool value)
+    {
+        JSArg *arg = new_jsarg(arena, JSARG_TYPE_BOOL);
+        arg->value.bool_val = value;
+
+        return arg;
+    }
+
+    JSArg *jsarg_bool(bool value)
+    {
+        return jsarg_bool_in(nullptr, value);
+    }
+
+    JSArg *jsarg_carray_in(EJRArena *arena, size_t count)
+    {
+        JSArg *arg = new_jsarg(arena, JSARG_TYPE_C_ARRAY);
+        arg->value.c_array_val.capacity = count;
+        arg->value.c_array_val.count = 0;
+        arg->value.c_array_val.items = arena ? arena->allocate_array<JSArg *>(count) : new JSArg *[count]{nullptr};
+
+        return arg;
+    }
+
+    JSArg *jsarg_carray(size_t count)
+    {
+        return jsarg_carray_in(nullptr, count);
+    }
+
+    JSArg *jsarg_null_in(EJRArena *arena)
+    {
+        return new_jsarg(arena, JSARG_TYPE_NULL);
+    }
+
+    JSArg *jsarg_null()
+    {
+        return jsarg_null_in(nullptr);
+    }
+
+    JSArg *jsarg_undefined_in(EJRArena *arena)
+    {
+        return new_jsarg(arena, JSARG_TYPE_UNDEFINED);
+    }
+
+    JSArg *jsarg_undefined()
+    {
+        return jsarg_undefined_in(nullptr);
+    }
+
+    JSArg *jsarg_u8_array_in(EJRArena *arena, const uint8_t *args, size_t argc)
+    {
+        JSArg *arg = new_jsarg(arena, JSARG_TYPE_UINT8_ARRAY);
+        arg->value.u8_array_val.count = argc;
+
+        // Allocate internal copy
+        arg->value.u8_array_val.items = copy_items(arena, args, argc);
+
+        return arg;
+    }
+
+    JSArg *jsarg_u8_array(const uint8_t *args, size_t argc)
+    {
+        return jsarg_u8_array_in(nullptr, args, argc);
+    }
+
+    JSArg *jsarg_i32_array_in(EJRArena *arena, const int32_t *args, size_t argc)
+    {
+        JSArg *arg = new_jsarg(arena, JSARG_TYPE_INT32_ARRAY);
+        arg->value.i32_array_val.count = argc;
+
+        // Allocate internal copy
+        arg->value.i32_array_val.items = copy_items(arena, args, argc);
+
+        return arg;
+    }
+
+    JSArg *jsarg_i32_array(const int32_t *args, size_t argc)
+    {
+        return jsarg_i32_array_in(nullptr, args, argc);
+    }
+
+    JSArg *jsarg_u32_array_in(EJRArena *arena, const uint32_t *args, size_t argc)
+    {
+        JSArg *arg = new_jsarg(arena, JSARG_TYPE_UINT32_ARRAY);
+        arg->value.u32_array_val.count = argc;
+
+        // Allocate internal copy
+        arg->value.u32_array_val.items = copy_items(arena, args, argc);
+
+        return arg;
+    }
+
+    JSArg *jsarg_u32_array(const uint32_t *args, size_t argc)
+    {
+        return jsarg_u32_array_in(nullptr, args, argc);
+    }
+
+    JSArg *jsarg_i64_array_in(EJRArena *arena, const int64_t *args, size_t argc)
+    {
+        JSArg *arg = new_jsarg(arena, JSARG_TYPE_INT64_ARRAY);
+        arg->value.i64_array_val.count = argc;
+
+        // Allocate internal copy
+        arg->value.i64_array_val.items = copy_items(arena, args, argc);
+
+        return arg;
+    }
+
+    JSArg *jsarg_i64_array(const int64_t *args, size_t argc)
+    {
+        return jsarg_i64_array_in(nullptr, args, argc);
+    }
+
+    JSArg *jsarg_i8_array_in(EJRArena *arena, const int8_t *args, size_t argc)
+    {
+        JSArg *arg = new_jsarg(arena, JSARG_TYPE_INT8_ARRAY);
+        arg->value.i8_array_val.count = argc;
+
+        // Allocate internal copy
+        arg->value.i8_array_val.items = copy_items(arena, args, argc);
+
+        return arg;
+    }
+
+    JSArg *jsarg_i8_array(const int8_t *args, size_t argc)
+    {
+        return jsarg_i8_array_in(nullptr, args, argc);
+    }
+
+    JSArg *jsarg_i16_array_in(EJRArena *arena, const int16_t *args, size_t argc)
+    {
+        JSArg *arg = new_jsarg(arena, JSARG_TYPE_INT16_ARRAY);
+        arg->value.i16_array_val.count = argc;
+
+        // Allocate internal copy
+        arg->value.i16_array_val.items = copy_items(arena, args, argc);
+
+        return arg;
+    }
+
+    JSArg *jsarg_i16_array(const int16_t *args, size_t argc)
+    {
+        return jsarg_i16_array_in(nullptr, args, argc);
+    }
+
+    JSArg *jsarg_u16_array_in(EJRArena *arena, const uint16_t *args, size_t argc)
+    {
+        JSArg *arg = new_jsarg(arena, JSARG_TYPE_UINT16_ARRAY);
+        arg->value.u16_array_val.count = argc;
+
+        // Allocate internal copy
+        arg->value.u16_array_val.items = copy_items(arena, args, argc);
+
+        return arg;
+    }
+
+    JSArg *jsarg_u16_array(const uint16_t *args, size_t argc)
+    {
+        return jsarg_u16_array_in(nullptr, args, argc);
+    }
+
+    JSArg *jsarg_u64_array_in(EJRArena *arena, const uint64_t *args, size_t argc)
+    {
+        JSArg *arg = new_jsarg(arena, JSARG_TYPE_UINT64_ARRAY);
+        arg->value.u64_array_val.count = argc;
+
+        // Allocate internal copy
+        arg->value.u64_array_val.items = copy_items(arena, args, argc);
+
+        return arg;
+    }
+
+    JSArg *jsarg_u64_array(const uint64_t *args, size_t argc)
+    {
+        return jsarg_u64_array_in(nullptr, args, argc);
+    }
+
+    JSArg *jsarg_float_array_in(EJRArena *arena, const float *args, size_t argc)
+    {
+        JSArg *arg = new_jsarg(arena, JSARG_TYPE_FLOAT_ARRAY);
+        arg->value.float_array_val.count = argc;
+
+        // Allocate internal copy
+        arg->value.float_array_val.items = copy_items(arena, args, argc);
+
+        return arg;
+    }
+
+    JSArg *jsarg_float_array(const float *args, size_t argc)
+    {
+        return jsarg_float_array_in(nullptr, args, argc);
+    }
+
+    JSArg *jsarg_exception_in(EJRArena *arena, const char *message, const char *name)
+    {
+        JSArg *arg = new_jsarg(arena, JSARG_TYPE_EXCEPTION);
+        arg->value.exception_val.msg = copy_str(arena, message);
+        arg->value.exception_val.name = copy_str(arena, name);
+
+        return arg;
+    }
+
+    JSArg *jsarg_exception(const char *message, const char *name)
+    {
+        return jsarg_exception_in(nullptr, message, name);
+    }
+
+    JSArg *jsarg_array_view_in(EJRArena *arena, void *items, size_t count, JSArgTypedArrayType element_type)
+    {
+        JSArg *arg = new_jsarg(arena, JSARG_TYPE_ARRAY_VIEW);
+        arg->value.array_view_val.items = items;
+        arg->value.array_view_val.count = count;
+        arg->value.array_view_val.element_type = element_type;
+
+        return arg;
+    }
+
+    JSArg *jsarg_array_view(void *items, size_t count, JSArgTypedArrayType element_type)
+    {
+        return jsarg_array_view_in(nullptr, items, count, element_type);
+    }
+
+    JSArg *jsarg_object_in(EJRArena *arena, size_t capacity)
+    {
+        JSArg *arg = new_jsarg(arena, JSARG_TYPE_OBJECT);
+        arg->value.object_val.capacity = capacity;
+        arg->value.object_val.count = 0;
+        arg->value.object_val.keys = arena ? arena->allocate_array<const char *>(capacity) : new const char *[capacity]{nullptr};
+        arg->value.object_val.values = arena ? arena->allocate_array<JSArg *>(capacity) : new JSArg *[capacity]{nullptr};
+
+        return arg;
+    }
+
+    JSArg *jsarg_object(size_t capacity)
+    {
+        return jsarg_object_in(nullptr, capacity);
+    }
+
+    void jsarg_add_entry_to_object_in(EJRArena *arena, JSArg *arg, const char *key, JSArg *value)
+    {
+        if (!valid_ptrs({arg, key, value}) || arg->type != JSARG_TYPE_OBJECT)
+        {
+            return;
+        }
+
+        size_t count = arg->value.object_val.count;
+        if (!arg->value.object_val.keys || count >= arg->value.object_val.capacity)
+        {
+            return;
+        }
+
+        arg->value.object_val.keys[count] = copy_str(arena, key);
+        arg->value.object_val.values[count] = value;
+        arg->value.object_val.count++;
+    }
+
+    void jsarg_add_entry_to_object(JSArg *arg, const char *key, JSArg *value)
+    {
+        jsarg_add_entry_to_object_in(nullptr, arg, key, value);
+    }
+
+    EJRArena *ejr_arena_new(size_t block_size)
+    {
+        return new EJRArena(block_size);
+    }
+
+    void ejr_arena_reset(EJRArena *arena)
+    {
+        if (!arena)
+        {
+            return;
+        }
+        arena->reset();
+    }
+
+    void ejr_arena_free(EJRArena *arena)
+    {
+        delete arena;
+    }
+
+    void jsarg_add_value_to_c_array(JSArg *arg, JSArg *value)
+    {
+        if (!arg || !value)
+        {
+            return;
+        }
+
+        if (arg->type != JSARG_TYPE_C_ARRAY)
+        {
+            return;
+        }
+
+        size_t capacity = arg->value.c_array_val.capacity;
+        JSArg **items = arg->value.c_array_val.items;
+        size_t count = arg->value.c_array_val.count;
+
+        if (!items)
+        {
+            return;
+        }
+
+        if (count >= capacity) {
+            // Not enough space...
+            // TODO: some kind of error log OR grow the memory...
+            return;
+        }
+
+        // Update mem
+        items[count] = value;
+        arg->value.c_array_val.count++;
+    }
+
+    JSArg *jsarg_from_jsvalue(EasyJSRHandle *handle, int value)
+    {
+        if (!valid_ptrs({handle, handle->jsvad, handle->instance}) || value < 0)
+        {
+            return jsarg_null();
+        }
+
+        JSValue jsvalue = handle->jsvad->get(value);
+
+        // Get the jsarg but also free the JSValue since we ain't finna use it later.
+        ejr::JSArg ejr_arg = handle->instance->jsvalue_to_jsarg(jsvalue, false);
+        handle->jsvad->free_value(handle->instance, value);
+
+        return ejr_to_jsarg(ejr_arg);
+    }
+
+    JSArg **jsarg_make_list(size_t argc)
+    {
+        JSArg **list = new JSArg *[argc];
+        for (size_t i = 0; i < argc; i++)
+        {
+            list[i] = jsarg_undefined();
+        }
+
+        return list;
+    }
+
+    JSArg **jsarg_make_list_in(EJRArena *arena, size_t argc)
+    {
+        if (!arena)
+        {
+            return jsarg_make_list(argc);
+        }
+
+        JSArg **list = arena->allocate_array<JSArg *>(argc);
+        for (size_t i = 0; i < argc; i++)
+        {
+            list[i] = jsarg_undefined_in(arena);
+        }
+
+        return list;
+    }
+
+    void jsarg_free_all(JSArg **args, size_t argc)
+    {
+        if (args == nullptr)
+        {
+            return;
+        }
+
+        for (size_t i = 0; i < argc; ++i)
+        {
+            if (args[i] == nullptr)
+            {
+                continue;
+            }
+            jsarg_free(args[i]);
+        }
+
+        delete[] args;
+    }
+
+    void jsarg_add_to_list(JSArg **jsarg, JSArg *njsarg, size_t i)
+    {
+        if (!valid_ptrs({jsarg, njsarg}))
+        {
+            return;
+        }
+
+        // Replace the placeholder
+        jsarg_free(jsarg[i]);
+        jsarg[i] = njsarg;
+    }
+
+    // Deleters
+    void ejr_free(EasyJSRHandle *handle)
+    {
+        if (!handle)
+        {
+            return;
+        }
+
+        // Prepared functions hold values too
+        for (EJRPreparedFunction *prepared : handle->prepared_functions)
+        {
+            delete prepared;
+        }
+        handle->prepared_functions.clear();
 
-        return arg;
+        for (EJRKey *key : handle->keys)
+        {
+            delete key;
+        }
+        handle->keys.clear();
+
+        // Free jsvad first
+        if (handle->jsvad)
+        {
+            handle->jsvad->free(handle->instance);
+            delete handle->jsvad;
+        }
+
+        if (handle->instance)
+        {
+            delete handle->instance;
+        }
+
+        delete handle;
     }
 
-    JSArg *jsarg_null()
+    void jsarg_free_value(JSArg *arg)
     {
-        JSArg *arg = new JSArg();
-        arg->type = JSARG_TYPE_NULL;
+        // Arena args are released with their arena.
+        if (!arg || arg->in_arena)
+        {
+            return;
+        }
+        switch (arg->type)
+        {
+        case JSARG_TYPE_STRING:
+            delete[] arg->value.str_val;
+            break;
+
+        case JSARG_TYPE_EXCEPTION:
+            delete[] arg->value.exception_val.msg;
+            delete[] arg->value.exception_val.name;
+            break;
+
+        case JSARG_TYPE_C_ARRAY:
+            if (arg->value.c_array_val.items)
+            {
+                for (size_t i = 0; i < arg->value.c_array_val.count; ++i)
+                {
+                    jsarg_free(arg->value.c_array_val.items[i]);
+                }
+                delete[] arg->value.c_array_val.items;
+            }
+            break;
+        case JSARG_TYPE_OBJECT:
+            if (arg->value.object_val.keys)
+            {
+                for (size_t i = 0; i < arg->value.object_val.count; ++i)
+                {
+                    delete[] arg->value.object_val.keys[i];
+                    jsarg_free(arg->value.object_val.values[i]);
+                }
+                delete[] arg->value.object_val.keys;
+                delete[] arg->value.object_val.values;
+            }
+            break;
+        case JSARG_TYPE_UINT8_ARRAY:
+            if (arg->value.u8_array_val.items)
+            {
+                delete[] arg->value.u8_array_val.items;
+            }
+            break;
+        case JSARG_TYPE_INT32_ARRAY:
+            if (arg->value.i32_array_val.items)
+            {
+                delete[] arg->value.i32_array_val.items;
+            }
+            break;
+        case JSARG_TYPE_UINT32_ARRAY:
+            if (arg->value.u32_array_val.items)
+            {
+                delete[] arg->value.u32_array_val.items;
+            }
+            break;
+        case JSARG_TYPE_INT64_ARRAY:
+            if (arg->value.i64_array_val.items)
+            {
+                delete[] arg->value.i64_array_val.items;
+            }
+            break;
+        case JSARG_TYPE_INT8_ARRAY:
+            if (arg->value.i8_array_val.items)
+            {
+                delete[] arg->value.i8_array_val.items;
+            }
+            break;
+        case JSARG_TYPE_UINT16_ARRAY:
+            if (arg->value.u16_array_val.items)
+            {
+                delete[] arg->value.u16_array_val.items;
+            }
+            break;
+        case JSARG_TYPE_INT16_ARRAY:
+            if (arg->value.i16_array_val.items)
+            {
+                delete[] arg->value.i16_array_val.items;
+            }
+            break;
+        case JSARG_TYPE_UINT64_ARRAY:
+            if (arg->value.u64_array_val.items)
+            {
+                delete[] arg->value.u64_array_val.items;
+            }
+            break;
+        case JSARG_TYPE_FLOAT_ARRAY:
+            if (arg->value.float_array_val.items)
+            {
+                delete[] arg->value.float_array_val.items;
+            }
+            break;
+
+        default:
+            break;
+        }
 
-        return arg;
     }
 
-    JSArg *jsarg_undefined()
+    void jsarg_free(JSArg *arg)
     {
-        JSArg *arg = new JSArg();
-        arg->type = JSARG_TYPE_UNDEFINED;
+        // Arena args are released with their arena.
+        if (!arg || arg->in_arena)
+        {
+            return;
+        }
 
-        return arg;
+        jsarg_free_value(arg);
+        delete arg;
     }
 
-    JSArg *jsarg_u8_array(const uint8_t *args, size_t argc)
+    // EasyJSR specific
+
+    void ejr_set_file_loader(EasyJSRHandle *handle, C_FileLoaderFn fn, void *opaque)
     {
-        JSArg *arg = new JSArg();
-        arg->type = JSARG_TYPE_UINT8_ARRAY;
-        arg->value.u8_array_val.count = argc;
+        if (!valid_ptrs({handle, handle->instance}))
+        {
+            return;
+        }
 
-        // Allocate internal copy
-        arg->value.u8_array_val.items = new uint8_t[argc];
-        std::memcpy((void*)arg->value.u8_array_val.items, args, argc * sizeof(uint8_t));
+        auto wrapper = [fn, opaque](const std::string &file_path) -> std::string
+        {
+            // Convert C++ -> C
+            const char *file_path_c_str = file_path.c_str();
 
-        return arg;
+            // Call raw C
+            char *result = fn(file_path_c_str, opaque);
+
+            // Convert C -> C++
+            std::string result_str(result);
+
+            return result_str;
+        };
+
+        // Register in ejr
+        handle->instance->set_file_loader(wrapper);
     }
 
-    JSArg *jsarg_i32_array(const int32_t *args, size_t argc)
+    int ejr_eval_script(EasyJSRHandle *handle, const char *js, const char *file_name)
     {
-        JSArg *arg = new JSArg();
-        arg->type = JSARG_TYPE_INT32_ARRAY;
-        arg->value.i32_array_val.count = argc;
+        if (!valid_ptrs({handle, handle->jsvad, handle->instance}))
+        {
+            return -1;
+        }
 
-        // Allocate internal copy
-        arg->value.i32_array_val.items = new int32_t[argc];
-        std::memcpy((void*)arg->value.i32_array_val.items, args, argc * sizeof(int32_t));
+        // Convert to string
+        std::string js_str = std::string(js);
+        std::string file_name_string = std::string(file_name);
 
-        return arg;
+        // Call
+        JSValue value = handle->instance->eval_script(js_str, file_name_string);
+        // Create new result
+        int result = handle->jsvad->add_value(value);
+
+        return result;
     }
 
-    JSArg *jsarg_u32_array(const uint32_t *args, size_t argc)
+    void ejr_set_bytecode_cache(EasyJSRHandle *handle, const char *directory)
     {
-        JSArg *arg = new JSArg();
-        arg->type = JSARG_TYPE_UINT32_ARRAY;
-        arg->value.u32_array_val.count = argc;
+        if (!valid_ptrs({handle, handle->instance}))
+        {
+            return;
+        }
 
-        // Allocate internal copy
-        arg->value.u32_array_val.items = new uint32_t[argc];
-        std::memcpy((void*)arg->value.u32_array_val.items, args, argc * sizeof(uint32_t));
+        handle->instance->set_bytecode_cache(directory ? std::make_shared<ejr::BytecodeCache>(directory) : nullptr);
+    }
 
-        return arg;
+    bool ejr_bytecode_cache_stats(EasyJSRHandle *handle, size_t *hits, size_t *misses)
+    {
+        if (!valid_ptrs({handle, handle->instance, hits, misses}) || !handle->instance->get_bytecode_cache())
+        {
+            return false;
+        }
+
+        *hits = handle->instance->get_bytecode_cache()->hits();
+        *misses = handle->instance->get_bytecode_cache()->misses();
+        return true;
     }
 
-    JSArg *jsarg_i64_array(const int64_t *args, size_t argc)
+    int ejr_eval_bytecode(EasyJSRHandle *handle, const uint8_t *bundle, size_t size, bool in_place)
     {
-        JSArg *arg = new JSArg();
-        arg->type = JSARG_TYPE_INT64_ARRAY;
-        arg->value.i64_array_val.count = argc;
+        if (!valid_ptrs({handle, handle->jsvad, handle->instance, bundle}))
+        {
+            return -1;
+        }
 
-        // Allocate internal copy
-        arg->value.i64_array_val.items = new int64_t[argc];
-        std::memcpy((void*)arg->value.i64_array_val.items, args, argc * sizeof(int64_t));
+        JSValue value = handle->instance->eval_bytecode(bundle, size, in_place);
+        if (JS_IsException(value) || static_cast<int>(JS_PromiseState(handle->instance->get_context(), value)) < 0)
+        {
+            return handle->jsvad->add_value(value);
+        }
 
-        return arg;
+        // Modules give a promise, like in ejr_eval_module.
+        JSValue promise_result = handle->instance->await_promise(value);
+        handle->instance->free_jsval(value);
+
+        return handle->jsvad->add_value(promise_result);
     }
 
-    JSArg *jsarg_i8_array(const int8_t *args, size_t argc)
+    bool ejr_mount_bytecode_bundle(EasyJSRHandle *handle, const char *path)
     {
-        JSArg *arg = new JSArg();
-        arg->type = JSARG_TYPE_INT8_ARRAY;
-        arg->value.i8_array_val.count = argc;
+        if (!valid_ptrs({handle, handle->instance, path}))
+        {
+            return false;
+        }
 
-        // Allocate internal copy
-        arg->value.i8_array_val.items = new int8_t[argc];
-        std::memcpy((void*)arg->value.i8_array_val.items, args, argc * sizeof(int8_t));
+        auto bundle = ejr::MappedBytecodeBundle::open(path);
+        if (!bundle)
+        {
+            return false;
+        }
+        handle->instance->mount_bytecode_bundle(std::move(bundle));
+        return true;
+    }
 
-        return arg;
+    void ejr_set_module_cache_enabled(EasyJSRHandle *handle, bool enabled)
+    {
+        if (!valid_ptrs({handle, handle->instance}))
+        {
+            return;
+        }
+
+        handle->instance->set_module_cache_enabled(enabled);
     }
 
-    JSArg *jsarg_i16_array(const int16_t *args, size_t argc)
+    bool ejr_module_cache_stats(size_t *hits, size_t *misses, size_t *modules)
     {
-        JSArg *arg = new JSArg();
-        arg->type = JSARG_TYPE_INT16_ARRAY;
-        arg->value.i16_array_val.count = argc;
+        if (!valid_ptrs({hits, misses, modules}))
+        {
+            return false;
+        }
 
-        // Allocate internal copy
-        arg->value.i16_array_val.items = new int16_t[argc];
-        std::memcpy((void*)arg->value.i16_array_val.items, args, argc * sizeof(int16_t));
+        ejr::ModuleCache &cache = ejr::ModuleCache::shared();
+        *hits = cache.hits();
+        *misses = cache.misses();
+        *modules = cache.size();
+        return true;
+    }
+
+    void ejr_clear_module_cache()
+    {
+        ejr::ModuleCache::shared().clear();
+    }
+
+    int ejr_eval_module(EasyJSRHandle *handle, const char *js, const char *file_name)
+    {
+        if (!valid_ptrs({handle, handle->jsvad, handle->instance}))
+        {
+            return -1;
+        }
+
+        // Convert to string
+        std::string js_str = std::string(js);
+        std::string file_name_str = std::string(file_name);
+
+        // Call
+        JSValue value = handle->instance->eval_module(js_str, file_name_str);
+
+        // Check if value is not a promise
+        if (JS_IsException(value)) {
+            return handle->jsvad->add_value(value);
+        }
+
+        JSValue promise_result = handle->instance->await_promise(value);
+
+        // Free value (We might not need this actually... becuase quickjs might free the value themselves.) 
+        handle->instance->free_jsval(value);
+
+        return handle->jsvad->add_value(promise_result);
+    }
+
+    int ejr_eval_function(EasyJSRHandle *handle, const char *fn_name, JSArg **args, size_t arg_count)
+    {
+        if (!valid_ptrs({handle, handle->jsvad, handle->instance, args}))
+        {
+            return -1;
+        }
+
+        // Conver to string
+        std::string fn_name_str = std::string(fn_name);
+
+        // Convert args
+        ejr::JSArgs ejr_jsargs;
+        ejr_jsargs.reserve(arg_count);
+
+        for (size_t i = 0; i < arg_count; ++i)
+        {
+            JSArg arg = *args[i];
+            ejr_jsargs.push_back(jsarg_to_ejr(arg));
+        }
+
+        // Call the function
+        JSValue value = handle->instance->eval_function(fn_name_str, ejr_jsargs);
+
+        // Free input args
+        jsarg_free_all(args, arg_count);
 
-        return arg;
+        return handle->jsvad->add_value(value);
     }
 
-    JSArg *jsarg_u16_array(const uint16_t *args, size_t argc)
+    int ejr_eval_function_flat(EasyJSRHandle *handle, const char *fn_name, const JSArg *args, size_t arg_count)
     {
-        JSArg *arg = new JSArg();
-        arg->type = JSARG_TYPE_UINT16_ARRAY;
-        arg->value.u16_array_val.count = argc;
+        if (!valid_ptrs({handle, handle->jsvad, handle->instance}) || (arg_count > 0 && !args))
+        {
+            return -1;
+        }
 
-        // Allocate internal copy
-        arg->value.u16_array_val.items = new uint16_t[argc];
-        std::memcpy((void*)arg->value.u16_array_val.items, args, argc * sizeof(uint16_t));
+        JSContext *ctx = handle->instance->get_context();
+        JSValue global = JS_GetGlobalObject(ctx);
+        int value = eval_function_flat(handle, global, fn_name, args, arg_count);
+        JS_FreeValue(ctx, global);
 
-        return arg;
+        return value;
     }
 
-    JSArg *jsarg_u64_array(const uint64_t *args, size_t argc)
+    char *ejr_val_to_string(EasyJSRHandle *handle, int value_id)
     {
-        JSArg *arg = new JSArg();
-        arg->type = JSARG_TYPE_UINT64_ARRAY;
-        arg->value.u64_array_val.count = argc;
-
-        // Allocate internal copy
-        arg->value.u64_array_val.items = new uint64_t[argc];
-        std::memcpy((void*)arg->value.u64_array_val.items, args, argc * sizeof(uint64_t));
-
-        return arg;
-    }
+        if (!valid_ptrs({handle, handle->jsvad, handle->instance}))
+        {
+            return nullptr;
+        }
 
+        // Get our value
+        JSValue value = handle->jsvad->get(value_id);
+        if (JS_IsUndefined(value))
+        {
+            return nullptr;
+        }
 
-    JSArg *jsarg_float_array(const float *args, size_t argc)
-    {
-        JSArg *arg = new JSArg();
-        arg->type = JSARG_TYPE_FLOAT_ARRAY;
-        arg->value.float_array_val.count = argc;
+        // Get our string
+        std::string str = handle->instance->val_to_string(value, false).c_str();
 
-        // Allocate internal copy
-        arg->value.float_array_val.items = new float[argc];
-        std::memcpy((void*)arg->value.float_array_val.items, args, argc * sizeof(float));
+        // convert it to c_str
+        char *c_str = new char[str.size() + 1];
+        std::memcpy(c_str, str.c_str(), str.size() + 1);
 
-        return arg;
+        return c_str;
     }
 
-    JSArg* jsarg_exception(const char* message, const char* name) {
-        JSArg* arg = new JSArg();
-        arg->type = JSARG_TYPE_EXCEPTION;
+    int ejr_eval_class_function(EasyJSRHandle *handle, int value_id, const char *fn_name, JSArg **args, size_t arg_count)
+    {
+        if (!valid_ptrs({handle, handle->jsvad, handle->instance, args}))
+        {
+            return -1;
+        }
 
-        char* message_copy = new char[strlen(message) + 1]; // nullptr
-        char* name_copy = new char[strlen(name) + 1]; // nullptr
+        // Convert fn_name to string
+        std::string fn_name_str = std::string(fn_name);
+        // Get JSValue from jsvad
+        JSValue object = handle->jsvad->get(value_id);
+        if (JS_IsUndefined(object))
+        {
+            return -1;
+        }
 
-        std::memcpy(message_copy, message, strlen(message) + 1);
-        std::memcpy(name_copy, name, strlen(name) + 1);
+        // Convert JSArgs to ejr::JSArg
+        ejr::JSArgs jsargs;
+        jsargs.reserve(arg_count);
+        for (size_t i = 0; i < arg_count; ++i)
+        {
+            JSArg arg = *args[i];
+            jsargs.push_back(jsarg_to_ejr(arg));
+        }
+        // Call
+        JSValue value = handle->instance->eval_class_function(object, fn_name_str, jsargs);
 
-        arg->value.exception_val.msg = message_copy;
-        arg->value.exception_val.name = name_copy;
+        // Free input args
+        jsarg_free_all(args, arg_count);
 
-        return arg;
+        // Return id
+        return handle->jsvad->add_value(value);
     }
-    
-    void jsarg_add_value_to_c_array(JSArg *arg, JSArg *value)
+
+    int ejr_eval_class_function_flat(EasyJSRHandle *handle, int value_id, const char *fn_name, const JSArg *args, size_t arg_count)
     {
-        if (!arg || !value)
+        if (!valid_ptrs({handle, handle->jsvad, handle->instance}) || (arg_count > 0 && !args))
         {
-            return;
+            return -1;
         }
 
-        if (arg->type != JSARG_TYPE_C_ARRAY)
+        // Get JSValue from jsvad
+        JSValue object = handle->jsvad->get(value_id);
+        if (JS_IsUndefined(object))
         {
-            return;
+            return -1;
         }
 
-        size_t capacity = arg->value.c_array_val.capacity;
-        JSArg **items = arg->value.c_array_val.items;
-        size_t count = arg->value.c_array_val.count;
+        return eval_function_flat(handle, object, fn_name, args, arg_count);
+    }
 
-        if (!items)
+    EJRPreparedFunction *ejr_prepare_function(EasyJSRHandle *handle, const char *fn_name)
+    {
+        if (!valid_ptrs({handle, handle->instance, (void *)fn_name}))
         {
-            return;
+            return nullptr;
         }
 
-        if (count >= capacity) {
-            // Not enough space...
-            // TODO: some kind of error log OR grow the memory...
-            return;
+        ejr::PreparedFunction function = handle->instance->prepare_function(std::string(fn_name));
+        if (!function.is_function())
+        {
+            return nullptr;
         }
 
-        // Update mem
-        items[count] = value;
-        arg->value.c_array_val.count++;
+        EJRPreparedFunction *prepared = new EJRPreparedFunction{std::move(function)};
+        handle->prepared_functions.insert(prepared);
+        return prepared;
     }
 
-    JSArg *jsarg_from_jsvalue(EasyJSRHandle *handle, int value)
+    EJRPreparedFunction *ejr_prepare_class_function(EasyJSRHandle *handle, int value_id, const char *fn_name)
     {
-        if (!valid_ptrs(std::vector<void *>{handle, handle->jsvad, handle->instance}) || value < 0)
+        if (!valid_ptrs({handle, handle->jsvad, handle->instance, (void *)fn_name}))
         {
-            return jsarg_null();
+            return nullptr;
         }
 
-        JSValue jsvalue = handle->jsvad->get(value);
-
-        // Get the jsarg but also free the JSValue since we ain't finna use it later.
-        ejr::JSArg ejr_arg = handle->instance->jsvalue_to_jsarg(jsvalue, true);
+        // Get JSValue from jsvad
+        JSValue object = handle->jsvad->get(value_id);
+        if (JS_IsUndefined(object))
+        {
+            return nullptr;
+        }
 
-        return ejr_to_jsarg(ejr_arg);
-    }
+        ejr::PreparedFunction function = handle->instance->prepare_class_function(object, std::string(fn_name));
+        if (!function.is_function())
+        {
+            return nullptr;
+        }
 
-    JSArg **jsarg_make_list(size_t argc)
-    {
-        return new JSArg *[argc]
-        { ejr_to_jsarg(ejr::JSArg(std::monostate())) };
+        EJRPreparedFunction *prepared = new EJRPreparedFunction{std::move(function)};
+        handle->prepared_functions.insert(prepared);
+        return prepared;
     }
 
-    void jsarg_free_all(JSArg **args, size_t argc)
+    int ejr_call_prepared(EasyJSRHandle *handle, EJRPreparedFunction *function, const JSArg *args, size_t arg_count)
     {
-        if (args == nullptr)
+        if (!valid_ptrs({handle, handle->jsvad, handle->instance, function}) || (arg_count > 0 && !args))
         {
-            return;
+            return -1;
         }
 
-        for (size_t i = 0; i < argc; ++i)
+        JSValue value;
         {
-            if (args[i] == nullptr)
-            {
-                continue;
-            }
-            jsarg_free(args[i]);
+            FlatArgs argv(handle->instance->get_context(), args, arg_count);
+            value = function->function.call(argv.size(), argv.data());
         }
 
-        delete[] args;
+        return handle->jsvad->add_value(value);
     }
 
-    void jsarg_add_to_list(JSArg **jsarg, JSArg *njsarg, size_t i)
+    void ejr_free_prepared(EasyJSRHandle *handle, EJRPreparedFunction *function)
     {
-        if (valid_ptrs(std::vector<void *>{jsarg, njsarg}))
+        if (!handle || !function)
         {
             return;
         }
 
-        if (jsarg[i] == nullptr)
+        // Only ones still owned by the handle, freeing twice is a no-op.
+        if (handle->prepared_functions.erase(function))
         {
-            return;
+            delete function;
         }
-
-        // Add njsarg
-        jsarg[i] = njsarg;
     }
 
-    // Deleters
-    void ejr_free(EasyJSRHandle *handle)
+    int ejr_call_prepared_batch(EasyJSRHandle *handle, EJRPreparedFunction *function, const JSArg *columns, size_t column_count, JSArg *out)
     {
-        if (!handle)
+        if (!valid_ptrs({handle, handle->instance, function, out}) || (column_count > 0 && !columns))
         {
-            return;
+            return -1;
         }
 
-        // Free jsvad first
-        if (handle->jsvad)
+        // Every column must line up with the output.
+        size_t rows = SIZE_MAX;
+        if (out->type == JSARG_TYPE_C_ARRAY)
         {
-            handle->jsvad->free(handle->instance);
-            delete handle->jsvad;
+            rows = out->value.c_array_val.capacity;
         }
-
-        if (handle->instance)
+        else if (out->type == JSARG_TYPE_ARRAY_VIEW)
         {
-            delete handle->instance;
+            rows = column_length(out);
         }
-
-        delete handle;
-    }
-
-    void jsarg_free(JSArg *arg)
-    {
-        if (!arg)
+        if (rows == SIZE_MAX || rows > INT_MAX)
         {
-            return;
+            return -1;
         }
-        switch (arg->type)
+        for (size_t i = 0; i < column_count; i++)
         {
-        case JSARG_TYPE_STRING:
-            delete[] arg->value.str_val;
-            break;
-
-        case JSARG_TYPE_C_ARRAY:
-            if (arg->value.c_array_val.items)
-            {
-                for (size_t i = 0; i < arg->value.c_array_val.count; ++i)
-                {
-                    jsarg_free(arg->value.c_array_val.items[i]);
-                }
-                delete[] arg->value.c_array_val.items;
-            }
-            break;
-        case JSARG_TYPE_UINT8_ARRAY:
-            if (arg->value.u8_array_val.items)
-            {
-                delete[] arg->value.u8_array_val.items;
-            }
-            break;
-        case JSARG_TYPE_INT32_ARRAY:
-            if (arg->value.i32_array_val.items)
-            {
-                delete[] arg->value.i32_array_val.items;
-            }
-            break;
-        case JSARG_TYPE_UINT32_ARRAY:
-            if (arg->value.u32_array_val.items)
-            {
-                delete[] arg->value.u32_array_val.items;
-            }
-            break;
-        case JSARG_TYPE_INT64_ARRAY:
-            if (arg->value.i64_array_val.items)
-            {
-                delete[] arg->value.i64_array_val.items;
-            }
-            break;
-        case JSARG_TYPE_INT8_ARRAY:
-            if (arg->value.i8_array_val.items)
+            if (column_length(&columns[i]) != rows)
             {
-                delete[] arg->value.i8_array_val.items;
+                return -1;
             }
-            break;
-        case JSARG_TYPE_UINT16_ARRAY:
-            if (arg->value.u16_array_val.items)
+        }
+
+        JSContext *ctx = handle->instance->get_context();
+
+        // One argv reused for every row, on the stack for the common case.
+        const size_t inline_count = 8;
+        JSValue inline_values[inline_count];
+        std::vector<JSValue> heap_values;
+        JSValue *argv = inline_values;
+        if (column_count > inline_count)
+        {
+            heap_values.resize(column_count);
+            argv = heap_values.data();
+        }
+
+        for (size_t row = 0; row < rows; row++)
+        {
+            for (size_t i = 0; i < column_count; i++)
             {
-                delete[] arg->value.u16_array_val.items;
+                argv[i] = column_value_to_js(ctx, &columns[i], row);
             }
-            break;
-        case JSARG_TYPE_INT16_ARRAY:
-            if (arg->value.i16_array_val.items)
+
+            JSValue value = function->function.call(static_cast<int>(column_count), argv);
+
+            for (size_t i = 0; i < column_count; i++)
             {
-                delete[] arg->value.i16_array_val.items;
+                JS_FreeValue(ctx, argv[i]);
             }
-            break;
-        case JSARG_TYPE_UINT64_ARRAY:
-            if (arg->value.u64_array_val.items)
+
+            if (out->type == JSARG_TYPE_C_ARRAY)
             {
-                delete[] arg->value.u64_array_val.items;
+                // Exceptions are kept in their slot.
+                bool failed = JS_IsException(value);
+                auto &list = out->value.c_array_val;
+                if (row < list.count)
+                {
+                    jsarg_free(list.items[row]);
+                }
+                list.items[row] = ejr_to_jsarg(ejr::from_js(ctx, value));
+                list.count = std::max(list.count, row + 1);
+                if (failed)
+                {
+                    return static_cast<int>(row);
+                }
+                continue;
             }
-            break;
-        case JSARG_TYPE_FLOAT_ARRAY:
-            if (arg->value.float_array_val.items)
+
+            bool written = !JS_IsException(value) && write_view_value(ctx, out, row, value);
+            JS_FreeValue(ctx, value);
+            if (!written)
             {
-                delete[] arg->value.float_array_val.items;
+                JS_FreeValue(ctx, JS_GetException(ctx));
+                return static_cast<int>(row);
             }
-            break;
-
-        default:
-            break;
         }
 
-        delete arg;
+        return static_cast<int>(rows);
     }
 
-    // EasyJSR specific
-
-    void ejr_set_file_loader(EasyJSRHandle *handle, C_FileLoaderFn fn, void *opaque)
+    int ejr_get_property_from(EasyJSRHandle *handle, int value_id, const char *property)
     {
-        if (!valid_ptrs(std::vector<void *>{handle, handle->instance}))
+        if (!valid_ptrs({handle, handle->jsvad, handle->instance}))
         {
-            return;
+            return -1;
         }
 
-        auto wrapper = [fn, opaque](const std::string &file_path) -> std::string
+        // Convert property to string
+        std::string property_str = std::string(property);
+        // Get JSValue
+        JSValue object = handle->jsvad->get(value_id);
+        if (JS_IsUndefined(object))
         {
-            // Convert C++ -> C
-            const char *file_path_c_str = file_path.c_str();
-
-            // Call raw C
-            char *result = fn(file_path_c_str, opaque);
-
-            // Convert C -> C++
-            std::string result_str(result);
-
-            return result_str;
-        };
-
-        // Register in ejr
-        handle->instance->set_file_loader(wrapper);
+            return -1;
+        }
+        // Call
+        JSValue value = handle->instance->get_property_from(object, property_str);
+        // Return id
+        return handle->jsvad->add_value(value);
     }
 
-    int ejr_eval_script(EasyJSRHandle *handle, const char *js, const char *file_name)
+    EJRKey *ejr_intern_key(EasyJSRHandle *handle, const char *property)
     {
-        if (!valid_ptrs(std::vector<void *>{handle, handle->jsvad, handle->instance}))
+        if (!valid_ptrs({handle, handle->instance, (void *)property}))
         {
-            return -1;
+            return nullptr;
         }
 
-        // Convert to string
-        std::string js_str = std::string(js);
-        std::string file_name_string = std::string(file_name);
+        EJRKey *key = new EJRKey{handle->instance->intern_key(std::string(property))};
+        handle->keys.insert(key);
+        return key;
+    }
 
-        // Call
-        JSValue value = handle->instance->eval_script(js_str, file_name_string);
-        // Create new result
-        int result = handle->jsvad->add_value(value);
+    void ejr_free_key(EasyJSRHandle *handle, EJRKey *key)
+    {
+        if (!handle || !key)
+        {
+            return;
+        }
 
-        return result;
+        // Only ones still owned by the handle, freeing twice is a no-op.
+        if (handle->keys.erase(key))
+        {
+            delete key;
+        }
     }
 
-    int ejr_eval_module(EasyJSRHandle *handle, const char *js, const char *file_name)
+    int ejr_get_property_by_key(EasyJSRHandle *handle, int value_id, const EJRKey *key)
     {
-        if (!valid_ptrs(std::vector<void *>{handle, handle->jsvad, handle->instance}))
+        if (!valid_ptrs({handle, handle->jsvad, handle->instance, (void *)key}))
         {
             return -1;
         }
 
-        // Convert to string
-        std::string js_str = std::string(js);
-        std::string file_name_str = std::string(file_name);
+        JSValue object = handle->jsvad->get(value_id);
+        if (JS_IsUndefined(object))
+        {
+            return -1;
+        }
 
-        // Call
-        JSValue value = handle->instance->eval_module(js_str, file_name_str);
+        return handle->jsvad->add_value(handle->instance->get_property_from(object, key->key));
+    }
 
-        // Check if value is not a promise
-        if (JS_IsException(value)) {
-            return handle->jsvad->add_value(value);
+    bool ejr_set_property_by_key(EasyJSRHandle *handle, int value_id, const EJRKey *key, const JSArg *value)
+    {
+        if (!valid_ptrs({handle, handle->jsvad, handle->instance, (void *)key}))
+        {
+            return false;
         }
 
-        JSValue promise_result = handle->instance->await_promise(value);
-
-        // Free value (We might not need this actually... becuase quickjs might free the value themselves.) 
-        handle->instance->free_jsval(value);
+        JSValue object = handle->jsvad->get(value_id);
+        if (JS_IsUndefined(object))
+        {
+            return false;
+        }
 
-        return handle->jsvad->add_value(promise_result);
+        JSContext *ctx = handle->instance->get_context();
+        if (!handle->instance->set_property(object, key->key, jsarg_to_js(ctx, value)))
+        {
+            JS_FreeValue(ctx, JS_GetException(ctx));
+            return false;
+        }
+        return true;
     }
 
-    int ejr_eval_function(EasyJSRHandle *handle, const char *fn_name, JSArg **args, size_t arg_count)
+    int ejr_get_properties(EasyJSRHandle *handle, int value_id, const EJRKey *const *keys, size_t key_count, JSArg *out, EJRArena *arena)
     {
-        if (!valid_ptrs(std::vector<void *>{handle, handle->jsvad, handle->instance, args}))
+        if (!valid_ptrs({handle, handle->jsvad, handle->instance}) || (key_count > 0 && (!keys || !out)))
         {
             return -1;
         }
 
-        // Conver to string
-        std::string fn_name_str = std::string(fn_name);
-
-        // Convert args
-        ejr::JSArgs ejr_jsargs;
-        ejr_jsargs.reserve(arg_count);
-
-        for (size_t i = 0; i < arg_count; ++i)
+        JSValue object = handle->jsvad->get(value_id);
+        if (!JS_IsObject(object))
         {
-            JSArg arg = *args[i];
-            ejr_jsargs.push_back(jsarg_to_ejr(arg));
+            return -1;
         }
 
-        // Call the function
-        JSValue value = handle->instance->eval_function(fn_name_str, ejr_jsargs);
+        JSContext *ctx = handle->instance->get_context();
+        for (size_t i = 0; i < key_count; i++)
+        {
+            JSValue value = handle->instance->get_property_from(object, keys[i]->key);
+            JSArg &slot = out[i];
+            slot.in_arena = false;
 
-        // Free input args
-        jsarg_free_all(args, arg_count);
+            // Numbers own nothing, filled in place.
+            switch (JS_VALUE_GET_NORM_TAG(value))
+            {
+            case JS_TAG_INT:
+                slot.type = JSARG_TYPE_INT;
+                slot.value.int_val = JS_VALUE_GET_INT(value);
+                continue;
+            case JS_TAG_FLOAT64:
+                slot.type = JSARG_TYPE_DOUBLE;
+                slot.value.double_val = JS_VALUE_GET_FLOAT64(value);
+                continue;
+            case JS_TAG_BOOL:
+                slot.type = JSARG_TYPE_BOOL;
+                slot.value.bool_val = JS_VALUE_GET_BOOL(value);
+                continue;
+            default:
+                break;
+            }
 
-        return handle->jsvad->add_value(value);
+            // Everything else through the usual conversion, exceptions included.
+            JSArg *arg = ejr_to_jsarg_in(arena, ejr::from_js(ctx, value));
+            slot = *arg;
+            if (!arena)
+            {
+                // The contents now belong to slot.
+                delete arg;
+            }
+        }
+
+        return static_cast<int>(key_count);
     }
 
-    char *ejr_val_to_string(EasyJSRHandle *handle, int value_id)
+    int ejr_parse_json(EasyJSRHandle *handle, const char *json, size_t length)
     {
-        if (!valid_ptrs(std::vector<void *>{handle, handle->jsvad, handle->instance}))
+        if (!valid_ptrs({handle, handle->jsvad, handle->instance, json}))
         {
-            return nullptr;
+            return -1;
         }
 
-        // Get our value
-        JSValue value = handle->jsvad->get(value_id);
-        if (JS_IsUndefined(value))
+        return handle->jsvad->add_value(handle->instance->parse_json(json, length));
+    }
+
+    bool ejr_json_stringify(EasyJSRHandle *handle, int value_id, C_JSONSink sink, void *opaque)
+    {
+        if (!valid_ptrs({handle, handle->jsvad, handle->instance, (void *)sink}))
         {
-            return nullptr;
+            return false;
         }
 
-        // Get our string
-        std::string str = handle->instance->val_to_string(value, false).c_str();
-
-        // convert it to c_str
-        char *c_str = new char[str.size() + 1];
-        std::memcpy(c_str, str.c_str(), str.size() + 1);
-
-        return c_str;
+        // Captured by one pointer, so the std::function does not allocate.
+        struct
+        {
+            C_JSONSink sink;
+            void *opaque;
+            bool accepted;
+        } state = {sink, opaque, true};
+        bool stringified = handle->instance->stringify_json(handle->jsvad->get(value_id), [s = &state](const char *text, size_t length)
+                                                            { s->accepted = s->sink(text, length, s->opaque); });
+        if (!stringified)
+        {
+            JSContext *ctx = handle->instance->get_context();
+            JS_FreeValue(ctx, JS_GetException(ctx));
+        }
+        return stringified && state.accepted;
     }
 
-    int ejr_eval_class_function(EasyJSRHandle *handle, int value_id, const char *fn_name, JSArg **args, size_t arg_count)
+    EJRSerializedValue *ejr_serialize_value(EasyJSRHandle *handle, int value_id, bool allow_shared)
     {
-        if (!valid_ptrs(std::vector<void *>{handle, handle->jsvad, handle->instance, args}))
+        if (!valid_ptrs({handle, handle->jsvad, handle->instance}))
         {
-            return -1;
+            return nullptr;
         }
 
-        // Convert fn_name to string
-        std::string fn_name_str = std::string(fn_name);
-        // Get JSValue from jsvad
-        JSValue object = handle->jsvad->get(value_id);
-        if (JS_IsUndefined(object))
+        EJRSerializedValue *serialized = new EJRSerializedValue();
+        if (!handle->instance->serialize_value(handle->jsvad->get(value_id), serialized->value, allow_shared))
         {
-            return -1;
+            JSContext *ctx = handle->instance->get_context();
+            JS_FreeValue(ctx, JS_GetException(ctx));
+            delete serialized;
+            return nullptr;
         }
+        return serialized;
+    }
 
-        // Convert JSArgs to ejr::JSArg
-        ejr::JSArgs jsargs;
-        jsargs.reserve(arg_count);
-        for (size_t i = 0; i < arg_count; ++i)
+    const uint8_t *ejr_serialized_bytes(const EJRSerializedValue *value, size_t *size)
+    {
+        if (!valid_ptrs({value, size}))
         {
-            JSArg arg = *args[i];
-            jsargs.push_back(jsarg_to_ejr(arg));
+            return nullptr;
         }
-        // Call
-        JSValue value = handle->instance->eval_class_function(object, fn_name_str, jsargs);
-
-        // Free input args
-        jsarg_free_all(args, arg_count);
 
-        // Return id
-        return handle->jsvad->add_value(value);
+        *size = value->value.data().size();
+        return value->value.data().data();
     }
 
-    int ejr_get_property_from(EasyJSRHandle *handle, int value_id, const char *property)
+    int ejr_deserialize_value(EasyJSRHandle *handle, const EJRSerializedValue *value)
     {
-        if (!valid_ptrs(std::vector<void *>{handle, handle->jsvad, handle->instance}))
+        if (!valid_ptrs({handle, handle->jsvad, handle->instance, value}))
         {
             return -1;
         }
 
-        // Convert property to string
-        std::string property_str = std::string(property);
-        // Get JSValue
-        JSValue object = handle->jsvad->get(value_id);
-        if (JS_IsUndefined(object))
+        return handle->jsvad->add_value(handle->instance->deserialize_value(value->value));
+    }
+
+    int ejr_deserialize_bytes(EasyJSRHandle *handle, const uint8_t *bytes, size_t size)
+    {
+        if (!valid_ptrs({handle, handle->jsvad, handle->instance, bytes}))
         {
             return -1;
         }
-        // Call
-        JSValue value = handle->instance->get_property_from(object, property_str);
-        // Return id
-        return handle->jsvad->add_value(value);
+
+        return handle->jsvad->add_value(handle->instance->deserialize_value(bytes, size));
+    }
+
+    void ejr_free_serialized_value(EJRSerializedValue *value)
+    {
+        delete value;
     }
 
     int ejr_get_from_global(EasyJSRHandle *handle, const char *property)
     {
-        if (!valid_ptrs(std::vector<void *>{handle, handle->jsvad, handle->instance}))
+        if (!valid_ptrs({handle, handle->jsvad, handle->instance}))
         {
             return -1;
         }
@@ -966,7 +2872,7 @@ extern "C"
 
     void ejr_register_callback(EasyJSRHandle *handle, const char *fn_name, C_Callback cb, void *opaque)
     {
-        if (!valid_ptrs(std::vector<void *>{handle, handle->instance}))
+        if (!valid_ptrs({handle, handle->instance}))
         {
             return;
         }
@@ -974,42 +2880,27 @@ extern "C"
         // fn_name string
         std::string fn_name_str = std::string(fn_name);
 
-        auto wrapper = [cb, opaque](const ejr::JSArgs &args) -> ejr::JSArg
-        {
-            // Convert C++ -> C
-            std::vector<JSArg *> c_args;
-            c_args.reserve(args.size());
-            for (auto &a : args)
-            {
-                c_args.push_back(ejr_to_jsarg(a));
-            }
-
-            // Call raw C callback
-            JSArg *result = cb(c_args.data(), c_args.size(), opaque);
-
-            // Convert C -> C++
-            ejr::JSArg res = jsarg_to_ejr(*result);
-
-            // Free JSArg
-            jsarg_free(result);
+        // Register in easyjsr
+        handle->instance->register_raw_callback(fn_name_str, call_c_callback, handle->add_c_callback(cb, opaque, false));
+    }
 
-            // Free c_args
-            for (auto &arg : c_args)
-            {
-                jsarg_free(arg);
-            }
+    void ejr_register_callback_borrowed(EasyJSRHandle *handle, const char *fn_name, C_Callback cb, void *opaque)
+    {
+        if (!valid_ptrs({handle, handle->instance}))
+        {
+            return;
+        }
 
-            // This goes to C++
-            return res;
-        };
+        // fn_name string
+        std::string fn_name_str = std::string(fn_name);
 
-        // Register in easyjsr
-        handle->instance->register_callback(fn_name_str, wrapper);
+        // Register in easyjsr, typed arrays are passed as views.
+        handle->instance->register_raw_callback(fn_name_str, call_c_callback, handle->add_c_callback(cb, opaque, true));
     }
 
     void ejr_register_module(EasyJSRHandle *handle, const char *module_name, JSMethod *methods, size_t method_count)
     {
-        if (!valid_ptrs(std::vector<void *>{handle, handle->instance, methods}))
+        if (!valid_ptrs({handle, handle->instance, methods}))
         {
             return;
         }
@@ -1025,38 +2916,11 @@ extern "C"
         for (size_t i = 0; i < method_count; ++i)
         {
             JSMethod method = methods[i];
-            C_Callback cb = method.cb;
-            void *opaque = method.opaque;
-            auto wrapper = [cb, opaque](const ejr::JSArgs &args) -> ejr::JSArg
-            {
-                // Convert C++ -> C
-                std::vector<JSArg *> c_args;
-                c_args.reserve(args.size());
-                for (auto &a : args)
-                {
-                    c_args.push_back(ejr_to_jsarg(a));
-                }
-
-                // Call raw C callback
-                JSArg *result = cb(c_args.data(), c_args.size(), opaque);
-
-                // Convert C -> C++
-                ejr::JSArg res = jsarg_to_ejr(*result);
-
-                jsarg_free(result);
-                // Free c_args
-                for (auto &arg : c_args)
-                {
-                    jsarg_free(arg);
-                }
-
-                // This goes to c++
-                return res;
-            };
-
+            CCallback *callback = handle->add_c_callback(method.cb, method.opaque, false);
             ejr_methods.push_back(ejr::JSMethod{
                 std::string(method.name),
-                wrapper});
+                call_c_callback,
+                callback});
         }
 
         // Register module
@@ -1075,7 +2939,7 @@ extern "C"
 
     void ejr_free_jsvalue(EasyJSRHandle *handle, int value_id)
     {
-        if (!valid_ptrs(std::vector<void *>{handle, handle->jsvad, handle->instance}))
+        if (!valid_ptrs({handle, handle->jsvad, handle->instance}))
         {
             return;
         }
@@ -1083,6 +2947,124 @@ extern "C"
         handle->jsvad->free_value(handle->instance, value_id);
     }
 
+    void ejr_scope_begin(EasyJSRHandle *handle)
+    {
+        if (!valid_ptrs({handle, handle->jsvad}))
+        {
+            return;
+        }
+
+        handle->jsvad->begin_scope();
+    }
+
+    void ejr_scope_end(EasyJSRHandle *handle)
+    {
+        if (!valid_ptrs({handle, handle->jsvad, handle->instance}))
+        {
+            return;
+        }
+
+        handle->jsvad->end_scope(handle->instance);
+    }
+
+    int ejr_scope_escape(EasyJSRHandle *handle, int value_id)
+    {
+        if (!valid_ptrs({handle, handle->jsvad}))
+        {
+            return -1;
+        }
+
+        return handle->jsvad->escape(value_id) ? value_id : -1;
+    }
+
+    EJRClass *ejr_register_class(EasyJSRHandle *handle, const char *class_name, C_Constructor constructor, C_Finalizer finalizer, void *opaque)
+    {
+        if (!valid_ptrs({handle, handle->instance, (void *)class_name}))
+        {
+            return nullptr;
+        }
+
+        // Each C class name gets its own class id, so it has its own prototype.
+        std::string class_name_str = std::string(class_name);
+        JSClassID class_id = c_class_id(class_name_str);
+
+        auto cls = std::unique_ptr<EJRClass>(new EJRClass{handle, class_id, constructor, finalizer, opaque});
+        bool defined = constructor
+            ? handle->instance->define_class(class_id, class_name_str, &c_class_finalize,
+                  std::make_unique<CConstructorSlot>(cls.get()), &CConstructorSlot::call, 0)
+            : handle->instance->define_class(class_id, class_name_str, &c_class_finalize, nullptr, nullptr, 0);
+        if (!defined)
+        {
+            return nullptr;
+        }
+
+        handle->classes.push_back(std::move(cls));
+        return handle->classes.back().get();
+    }
+
+    void ejr_class_add_method(EasyJSRHandle *handle, EJRClass *cls, const char *name, C_Method method, void *opaque)
+    {
+        if (!valid_ptrs({handle, handle->instance, cls, (void *)name, (void *)method}))
+        {
+            return;
+        }
+
+        handle->instance->define_class_method(cls->class_id, std::string(name),
+            std::make_unique<CMethodSlot>(cls, method, opaque), &CMethodSlot::call, 0);
+    }
+
+    void ejr_class_add_property(EasyJSRHandle *handle, EJRClass *cls, const char *name, C_Method getter, C_Method setter, void *opaque)
+    {
+        if (!valid_ptrs({handle, handle->instance, cls, (void *)name, (void *)getter}))
+        {
+            return;
+        }
+
+        if (setter)
+        {
+            handle->instance->define_class_property(cls->class_id, std::string(name),
+                std::make_unique<CMethodSlot>(cls, getter, opaque), &CMethodSlot::call,
+                std::make_unique<CMethodSlot>(cls, setter, opaque), &CMethodSlot::call);
+        }
+        else
+        {
+            handle->instance->define_class_property(cls->class_id, std::string(name),
+                std::make_unique<CMethodSlot>(cls, getter, opaque), &CMethodSlot::call, nullptr, nullptr);
+        }
+    }
+
+    int ejr_new_object(EasyJSRHandle *handle, EJRClass *cls, void *native)
+    {
+        if (!valid_ptrs({handle, handle->jsvad, handle->instance, cls}))
+        {
+            return -1;
+        }
+
+        JSValue value = new_c_object(handle->instance->get_context(), cls, js_undefined(), native);
+        return handle->jsvad->add_value(value);
+    }
+
+    void *ejr_get_object(EasyJSRHandle *handle, EJRClass *cls, int value_id)
+    {
+        if (!valid_ptrs({handle, handle->jsvad, cls}))
+        {
+            return nullptr;
+        }
+
+        CObject *object = static_cast<CObject *>(JS_GetOpaque(handle->jsvad->get(value_id), cls->class_id));
+        return object ? object->native : nullptr;
+    }
+
+    bool ejr_is_valid_jsvalue(EasyJSRHandle *handle, int value_id)
+    {
+        if (!valid_ptrs({handle, handle->jsvad}))
+        {
+            return false;
+        }
+
+        return handle->jsvad->contains(value_id);
+    }
+
     int ejr_await_promise(EasyJSRHandle* handle, int value_id) {
         if (handle == nullptr) {
             return -1;
@@ -1229,6 +3211,24 @@ extern "C"
                 );
             }
             break;
+        case JSARG_TYPE_ARRAY_VIEW:
+            str = array_view_to_string(arg);
+            break;
+        case JSARG_TYPE_OBJECT:
+            str += "{";
+            for (size_t i = 0; i < arg->value.object_val.count; ++i)
+            {
+                if (i > 0) {
+                    str += ", ";
+                }
+                char *value = jsarg_to_string(arg->value.object_val.values[i]);
+                str += arg->value.object_val.keys[i];
+                str += ": ";
+                str += value ? value : "";
+                ejr_free_string(value);
+            }
+            str += "}";
+            break;
 
         default:
             break;
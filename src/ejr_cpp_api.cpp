@@ -1,6 +1,10 @@
 #include <include/ejr.hpp>
 #include <lib/quickjs_cpp_utils.hpp>
 #include <utility>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
 #include "utils.hpp"
 
 using namespace ejr;
@@ -17,6 +21,13 @@ static JSModuleDef *js_module_loader(JSContext *ctx, const char *module_name, vo
     {
         return it->second;
     }
+    // Then the mounted bundles
+    JSModuleDef *bundled = ejsr->load_bundled_module(module_name);
+    if (bundled || JS_HasException(ctx))
+    {
+        // Bundled but unreadable fails the import, it does not fall back to the file.
+        return bundled;
+    }
     // TODO: .json support
 
     // Load the JS file
@@ -26,6 +37,20 @@ static JSModuleDef *js_module_loader(JSContext *ctx, const char *module_name, vo
         return nullptr;
     }
 
+    // Another runtime may have compiled it already. Stripped compiles (see compile_bytecode) are not shared.
+    ModuleCache &cache = ModuleCache::shared();
+    bool use_cache = ejsr->module_cache_enabled() && JS_GetStripInfo(JS_GetRuntime(ctx)) == 0;
+    uint64_t key = 0;
+    if (use_cache)
+    {
+        key = ModuleCache::key_of(module_name, contents.data(), contents.size());
+        JSModuleDef *cached = cache.load(ctx, key, module_name);
+        if (cached)
+        {
+            return cached;
+        }
+    }
+
     // Compile the module
     JSValue func_val;
     func_val = JS_Eval(ctx, contents.c_str(), contents.size(), module_name, JS_EVAL_TYPE_MODULE | JS_EVAL_FLAG_COMPILE_ONLY);
@@ -37,6 +62,11 @@ static JSModuleDef *js_module_loader(JSContext *ctx, const char *module_name, vo
         return nullptr;
     }
 
+    if (use_cache)
+    {
+        cache.store(ctx, key, module_name, func_val);
+    }
+
     JSModuleDef *m = static_cast<JSModuleDef *>(JS_VALUE_GET_PTR(func_val));
     JS_FreeValue(ctx, func_val);
 
@@ -50,8 +80,6 @@ JSValue ejr::to_js(JSContext *ctx, const JSArg &arg)
             using T = std::decay_t<decltype(value)>;
             if constexpr (std::is_same_v<T, int>) {
                 return JS_NewInt32(ctx, value);
-            } else if constexpr (std::is_same_v<T, long>) {
-                return JS_NewInt64(ctx, static_cast<int64_t>(value));
             } else if constexpr (std::is_same_v<T, float>) {
                 return JS_NewFloat64(ctx, static_cast<double>(value));
             } else if constexpr (std::is_same_v<T, double>) {
@@ -69,12 +97,7 @@ JSValue ejr::to_js(JSContext *ctx, const JSArg &arg)
             } else if constexpr (std::is_same_v<T, JSArgUndefined>) {
                 return js_undefined();
             } else if constexpr (std::is_same_v<T, std::shared_ptr<std::vector<JSArg>>>) {
-                JSValue arr = JS_NewArray(ctx);
-                for (size_t i = 0; i < value->size(); i++) {
-                    JSValue elem = to_js(ctx, (*value)[i]);
-                    JS_SetPropertyUint32(ctx, arr, i, elem);
-                }
-                return arr;
+                return to_js_array(ctx, *value);
             } else if constexpr (std::is_same_v<T, JSArgTypedArray<uint8_t>>) {
                 return create_js_array_typed(ctx, value);
             } else if constexpr (std::is_same_v<T, JSArgTypedArray<int32_t>>) {
@@ -97,265 +120,1042 @@ JSValue ejr::to_js(JSContext *ctx, const JSArg &arg)
                 JSValue error_msg = JS_NewString(ctx, value.msg.c_str());
                 JSValue error_name = JS_NewString(ctx, value.name.c_str());
                 JSValue error = JS_NewError(ctx);
-                JS_SetPropertyStr(ctx, error, "message", error_msg);
-                JS_SetPropertyStr(ctx, error, "name", error_name);
+                JS_SetProperty(ctx, error, common_atoms(ctx).message, error_msg);
+                JS_SetProperty(ctx, error, common_atoms(ctx).name, error_name);
 
                 return error;
+            } else if constexpr (std::is_same_v<T, JSArgTypedArrayView>) {
+                // A view can not be handed back, the ArrayBuffer is not ours.
+                JSValue buffer = JS_NewArrayBufferCopy(ctx, value.data, value.length * typed_array_element_size(value.type));
+                return new_typed_array_from_buffer(ctx, buffer, value.type);
+            } else if constexpr (std::is_same_v<T, std::shared_ptr<JSArgObject>>) {
+                const JSArgObject &object = *value;
+                return record_to_js(
+                    ctx, object.size(),
+                    [&](size_t i) { return std::string_view(object.keys[i]); },
+                    [&](size_t i) { return to_js(ctx, object.values[i]); });
             }
             else { 
                 return js_undefined();
             } }, arg.value);
 }
 
-JSArg ejr::from_js(JSContext *ctx, JSValue value, bool force_free)
+JSValue ejr::to_js(JSContext *ctx, JSArg &&arg)
+{
+    return std::visit([&](auto &&value) -> JSValue
+                      {
+            using T = std::decay_t<decltype(value)>;
+            if constexpr (is_typed_array_v<T>) {
+                // Hand the storage over to the ArrayBuffer
+                return create_js_array_typed(ctx, std::move(value));
+            } else {
+                return to_js(ctx, static_cast<const JSArg &>(arg));
+            } }, arg.value);
+}
+
+/// @brief Convert a JS string into a JSArg.
+static JSArg string_from_js(JSContext *ctx, JSValueConst value)
+{
+    size_t len;
+    const char *val = JS_ToCStringLen(ctx, &len, value);
+    if (val == nullptr)
+    {
+        return std::string("[unsupported]");
+    }
+
+    std::string val_string(val, len);
+    JS_FreeCString(ctx, val);
+
+    return val_string;
+}
+
+/// @brief Convert a pending exception into a JSArgException.
+static JSArg exception_from_js(JSContext *ctx)
+{
+    // Get exception
+    JSValue exception = JS_GetException(ctx);
+
+    // Convert to String
+    JSValue exception_js_str = JS_ToString(ctx, exception);
+
+    // Make the error and name the same
+    const char *exeception_cstr = JS_ToCString(ctx, exception_js_str);
+    string exception_str = exeception_cstr == nullptr ? "Exception" : std::string(exeception_cstr);
+
+    if (exeception_cstr)
+    {
+        JS_FreeCString(ctx, exeception_cstr);
+    }
+    JS_FreeValue(ctx, exception);
+    JS_FreeValue(ctx, exception_js_str);
+
+    return JSArgException(exception_str, exception_str);
+}
+
+/// @brief Convert a JS Error object into a JSArgException.
+static JSArg error_from_js(JSContext *ctx, JSValueConst value)
 {
-    if (JS_IsString(value))
+    const CommonAtoms &atoms = common_atoms(ctx);
+    JSValue message = JS_GetProperty(ctx, value, atoms.message);
+    JSValue name = JS_GetProperty(ctx, value, atoms.name);
+
+    const char *message_cstr = nullptr;
+    const char *name_cstr = nullptr;
+
+    if (!JS_IsUndefined(message))
+    {
+        message_cstr = JS_ToCString(ctx, message);
+    }
+    if (!JS_IsUndefined(name))
+    {
+        name_cstr = JS_ToCString(ctx, name);
+    }
+
+    std::string message_str = message_cstr == nullptr ? "Exception" : std::string(message_cstr);
+    std::string name_str = name_cstr == nullptr ? "Exception" : std::string(name_cstr);
+
+    // Free message, name, message_cstr, name_cstr
+    JS_FreeValue(ctx, message);
+    JS_FreeValue(ctx, name);
+
+    if (message_cstr)
+    {
+        JS_FreeCString(ctx, message_cstr);
+    }
+    if (name_cstr)
+    {
+        JS_FreeCString(ctx, name_cstr);
+    }
+
+    return JSArgException(message_str, name_str);
+}
+
+/// @brief Convert a JS TypedArray into a JSArgTypedArray (or a JSArgTypedArrayView if borrowed).
+static JSArg typed_array_from_js(JSContext *ctx, JSValueConst value, int array_type, bool borrow_typed_arrays)
+{
+    size_t byte_offset, byte_length, bytes_per_element;
+    JSValue typed_array_buffer = JS_GetTypedArrayBuffer(ctx, value, &byte_offset, &byte_length, &bytes_per_element);
+    if (JS_IsException(typed_array_buffer))
+    {
+        // Detached, clear the exception.
+        JS_FreeValue(ctx, JS_GetException(ctx));
+        return std::string("[unsupported]");
+    }
+
+    size_t psize;
+    uint8_t *buffer_data = JS_GetArrayBuffer(ctx, &psize, typed_array_buffer);
+    // value still holds a reference to the buffer, so buffer_data stays valid.
+    JS_FreeValue(ctx, typed_array_buffer);
+
+    if (buffer_data == nullptr)
     {
-        const char *val = JS_ToCString(ctx, value);
-        std::string val_string(val);
-        JS_FreeCString(ctx, val);
-        if (force_free)
+        return std::string("[unsupported]");
+    }
+
+    uint8_t *typed_array_data = buffer_data + byte_offset;
+    size_t element_count = byte_length / bytes_per_element;
+
+    if (borrow_typed_arrays)
+    {
+        // value keeps the ArrayBuffer alive, so hand out a view instead of a copy.
+        return JSArgTypedArrayView(typed_array_data, element_count, static_cast<JSTypedArrayEnum>(array_type));
+    }
+
+    switch (array_type)
+    {
+    case JS_TYPED_ARRAY_UINT8C:
+    case JS_TYPED_ARRAY_UINT8:
+        return JSArgTypedArray<uint8_t>(typed_array_data, element_count);
+    case JS_TYPED_ARRAY_INT8:
+        return JSArgTypedArray<int8_t>(typed_array_data, element_count);
+    case JS_TYPED_ARRAY_INT16:
+        return JSArgTypedArray<int16_t>(typed_array_data, element_count);
+    case JS_TYPED_ARRAY_UINT16:
+        return JSArgTypedArray<uint16_t>(typed_array_data, element_count);
+    case JS_TYPED_ARRAY_INT32:
+        return JSArgTypedArray<int32_t>(typed_array_data, element_count);
+    case JS_TYPED_ARRAY_UINT32:
+        return JSArgTypedArray<uint32_t>(typed_array_data, element_count);
+    case JS_TYPED_ARRAY_BIG_INT64:
+        return JSArgTypedArray<int64_t>(typed_array_data, element_count);
+    case JS_TYPED_ARRAY_BIG_UINT64:
+        return JSArgTypedArray<uint64_t>(typed_array_data, element_count);
+    case JS_TYPED_ARRAY_FLOAT32:
+        return JSArgTypedArray<float>(typed_array_data, element_count);
+    default:
+        // Float16Array and Float64Array have no JSArg yet.
+        return std::string("[unsupported]");
+    }
+}
+
+/// @brief Convert a JS object into a JSArg.
+static JSArg object_from_js(JSContext *ctx, JSValueConst value, bool borrow_typed_arrays)
+{
+    int array_type = JS_GetTypedArrayType(value);
+    if (array_type >= 0)
+    {
+        return typed_array_from_js(ctx, value, array_type, borrow_typed_arrays);
+    }
+
+    std::vector<JSArg> vec;
+    if (from_js_array(ctx, value, vec))
+    {
+        return JSArg(std::move(vec));
+    }
+
+    if (JS_IsError(ctx, value))
+    {
+        return error_from_js(ctx, value);
+    }
+
+    return std::string("[unsupported]");
+}
+
+/// @brief Build a JS Array from a std::vector, converting each element with convert.
+template <typename T, typename Convert>
+static JSValue array_to_js(JSContext *ctx, const std::vector<T> &values, Convert convert)
+{
+    // Preallocate a fast array and write the elements straight into its storage.
+    JSValue *js_values;
+    JSValue arr = JS_NewFastArray(ctx, static_cast<uint32_t>(values.size()), &js_values);
+    if (JS_IsException(arr))
+    {
+        return arr;
+    }
+
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        // The array is not reachable from JS yet, so its storage can't move.
+        js_values[i] = convert(values[i]);
+    }
+
+    return arr;
+}
+
+/// @brief Read a JS Array into a std::vector, converting each element with convert.
+///
+/// Fast arrays are read straight from their storage, anything else goes through property lookups.
+template <typename T, typename Convert>
+static bool array_from_js(JSContext *ctx, JSValueConst value, std::vector<T> &out, Convert convert)
+{
+    JSValue *arrp;
+    uint32_t len;
+    uint32_t i = 0;
+
+    bool fast = JS_GetFastArray(ctx, value, &arrp, &len);
+    if (!fast && !JS_IsArray(ctx, value))
+    {
+        return false;
+    }
+
+    if (fast)
+    {
+        out.reserve(out.size() + len);
+    }
+
+    while (fast && i < len)
+    {
+        JSValue elem = JS_DupValue(ctx, arrp[i]);
+        bool may_run_js = JS_VALUE_GET_TAG(elem) == JS_TAG_OBJECT;
+        bool ok = convert(elem, out);
+        JS_FreeValue(ctx, elem);
+        if (!ok)
         {
-            JS_FreeValue(ctx, value);
+            return false;
+        }
+        i++;
+
+        if (may_run_js)
+        {
+            // Converting a object can run JS, which may change the array.
+            fast = JS_GetFastArray(ctx, value, &arrp, &len);
         }
-        return val_string;
     }
-    else if (JS_IsBool(value))
+
+    if (fast)
     {
-        int b = JS_ToBool(ctx, value);
-        if (force_free)
+        return true;
+    }
+
+    // Ger length property
+    JSValue len_val = JS_GetProperty(ctx, value, common_atoms(ctx).length);
+    JS_ToUint32(ctx, &len, len_val);
+    JS_FreeValue(ctx, len_val);
+
+    for (; i < len; i++)
+    {
+        JSValue elem = JS_GetPropertyUint32(ctx, value, i);
+        bool ok = convert(elem, out);
+        JS_FreeValue(ctx, elem);
+        if (!ok)
         {
-            JS_FreeValue(ctx, value);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+JSValue ejr::to_js_array(JSContext *ctx, const std::vector<JSArg> &values)
+{
+    return array_to_js(ctx, values, [ctx](const JSArg &value)
+                       { return to_js(ctx, value); });
+}
+
+JSValue ejr::to_js_array(JSContext *ctx, const std::vector<int> &values)
+{
+    return array_to_js(ctx, values, [ctx](int value)
+                       { return JS_NewInt32(ctx, value); });
+}
+
+JSValue ejr::to_js_array(JSContext *ctx, const std::vector<double> &values)
+{
+    return array_to_js(ctx, values, [ctx](double value)
+                       { return JS_NewFloat64(ctx, value); });
+}
+
+JSValue ejr::to_js_array(JSContext *ctx, const std::vector<std::string> &values)
+{
+    return array_to_js(ctx, values, [ctx](const std::string &value)
+                       { return JS_NewStringLen(ctx, value.data(), value.size()); });
+}
+
+bool ejr::from_js_array(JSContext *ctx, JSValueConst value, std::vector<JSArg> &out)
+{
+    return array_from_js(ctx, value, out, [ctx](JSValueConst elem, std::vector<JSArg> &vec)
+                         {
+        vec.push_back(from_js(ctx, elem, false));
+        return true; });
+}
+
+bool ejr::from_js_array(JSContext *ctx, JSValueConst value, std::vector<int> &out)
+{
+    return array_from_js(ctx, value, out, [](JSValueConst elem, std::vector<int> &vec)
+                         {
+        if (JS_VALUE_GET_TAG(elem) != JS_TAG_INT) {
+            return false;
+        }
+        vec.push_back(JS_VALUE_GET_INT(elem));
+        return true; });
+}
+
+bool ejr::from_js_array(JSContext *ctx, JSValueConst value, std::vector<double> &out)
+{
+    return array_from_js(ctx, value, out, [](JSValueConst elem, std::vector<double> &vec)
+                         {
+        int tag = JS_VALUE_GET_NORM_TAG(elem);
+        if (tag == JS_TAG_INT) {
+            vec.push_back(JS_VALUE_GET_INT(elem));
+        } else if (tag == JS_TAG_FLOAT64) {
+            vec.push_back(JS_VALUE_GET_FLOAT64(elem));
+        } else {
+            return false;
+        }
+        return true; });
+}
+
+bool ejr::from_js_array(JSContext *ctx, JSValueConst value, std::vector<std::string> &out)
+{
+    return array_from_js(ctx, value, out, [ctx](JSValueConst elem, std::vector<std::string> &vec)
+                         {
+        if (!JS_IsString(elem)) {
+            return false;
         }
-        return static_cast<bool>(b);
+        size_t len;
+        const char *str = JS_ToCStringLen(ctx, &len, elem);
+        if (str == nullptr) {
+            return false;
+        }
+        vec.emplace_back(str, len);
+        JS_FreeCString(ctx, str);
+        return true; });
+}
+
+JSArg ejr::from_js(JSContext *ctx, JSValue value, bool force_free, bool borrow_typed_arrays)
+{
+    // A view can only be handed out if value outlives it.
+    borrow_typed_arrays = borrow_typed_arrays && !force_free;
+
+    // Values without a reference count need no freeing.
+    switch (JS_VALUE_GET_NORM_TAG(value))
+    {
+    case JS_TAG_INT:
+        return static_cast<int>(JS_VALUE_GET_INT(value));
+    case JS_TAG_FLOAT64:
+        return JS_VALUE_GET_FLOAT64(value);
+    case JS_TAG_BOOL:
+        return static_cast<bool>(JS_VALUE_GET_BOOL(value));
+    case JS_TAG_NULL:
+        return std::string("null"); // or maybe return false/0 depending on your design
+    case JS_TAG_UNDEFINED:
+        return std::string("undefined");
+    case JS_TAG_EXCEPTION:
+        return exception_from_js(ctx);
+    default:
+        break;
     }
-    else if (JS_IsNumber(value))
+
+    JSArg result = std::monostate();
+
+    switch (JS_VALUE_GET_NORM_TAG(value))
+    {
+    case JS_TAG_STRING:
+    case JS_TAG_STRING_ROPE:
+        result = string_from_js(ctx, value);
+        break;
+    case JS_TAG_SHORT_BIG_INT:
+    case JS_TAG_BIG_INT:
     {
-        int32_t i32;
-        int64_t i64;
-        uint32_t u32;
-        double d;
-        if (JS_ToInt32(ctx, &i32, value) == 0)
+        int64_t i64 = 0;
+        JS_ToBigInt64(ctx, &i64, value);
+        result = i64;
+        break;
+    }
+    case JS_TAG_OBJECT:
+        result = object_from_js(ctx, value, borrow_typed_arrays);
+        break;
+    default:
+        // Fallback: return [unsupported] as string
+        result = std::string("[unsupported]");
+        break;
+    }
+
+    if (force_free)
+    {
+        JS_FreeValue(ctx, value);
+    }
+
+    return result;
+}
+
+string ejr::jsarg_to_str(const JSArg &arg)
+{
+    return jsarg_as<std::string>(arg);
+}
+
+void JSCompactArgs::clear()
+{
+    this->args.clear();
+    this->elements.clear();
+    this->buffer.clear();
+}
+
+JSCompactArg JSCompactArgs::make_string(std::string_view str)
+{
+    if (str.size() <= JSCompactArg::inline_capacity)
+    {
+        JSCompactArg arg(JSCompactType::InlineString);
+        arg.bytes[1] = static_cast<unsigned char>(str.size());
+        std::memcpy(arg.bytes + 2, str.data(), str.size());
+        return arg;
+    }
+
+    // Out of line, address by offset since the buffer can grow.
+    JSCompactArg arg(JSCompactType::String);
+    arg.store<uint32_t>(4, static_cast<uint32_t>(str.size()));
+    arg.store<uint64_t>(8, this->buffer.size());
+    this->buffer.insert(this->buffer.end(), str.begin(), str.end());
+    return arg;
+}
+
+JSCompactArg JSCompactArgs::make_js(JSContext *ctx, JSValueConst value)
+{
+    switch (JS_VALUE_GET_NORM_TAG(value))
+    {
+    case JS_TAG_INT:
+        return JSCompactArg::make_int(JS_VALUE_GET_INT(value));
+    case JS_TAG_FLOAT64:
+        return JSCompactArg::make_double(JS_VALUE_GET_FLOAT64(value));
+    case JS_TAG_BOOL:
+        return JSCompactArg::make_bool(JS_VALUE_GET_BOOL(value));
+    case JS_TAG_NULL:
+        return JSCompactArg::make_null();
+    case JS_TAG_UNDEFINED:
+        return JSCompactArg();
+    case JS_TAG_SHORT_BIG_INT:
+    case JS_TAG_BIG_INT:
+    {
+        int64_t i64 = 0;
+        JS_ToBigInt64(ctx, &i64, value);
+        return JSCompactArg::make_int64(i64);
+    }
+    case JS_TAG_STRING:
+    case JS_TAG_STRING_ROPE:
+    {
+        size_t len;
+        const char *str = JS_ToCStringLen(ctx, &len, value);
+        if (str == nullptr)
         {
-            if (force_free)
-            {
-                JS_FreeValue(ctx, value);
-            }
-            return static_cast<int>(i32);
+            break;
         }
-        else if (JS_ToInt64(ctx, &i64, value) == 0)
+        JSCompactArg arg = this->make_string(std::string_view(str, len));
+        JS_FreeCString(ctx, str);
+        return arg;
+    }
+    case JS_TAG_EXCEPTION:
+        return this->make_exception(std::get<JSArgException>(exception_from_js(ctx).value));
+    case JS_TAG_OBJECT:
+    {
+        int array_type = JS_GetTypedArrayType(value);
+        if (array_type >= 0)
         {
-            if (force_free)
+            // Always borrowed, the args only live as long as the call.
+            JSArg view = typed_array_from_js(ctx, value, array_type, true);
+            if (!std::holds_alternative<JSArgTypedArrayView>(view.value))
             {
-                JS_FreeValue(ctx, value);
+                break;
             }
-            return i64;
+            const JSArgTypedArrayView &v = std::get<JSArgTypedArrayView>(view.value);
+            JSCompactArg arg(JSCompactType::TypedArray);
+            arg.bytes[1] = static_cast<unsigned char>(v.type);
+            arg.store<uint32_t>(4, static_cast<uint32_t>(v.length));
+            arg.store<uint64_t>(8, reinterpret_cast<uintptr_t>(v.data));
+            return arg;
         }
-        else if (JS_ToFloat64(ctx, &d, value) == 0)
+
+        std::vector<JSCompactArg> items;
+        if (array_from_js(ctx, value, items, [ctx, this](JSValueConst elem, std::vector<JSCompactArg> &vec)
+                          {
+            vec.push_back(this->make_js(ctx, elem));
+            return true; }))
         {
-            if (force_free)
-            {
-                JS_FreeValue(ctx, value);
-            }
-            return d;
-        } else if (JS_ToUint32(ctx, &u32, value) == 0) {
-            if (force_free) {
-                JS_FreeValue(ctx, value);
-            }
-            return u32;
+            return this->make_slice(JSCompactType::Array, items);
         }
-        if (force_free)
+
+        if (JS_IsError(ctx, value))
         {
-            JS_FreeValue(ctx, value);
+            return this->make_exception(std::get<JSArgException>(error_from_js(ctx, value).value));
         }
-        return 0; // fallback
+        break;
+    }
+    default:
+        break;
     }
-    else if (JS_IsArray(ctx, value))
-    {    
-        // Ger length property
-        uint32_t len;
-        JSValue len_val = JS_GetPropertyStr(ctx, value, "length");
-        JS_ToUint32(ctx, &len, len_val);
-        JS_FreeValue(ctx, len_val);
 
+    // Fallback: return [unsupported] as string
+    return this->make_string("[unsupported]");
+}
+
+JSCompactArg JSCompactArgs::make_slice(JSCompactType type, const std::vector<JSCompactArg> &items)
+{
+    // Nested arrays were appended while converting items, so this slice goes after them.
+    JSCompactArg arg(type);
+    arg.store<uint32_t>(4, static_cast<uint32_t>(items.size()));
+    arg.store<uint64_t>(8, this->elements.size());
+    this->elements.insert(this->elements.end(), items.begin(), items.end());
+    return arg;
+}
+
+JSCompactArg JSCompactArgs::make_exception(const JSArgException &exception)
+{
+    std::vector<JSCompactArg> items{this->make_string(exception.msg), this->make_string(exception.name)};
+    return this->make_slice(JSCompactType::Exception, items);
+}
+
+std::string_view JSCompactArgs::string_of(const JSCompactArg &arg) const
+{
+    if (arg.type() == JSCompactType::InlineString)
+    {
+        return std::string_view(reinterpret_cast<const char *>(arg.bytes + 2), arg.bytes[1]);
+    }
+    if (arg.type() == JSCompactType::String)
+    {
+        return std::string_view(this->buffer.data() + arg.load<uint64_t>(8), arg.load<uint32_t>(4));
+    }
+
+    return std::string_view();
+}
+
+const JSCompactArg *JSCompactArgs::elements_of(const JSCompactArg &arg) const
+{
+    if (arg.type() != JSCompactType::Array && arg.type() != JSCompactType::Exception)
+    {
+        return nullptr;
+    }
+
+    return this->elements.data() + arg.load<uint64_t>(8);
+}
+
+JSArgTypedArrayView JSCompactArgs::view_of(const JSCompactArg &arg) const
+{
+    if (arg.type() != JSCompactType::TypedArray)
+    {
+        return JSArgTypedArrayView(nullptr, 0, JS_TYPED_ARRAY_UINT8);
+    }
+
+    uint8_t *data = reinterpret_cast<uint8_t *>(static_cast<uintptr_t>(arg.load<uint64_t>(8)));
+    return JSArgTypedArrayView(data, arg.load<uint32_t>(4), static_cast<JSTypedArrayEnum>(arg.bytes[1]));
+}
+
+JSArg JSCompactArgs::to_jsarg(const JSCompactArg &arg) const
+{
+    switch (arg.type())
+    {
+    case JSCompactType::Null:
+        return JSArg(nullptr);
+    case JSCompactType::Bool:
+        return arg.as_bool();
+    case JSCompactType::Int:
+        return arg.as_int();
+    case JSCompactType::Int64:
+        return arg.as_int64();
+    case JSCompactType::Double:
+        return arg.as_double();
+    case JSCompactType::InlineString:
+    case JSCompactType::String:
+        return std::string(this->string_of(arg));
+    case JSCompactType::Array:
+    {
+        const JSCompactArg *items = this->elements_of(arg);
         std::vector<JSArg> vec;
-        vec.reserve(len);
+        vec.reserve(arg.length());
+        for (size_t i = 0; i < arg.length(); i++)
+        {
+            vec.push_back(this->to_jsarg(items[i]));
+        }
+        return JSArg(std::move(vec));
+    }
+    case JSCompactType::TypedArray:
+        return this->view_of(arg);
+    case JSCompactType::Exception:
+    {
+        const JSCompactArg *items = this->elements_of(arg);
+        return JSArgException(std::string(this->string_of(items[0])), std::string(this->string_of(items[1])));
+    }
+    default:
+        return JSArg(std::monostate());
+    }
+}
+
+EJRValue::EJRValue(JSContext *ctx, JSValue val)
+{
+    this->ctx = ctx;
+    this->val = val;
+}
+
+EJRValue::~EJRValue()
+{
+    // if (JS_IsLiveObject(this->runtime, this->val)) {
+    JS_FreeValue(this->ctx, this->val);
+    // }
+}
+
+JSValue &EJRValue::get_ref()
+{
+    return this->val;
+}
+
+PreparedFunction::PreparedFunction(JSContext *ctx, JSValue function, JSValue this_obj)
+    : ctx(ctx), function(function), this_obj(this_obj) {}
+
+PreparedFunction::~PreparedFunction()
+{
+    if (this->ctx)
+    {
+        JS_FreeValue(this->ctx, this->function);
+        JS_FreeValue(this->ctx, this->this_obj);
+    }
+}
 
-        for (uint32_t i = 0; i < len; i++)
+PreparedFunction::PreparedFunction(PreparedFunction &&other) noexcept
+    : ctx(other.ctx), function(other.function), this_obj(other.this_obj), argv(std::move(other.argv))
+{
+    other.ctx = nullptr;
+}
+
+PreparedFunction &PreparedFunction::operator=(PreparedFunction &&other) noexcept
+{
+    if (this != &other)
+    {
+        if (this->ctx)
         {
-            JSValue elem = JS_GetPropertyUint32(ctx, value, i);
-            JSArg arg = from_js(ctx, elem);
-            vec.push_back(arg);
+            JS_FreeValue(this->ctx, this->function);
+            JS_FreeValue(this->ctx, this->this_obj);
         }
+        this->ctx = other.ctx;
+        this->function = other.function;
+        this->this_obj = other.this_obj;
+        this->argv = std::move(other.argv);
+        other.ctx = nullptr;
+    }
+    return *this;
+}
+
+PropertyKey::PropertyKey(JSContext *ctx, JSAtom atom) : ctx(ctx), atom(atom) {}
+
+PropertyKey::~PropertyKey()
+{
+    if (this->ctx)
+    {
+        JS_FreeAtom(this->ctx, this->atom);
+    }
+}
+
+PropertyKey::PropertyKey(PropertyKey &&other) noexcept : ctx(other.ctx), atom(other.atom)
+{
+    other.ctx = nullptr;
+}
 
-        if (force_free)
+PropertyKey &PropertyKey::operator=(PropertyKey &&other) noexcept
+{
+    if (this != &other)
+    {
+        if (this->ctx)
         {
-            JS_FreeValue(ctx, value);
+            JS_FreeAtom(this->ctx, this->atom);
         }
-        return JSArg(std::move(vec));
+        this->ctx = other.ctx;
+        this->atom = other.atom;
+        other.ctx = nullptr;
     }
-    else if (JS_IsNull(value))
+    return *this;
+}
+
+JSAtom PropertyKey::get_atom() const
+{
+    return this->atom;
+}
+
+const CommonAtoms &ejr::common_atoms(JSContext *ctx)
+{
+    // Predefined atoms are not reference counted, any runtime finds the same ones.
+    static const CommonAtoms atoms = {
+        JS_NewAtom(ctx, "length"),
+        JS_NewAtom(ctx, "message"),
+        JS_NewAtom(ctx, "name"),
+        JS_NewAtom(ctx, "constructor"),
+        JS_NewAtom(ctx, "prototype"),
+    };
+    return atoms;
+}
+
+/// @brief Build a record by defining each property, for key sets without a template.
+static JSValue define_record(JSContext *ctx, const std::string_view *keys, size_t count, JSValue *values)
+{
+    JSValue object = JS_NewObject(ctx);
+    for (size_t i = 0; i < count; i++)
     {
-        if (force_free)
+        if (JS_IsException(object))
         {
-            JS_FreeValue(ctx, value);
+            JS_FreeValue(ctx, values[i]);
+            continue;
         }
-        return std::string("null"); // or maybe return false/0 depending on your design
-    } else if (JS_IsUndefined(value)) {
-        if (force_free) {
-            JS_FreeValue(ctx, value);
+        JSAtom atom = JS_NewAtomLen(ctx, keys[i].data(), keys[i].size());
+        JS_DefinePropertyValue(ctx, object, atom, values[i], JS_PROP_C_W_E);
+        JS_FreeAtom(ctx, atom);
+    }
+
+    return object;
+}
+
+/// @brief Template objects for records, one per key set.
+///
+/// A record made from a template shares its shape, so building one is a allocation
+/// and a copy of the values instead of a shape transition per property.
+class ejr::RecordTemplates
+{
+public:
+    explicit RecordTemplates(JSContext *ctx) : ctx(ctx) {}
+
+    ~RecordTemplates()
+    {
+        for (auto &entry : this->templates)
+        {
+            JS_FreeValue(this->ctx, entry.second);
         }
-        return std::string("undefined");
-    } else if (JS_IsError(ctx, value)) {
-        JSValue message = JS_GetPropertyStr(ctx, value, "message");
-        JSValue name = JS_GetPropertyStr(ctx, value, "name");
+    }
 
-        const char* message_cstr = nullptr;
-        const char* name_cstr = nullptr;
+    RecordTemplates(const RecordTemplates &) = delete;
+    RecordTemplates &operator=(const RecordTemplates &) = delete;
 
-        if (!JS_IsUndefined(message)) {
-            message_cstr = JS_ToCString(ctx, message);
+    JSValue new_record(const std::string_view *keys, size_t count, JSValue *values)
+    {
+        // Length prefixed, so no key can run into the next one.
+        this->key_set.clear();
+        for (size_t i = 0; i < count; i++)
+        {
+            uint32_t length = static_cast<uint32_t>(keys[i].size());
+            this->key_set.append(reinterpret_cast<const char *>(&length), sizeof(length));
+            this->key_set.append(keys[i].data(), keys[i].size());
         }
-        if (!JS_IsUndefined(name)) {
-            name_cstr = JS_ToCString(ctx, name);
+
+        auto it = this->templates.find(this->key_set);
+        if (it == this->templates.end())
+        {
+            // Keys that keep changing would grow the cache forever.
+            if (this->templates.size() >= max_templates)
+            {
+                return define_record(this->ctx, keys, count, values);
+            }
+            it = this->templates.emplace(this->key_set, this->new_template(keys, count)).first;
         }
 
-        std::string message_str = message_cstr == nullptr ? "Exception" : std::string(message_cstr);
-        std::string name_str = name_cstr == nullptr ? "Exception" : std::string(name_cstr);
+        if (JS_IsUndefined(it->second))
+        {
+            return define_record(this->ctx, keys, count, values);
+        }
+        return JS_NewObjectFromTemplate(this->ctx, it->second, values, static_cast<int>(count));
+    }
 
-        JSArgException exec(message_str, name_cstr);
+private:
+    static constexpr size_t max_templates = 256;
 
-        if (force_free) {
-            JS_FreeValue(ctx, value);
+    /// @brief Create the template of a key set, undefined if a key repeats.
+    JSValue new_template(const std::string_view *keys, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            for (size_t j = 0; j < i; j++)
+            {
+                if (keys[i] == keys[j])
+                {
+                    return js_undefined();
+                }
+            }
         }
 
-        // Free message, name, message_cstr, name_cstr
-        JS_FreeValue(ctx, message);
-        JS_FreeValue(ctx, name);
-
-        if (message_cstr) {
-            JS_FreeCString(ctx, message_cstr);
+        JSValue object = JS_NewObject(this->ctx);
+        for (size_t i = 0; i < count && !JS_IsException(object); i++)
+        {
+            JSAtom atom = JS_NewAtomLen(this->ctx, keys[i].data(), keys[i].size());
+            JS_DefinePropertyValue(this->ctx, object, atom, js_undefined(), JS_PROP_C_W_E);
+            JS_FreeAtom(this->ctx, atom);
         }
-        if (name_cstr) {
-            JS_FreeCString(ctx, name_cstr);
+        if (JS_IsException(object))
+        {
+            JS_FreeValue(this->ctx, JS_GetException(this->ctx));
+            return js_undefined();
         }
 
-        return exec;
-    } else if (JS_IsException(value)) {
-        // Get exception
-        JSValue exception = JS_GetException(ctx);
+        return object;
+    }
 
-        // Convert to String
-        JSValue exception_js_str = JS_ToString(ctx, exception);
+    JSContext *ctx;
+    std::unordered_map<std::string, JSValue> templates;
+    /// @brief Reused for the lookups.
+    std::string key_set;
+};
 
-        // Make the error and name the same
-        const char* exeception_cstr = JS_ToCString(ctx, exception_js_str);
-        string exception_str = exeception_cstr == nullptr ? "Exception" : std::string(exeception_cstr);
+JSValue ejr::new_record(JSContext *ctx, const std::string_view *keys, size_t count, JSValue *values)
+{
+    EasyJSR *owner = EasyJSR::from_context(ctx);
+    if (!owner)
+    {
+        return define_record(ctx, keys, count, values);
+    }
+    return owner->new_record(keys, count, values);
+}
 
-        if (exeception_cstr) {
-            JS_FreeCString(ctx, exeception_cstr);
+JSArgObject &JSArgObject::set(const std::string &key, JSArg value)
+{
+    for (size_t i = 0; i < this->keys.size(); i++)
+    {
+        if (this->keys[i] == key)
+        {
+            this->values[i] = std::move(value);
+            return *this;
         }
-        JS_FreeValue(ctx, exception);
-        JS_FreeValue(ctx, exception_js_str);
+    }
+    this->keys.push_back(key);
+    this->values.push_back(std::move(value));
+
+    return *this;
+}
 
-        if (force_free) {
-            JS_FreeValue(ctx, value);
+const JSArg *JSArgObject::get(const std::string &key) const
+{
+    for (size_t i = 0; i < this->keys.size(); i++)
+    {
+        if (this->keys[i] == key)
+        {
+            return &this->values[i];
         }
+    }
 
-        return JSArgException(exception_str, exception_str);
-    } else {
-        
-        // Check if typed array
-        size_t byte_offset, byte_length, bytes_per_element;
-        JSValue typed_array_buffer = JS_GetTypedArrayBuffer(ctx, value, &byte_offset, &byte_length, &bytes_per_element);
-        if (!JS_IsException(typed_array_buffer)) {
-            JSValue constructor = JS_GetPropertyStr(ctx, value, "constructor");
-            JSValue name = JS_GetPropertyStr(ctx, constructor, "name");
-            const char* name_cstr = JS_ToCString(ctx, name);
+    return nullptr;
+}
 
-            size_t psize;
-            uint8_t* buffer_data = JS_GetArrayBuffer(ctx, &psize, typed_array_buffer);
-            // Free that SHIT
-            JS_FreeCString(ctx, name_cstr);
-            JS_FreeValue(ctx, name);
-            JS_FreeValue(ctx, constructor);
-            JS_FreeValue(ctx, typed_array_buffer);
+bool PreparedFunction::is_function() const
+{
+    return this->ctx && JS_IsFunction(this->ctx, this->function);
+}
 
-            if (force_free) {
-                JS_FreeValue(ctx, value);
-            }
+JSValue PreparedFunction::call(const vector<JSArg> &args)
+{
+    // Reuse the buffer, a nested call through the same function gets its own.
+    vector<JSValue> js_args = std::move(this->argv);
+    js_args.clear();
+    for (const auto &arg : args)
+    {
+        js_args.push_back(to_js(this->ctx, arg));
+    }
 
-            if (buffer_data == nullptr) {
-                return string("[unsupported]");
-            }
-            // Actually figure out the data.
-            uint8_t* typed_array_data = buffer_data + byte_offset;
-            size_t element_count = byte_length / bytes_per_element;
-
-            if (strcmp(name_cstr, "Uint8Array") == 0) {
-                return JSArgTypedArray<uint8_t>(typed_array_data, element_count);
-            } else if (strcmp(name_cstr,"Uint16Array") == 0) {
-                return JSArgTypedArray<uint16_t>(typed_array_data, element_count);
-            } else if (strcmp(name_cstr, "Uint32Array") == 0) {
-                return JSArgTypedArray<uint32_t>(typed_array_data, element_count);
-            } else if (strcmp(name_cstr, "Int8Array") == 0) {
-                return JSArgTypedArray<int8_t>(typed_array_data, element_count);
-            } else if (strcmp(name_cstr, "Int16Array") == 0) {
-                return JSArgTypedArray<int16_t>(typed_array_data, element_count);
-            } else if (strcmp(name_cstr, "Int32Array") == 0) {
-                return JSArgTypedArray<int32_t>(typed_array_data, element_count);
-            } else if (strcmp(name_cstr, "Float32Array") == 0) {
-                return JSArgTypedArray<float>(typed_array_data, element_count);
-            } else if (strcmp(name_cstr, "BigUint64Array") == 0) {
-                return JSArgTypedArray<uint64_t>(typed_array_data, element_count);
-            } else if (strcmp(name_cstr, "BigInt64Array") == 0) {
-                return JSArgTypedArray<int64_t>(typed_array_data, element_count);
-            }
+    JSValue result = this->call(static_cast<int>(js_args.size()), js_args.data());
 
-        } else {
-            // Free typed_array_buffer Cause it aint 
-            JS_FreeValue(ctx, typed_array_buffer);
-        }
+    for (auto &value : js_args)
+    {
+        JS_FreeValue(this->ctx, value);
     }
+    this->argv = std::move(js_args);
 
-    // Fallback: return [unsupported] as string
-    if (force_free)
+    return result;
+}
+
+JSValue PreparedFunction::call(int argc, JSValueConst *argv)
+{
+    return JS_Call(this->ctx, this->function, this->this_obj, argc, argv);
+}
+
+JSMethod::JSMethod(const string &name, DynCallback callback)
+{
+    this->name = name;
+    this->callback = std::move(callback);
+}
+
+JSMethod::JSMethod(const string &name, RawCallback raw_callback, void *opaque)
+{
+    this->name = name;
+    this->raw_callback = raw_callback;
+    this->opaque = opaque;
+}
+
+// SharedArrayBuffers are shared by every EasyJSR, so serialized values can pass them between runtimes.
+// Each one is prefixed with its reference count.
+static constexpr size_t shared_buffer_header = alignof(std::max_align_t);
+
+static std::atomic<int> *shared_buffer_ref_count(void *ptr)
+{
+    return reinterpret_cast<std::atomic<int> *>(static_cast<uint8_t *>(ptr) - shared_buffer_header);
+}
+
+static void *shared_buffer_alloc(void *opaque, size_t size)
+{
+    uint8_t *block = static_cast<uint8_t *>(std::malloc(shared_buffer_header + size));
+    if (!block)
     {
-        JS_FreeValue(ctx, value);
+        return nullptr;
     }
-    return std::string("[unsupported]");
+    new (block) std::atomic<int>(1);
+    return block + shared_buffer_header;
 }
 
-string ejr::jsarg_to_str(const JSArg &arg)
+static void shared_buffer_free(void *opaque, void *ptr)
 {
-    return jsarg_as<std::string>(arg);
+    std::atomic<int> *ref_count = shared_buffer_ref_count(ptr);
+    if (ref_count->fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        ref_count->~atomic();
+        std::free(ref_count);
+    }
 }
 
-EJRValue::EJRValue(JSContext *ctx, JSValue val)
+static void shared_buffer_dup(void *opaque, void *ptr)
 {
-    this->ctx = ctx;
-    this->val = val;
+    shared_buffer_ref_count(ptr)->fetch_add(1, std::memory_order_relaxed);
 }
 
-EJRValue::~EJRValue()
+static const JSSharedArrayBufferFunctions shared_buffer_functions = {
+    shared_buffer_alloc,
+    shared_buffer_free,
+    shared_buffer_dup,
+    nullptr,
+};
+
+SerializedValue::~SerializedValue()
 {
-    // if (JS_IsLiveObject(this->runtime, this->val)) {
-    JS_FreeValue(this->ctx, this->val);
-    // }
+    for (void *buffer : this->shared_buffers)
+    {
+        shared_buffer_free(nullptr, buffer);
+    }
 }
 
-JSValue &EJRValue::get_ref()
+SerializedValue::SerializedValue(SerializedValue &&other) noexcept
+    : bytes(std::move(other.bytes)), shared_buffers(std::move(other.shared_buffers))
 {
-    return this->val;
+    other.shared_buffers.clear();
 }
 
-JSMethod::JSMethod(const string &name, DynCallback callback)
+SerializedValue &SerializedValue::operator=(SerializedValue &&other) noexcept
 {
-    this->name = name;
-    this->callback = std::move(callback);
+    if (this != &other)
+    {
+        for (void *buffer : this->shared_buffers)
+        {
+            shared_buffer_free(nullptr, buffer);
+        }
+        this->bytes = std::move(other.bytes);
+        this->shared_buffers = std::move(other.shared_buffers);
+        other.shared_buffers.clear();
+    }
+    return *this;
 }
 
-EasyJSR::EasyJSR()
+const vector<uint8_t> &SerializedValue::data() const
+{
+    return this->bytes;
+}
+
+bool SerializedValue::has_shared_buffers() const
+{
+    return !this->shared_buffers.empty();
+}
+
+/// @brief A context with the base objects and the ContextTemplate::Intrinsic built-ins in intrinsics.
+static JSContext *new_context(JSRuntime *runtime, uint32_t intrinsics)
+{
+    if (intrinsics == ContextTemplate::AllIntrinsics)
+    {
+        return JS_NewContext(runtime);
+    }
+
+    // In the order of JS_NewContext.
+    JSContext *ctx = JS_NewContextRaw(runtime);
+    if (!ctx)
+    {
+        return nullptr;
+    }
+    JS_AddIntrinsicBaseObjects(ctx);
+    if (intrinsics & ContextTemplate::Date)
+    {
+        JS_AddIntrinsicDate(ctx);
+    }
+    JS_AddIntrinsicEval(ctx);
+    JS_AddIntrinsicStringNormalize(ctx);
+    if (intrinsics & ContextTemplate::RegExp)
+    {
+        JS_AddIntrinsicRegExp(ctx);
+    }
+    JS_AddIntrinsicJSON(ctx);
+    if (intrinsics & ContextTemplate::Proxy)
+    {
+        JS_AddIntrinsicProxy(ctx);
+    }
+    if (intrinsics & ContextTemplate::MapSet)
+    {
+        JS_AddIntrinsicMapSet(ctx);
+    }
+    if (intrinsics & ContextTemplate::TypedArrays)
+    {
+        JS_AddIntrinsicTypedArrays(ctx);
+    }
+    JS_AddIntrinsicPromise(ctx);
+    if (intrinsics & ContextTemplate::WeakRef)
+    {
+        JS_AddIntrinsicWeakRef(ctx);
+    }
+    return ctx;
+}
+
+EasyJSR::EasyJSR() : EasyJSR(static_cast<uint32_t>(ContextTemplate::AllIntrinsics))
+{
+}
+
+EasyJSR::EasyJSR(const ContextTemplate &context_template) : EasyJSR(context_template.get_intrinsics())
+{
+    context_template.apply(*this);
+}
+
+EasyJSR::EasyJSR(uint32_t intrinsics)
 {
     this->runtime = JS_NewRuntime();
     if (!this->runtime)
@@ -372,17 +1172,34 @@ EasyJSR::EasyJSR()
 
     // Setup module loader
     JS_SetModuleLoaderFunc(this->runtime, nullptr, js_module_loader, static_cast<void *>(this));
+    JS_SetSharedArrayBufferFunctions(this->runtime, &shared_buffer_functions);
 
-    this->ctx = JS_NewContext(this->runtime);
+    this->ctx = new_context(this->runtime, intrinsics);
+    if (this->ctx)
+    {
+        JS_SetContextOpaque(this->ctx, this);
+        this->record_templates = std::make_unique<RecordTemplates>(this->ctx);
+    }
 }
 
 EasyJSR::~EasyJSR()
 {
+    // The templates hold values of the context.
+    this->record_templates.reset();
+
+    // Methods of modules that were never imported.
+    for (auto &module : this->methods_by_module)
+    {
+        for (auto &method : module.second)
+        {
+            JS_FreeValue(this->ctx, std::get<1>(method));
+        }
+    }
+    this->methods_by_module.clear();
+
     // Free context first.
     if (this->ctx)
     {
-        this->callbacks.clear();
-
         JS_FreeContext(this->ctx);
         this->ctx = nullptr;
     }
@@ -394,6 +1211,21 @@ EasyJSR::~EasyJSR()
     }
 }
 
+void EasyJSR::keep_alive(std::shared_ptr<void> object)
+{
+    this->kept_alive.push_back(std::move(object));
+}
+
+EasyJSR *EasyJSR::from_context(JSContext *ctx)
+{
+    return static_cast<EasyJSR *>(JS_GetContextOpaque(ctx));
+}
+
+JSValue EasyJSR::new_record(const std::string_view *keys, size_t count, JSValue *values)
+{
+    return this->record_templates->new_record(keys, count, values);
+}
+
 int EasyJSR::module_init(JSContext *ctx, JSModuleDef *m)
 {
     // Get the module name
@@ -413,8 +1245,9 @@ int EasyJSR::module_init(JSContext *ctx, JSModuleDef *m)
     uintptr_t pval = stoull(ptr, nullptr, 16);
     EasyJSR *ejsr = reinterpret_cast<EasyJSR *>(pval);
 
-    // Now lets add our module methods...
-    vector<tuple<string, JSValue>> module_methods = ejsr->methods_by_module[real_mod_name];
+    // Now lets add our module methods, the module owns them from here on.
+    vector<tuple<string, JSValue>> module_methods = std::move(ejsr->methods_by_module[real_mod_name]);
+    ejsr->methods_by_module.erase(real_mod_name);
 
     for (auto &method : module_methods)
     {
@@ -444,6 +1277,86 @@ JSValue EasyJSR::eval_module(const string &js_module, const string &file_name)
     return promise;
 }
 
+JSValue EasyJSR::parse_json(const char *json, size_t length, const string &file_name)
+{
+    return JS_ParseJSON(this->ctx, json, length, file_name.c_str());
+}
+
+JSValue EasyJSR::parse_json(const string &json, const string &file_name)
+{
+    // std::string is always terminated, so it can be parsed in place.
+    return this->parse_json(json.c_str(), json.size(), file_name);
+}
+
+bool EasyJSR::stringify_json(JSValueConst value, const std::function<void(const char *, size_t)> &sink)
+{
+    JSValue json = JS_JSONStringify(this->ctx, value, js_undefined(), js_undefined());
+    if (!JS_IsString(json))
+    {
+        // An exception, or undefined for values JSON can not hold.
+        JS_FreeValue(this->ctx, json);
+        return false;
+    }
+
+    size_t length;
+    const char *text = JS_ToCStringLen(this->ctx, &length, json);
+    JS_FreeValue(this->ctx, json);
+    if (!text)
+    {
+        return false;
+    }
+
+    sink(text, length);
+    JS_FreeCString(this->ctx, text);
+
+    return true;
+}
+
+bool EasyJSR::stringify_json(JSValueConst value, string &out)
+{
+    return this->stringify_json(value, [&out](const char *text, size_t length)
+                                { out.append(text, length); });
+}
+
+bool EasyJSR::serialize_value(JSValueConst value, SerializedValue &out, bool allow_shared)
+{
+    int flags = JS_WRITE_OBJ_REFERENCE | (allow_shared ? JS_WRITE_OBJ_SAB : 0);
+    size_t size;
+    uint8_t **shared_buffers;
+    size_t shared_buffer_count;
+    uint8_t *bytes = JS_WriteObject2(this->ctx, &size, value, flags, &shared_buffers, &shared_buffer_count);
+    if (!bytes)
+    {
+        return false;
+    }
+
+    SerializedValue serialized;
+    serialized.bytes.assign(bytes, bytes + size);
+    js_free(this->ctx, bytes);
+
+    // The bytes only hold the addresses, keep the buffers alive until the value is read.
+    for (size_t i = 0; i < shared_buffer_count; i++)
+    {
+        shared_buffer_dup(nullptr, shared_buffers[i]);
+        serialized.shared_buffers.push_back(shared_buffers[i]);
+    }
+    js_free(this->ctx, shared_buffers);
+
+    out = std::move(serialized);
+    return true;
+}
+
+JSValue EasyJSR::deserialize_value(const SerializedValue &value)
+{
+    int flags = JS_READ_OBJ_REFERENCE | (value.has_shared_buffers() ? JS_READ_OBJ_SAB : 0);
+    return JS_ReadObject(this->ctx, value.bytes.data(), value.bytes.size(), flags);
+}
+
+JSValue EasyJSR::deserialize_value(const uint8_t *bytes, size_t size)
+{
+    return JS_ReadObject(this->ctx, bytes, size, JS_READ_OBJ_REFERENCE);
+}
+
 void EasyJSR::free_jsval(JSValue value)
 {
     if (value.tag)
@@ -465,9 +1378,196 @@ void EasyJSR::free_jsvals(const vector<JSValue> &values)
 
 JSValue EasyJSR::eval(const string &js_script, const string &file_name, int eval_flags)
 {
+    if (this->bytecode_cache && !(eval_flags & JS_EVAL_FLAG_COMPILE_ONLY))
+    {
+        return this->eval_cached(js_script, file_name, eval_flags);
+    }
     return JS_Eval(this->ctx, js_script.c_str(), js_script.size(), file_name.c_str(), eval_flags);
 }
 
+JSValue EasyJSR::eval_cached(const string &js, const string &file_name, int eval_flags)
+{
+    BytecodeCache &cache = *this->bytecode_cache;
+    uint64_t key = BytecodeCache::key_of(js.data(), js.size(), file_name, eval_flags);
+
+    vector<uint8_t> bytecode;
+    if (cache.load(key, bytecode))
+    {
+        JSValue function = JS_ReadObject(this->ctx, bytecode.data(), bytecode.size(), JS_READ_OBJ_BYTECODE);
+        if (!JS_IsException(function))
+        {
+            // Modules still need their imports loaded. A missing import fails compiling just the same, so it fails here.
+            if (JS_ResolveModule(this->ctx, function) < 0)
+            {
+                cache.count_lookup(false);
+                JS_FreeValue(this->ctx, function);
+                return JS_EXCEPTION;
+            }
+            cache.count_lookup(true);
+            return JS_EvalFunction(this->ctx, function);
+        }
+        // Unreadable, compile it again below.
+        cache.count_lookup(false);
+        JS_FreeValue(this->ctx, JS_GetException(this->ctx));
+    }
+    else
+    {
+        cache.count_lookup(false);
+    }
+
+    JSValue function = JS_Eval(this->ctx, js.c_str(), js.size(), file_name.c_str(), eval_flags | JS_EVAL_FLAG_COMPILE_ONLY);
+    if (JS_IsException(function))
+    {
+        return function;
+    }
+
+    size_t size;
+    uint8_t *bytes = JS_WriteObject(this->ctx, &size, function, JS_WRITE_OBJ_BYTECODE);
+    if (bytes)
+    {
+        cache.store(key, bytes, size);
+        js_free(this->ctx, bytes);
+    }
+    else
+    {
+        JS_FreeValue(this->ctx, JS_GetException(this->ctx));
+    }
+
+    return JS_EvalFunction(this->ctx, function);
+}
+
+void EasyJSR::set_bytecode_cache(std::shared_ptr<BytecodeCache> cache)
+{
+    this->bytecode_cache = std::move(cache);
+}
+
+const std::shared_ptr<BytecodeCache> &EasyJSR::get_bytecode_cache() const
+{
+    return this->bytecode_cache;
+}
+
+void EasyJSR::set_module_cache_enabled(bool enabled)
+{
+    this->use_module_cache = enabled;
+}
+
+bool EasyJSR::module_cache_enabled() const
+{
+    return this->use_module_cache;
+}
+
+void EasyJSR::mount_bytecode_bundle(std::shared_ptr<MappedBytecodeBundle> bundle)
+{
+    if (bundle)
+    {
+        this->mounted_bundles.push_back(std::move(bundle));
+    }
+}
+
+JSModuleDef *EasyJSR::load_bundled_module(const string &name)
+{
+    for (const auto &bundle : this->mounted_bundles)
+    {
+        const BytecodeBundleEntry *entry = bundle->find_module(name);
+        if (!entry)
+        {
+            continue;
+        }
+
+        JSValue module = JS_ReadObject(this->ctx, entry->bytecode, entry->size, JS_READ_OBJ_BYTECODE);
+        if (JS_IsException(module))
+        {
+            // Leave the exception, the import fails with it.
+            return nullptr;
+        }
+        if (JS_VALUE_GET_TAG(module) != JS_TAG_MODULE)
+        {
+            // Flagged as a module, but script bytecode.
+            JS_FreeValue(this->ctx, module);
+            JS_ThrowTypeError(this->ctx, "bundled module '%s' is not a module", name.c_str());
+            return nullptr;
+        }
+        // The context keeps it, like a compiled module.
+        JSModuleDef *m = static_cast<JSModuleDef *>(JS_VALUE_GET_PTR(module));
+        JS_FreeValue(this->ctx, module);
+        return m;
+    }
+    return nullptr;
+}
+
+bool EasyJSR::compile_bytecode(const string &js, const string &file_name, int eval_flags, vector<uint8_t> &out, bool strip)
+{
+    // QuickJS strips while compiling, not while writing.
+    int strip_info = JS_GetStripInfo(this->runtime);
+    if (strip)
+    {
+        JS_SetStripInfo(this->runtime, JS_STRIP_DEBUG);
+    }
+    JSValue function = JS_Eval(this->ctx, js.c_str(), js.size(), file_name.c_str(), eval_flags | JS_EVAL_FLAG_COMPILE_ONLY);
+    JS_SetStripInfo(this->runtime, strip_info);
+    if (JS_IsException(function))
+    {
+        return false;
+    }
+
+    size_t size;
+    uint8_t *bytes = JS_WriteObject(this->ctx, &size, function, JS_WRITE_OBJ_BYTECODE);
+    JS_FreeValue(this->ctx, function);
+    if (!bytes)
+    {
+        return false;
+    }
+    out.assign(bytes, bytes + size);
+    js_free(this->ctx, bytes);
+    return true;
+}
+
+JSValue EasyJSR::eval_bytecode(const uint8_t *bundle, size_t size, bool in_place)
+{
+    vector<BytecodeBundleEntry> entries;
+    if (!read_bytecode_bundle(bundle, size, entries))
+    {
+        return JS_ThrowTypeError(this->ctx, "invalid bytecode bundle");
+    }
+
+    // Load everything before running anything, so modules of the bundle find each other when imported.
+    int read_flags = JS_READ_OBJ_BYTECODE | (in_place ? JS_READ_OBJ_ROM_DATA : 0);
+    vector<JSValue> functions;
+    functions.reserve(entries.size());
+    for (const BytecodeBundleEntry &entry : entries)
+    {
+        JSValue function = JS_ReadObject(this->ctx, entry.bytecode, entry.size, read_flags);
+        if (JS_IsException(function))
+        {
+            this->free_jsvals(functions);
+            return function;
+        }
+        functions.push_back(function);
+    }
+    for (JSValue function : functions)
+    {
+        if (JS_VALUE_GET_TAG(function) == JS_TAG_MODULE && JS_ResolveModule(this->ctx, function) < 0)
+        {
+            this->free_jsvals(functions);
+            return JS_EXCEPTION;
+        }
+    }
+
+    JSValue result = JS_UNDEFINED;
+    for (size_t i = 0; i < functions.size(); i++)
+    {
+        this->free_jsval(result);
+        result = JS_EvalFunction(this->ctx, functions[i]);
+        if (JS_IsException(result) || JS_PromiseState(this->ctx, result) == JS_PROMISE_REJECTED)
+        {
+            // The rest never ran.
+            this->free_jsvals(vector<JSValue>(functions.begin() + i + 1, functions.end()));
+            break;
+        }
+    }
+    return result;
+}
+
 JSValue EasyJSR::eval_function(const string &fnName, const vector<JSArg> &args)
 {
     // Get the function
@@ -513,6 +1613,11 @@ string EasyJSR::val_to_string(JSValue value, bool free)
     return value_string;
 }
 
+JSContext *EasyJSR::get_context()
+{
+    return this->ctx;
+}
+
 JSValue EasyJSR::get_from_global(const string &name)
 {
     JSValue global = JS_GetGlobalObject(this->ctx);
@@ -527,8 +1632,9 @@ JSValue EasyJSR::eval_class_function(JSValue class_obj, const string &fn_name, c
 {
     JSValue function = JS_GetPropertyStr(this->ctx, class_obj, fn_name.c_str());
     vector<JSValue> js_args;
+    js_args.reserve(args.size());
 
-    for (auto arg : args)
+    for (const auto &arg : args)
     {
         js_args.push_back(to_js(this->ctx, arg));
     }
@@ -541,11 +1647,46 @@ JSValue EasyJSR::eval_class_function(JSValue class_obj, const string &fn_name, c
     return result;
 }
 
-void EasyJSR::register_callback(const string &fn_name, DynCallback callback)
+PreparedFunction EasyJSR::prepare_function(const string &fn_name)
+{
+    JSValue global = JS_GetGlobalObject(this->ctx);
+    PreparedFunction function = this->prepare_class_function(global, fn_name);
+    this->free_jsval(global);
+
+    return function;
+}
+
+PreparedFunction EasyJSR::prepare_class_function(JSValue obj, const string &fn_name)
+{
+    JSValue function = JS_GetPropertyStr(this->ctx, obj, fn_name.c_str());
+    return PreparedFunction(this->ctx, function, JS_DupValue(this->ctx, obj));
+}
+
+void EasyJSR::register_callback(const string &fn_name, DynCallback callback, bool borrow_typed_arrays)
+{
+    JSValue global = JS_GetGlobalObject(this->ctx);
+
+    auto fn = this->create_trampoline(std::move(callback), borrow_typed_arrays);
+
+    JS_SetPropertyStr(this->ctx, global, fn_name.c_str(), fn);
+    this->free_jsval(global);
+}
+
+void EasyJSR::register_compact_callback(const string &fn_name, CompactCallback callback)
+{
+    JSValue global = JS_GetGlobalObject(this->ctx);
+
+    auto fn = this->create_compact_trampoline(std::move(callback));
+
+    JS_SetPropertyStr(this->ctx, global, fn_name.c_str(), fn);
+    this->free_jsval(global);
+}
+
+void EasyJSR::register_raw_callback(const string &fn_name, RawCallback callback, void *opaque)
 {
     JSValue global = JS_GetGlobalObject(this->ctx);
 
-    auto fn = this->create_trampoline(fn_name, callback);
+    auto fn = this->create_raw_trampoline(callback, opaque);
 
     JS_SetPropertyStr(this->ctx, global, fn_name.c_str(), fn);
     this->free_jsval(global);
@@ -573,12 +1714,12 @@ void EasyJSR::register_module(const string &module_name, const vector<JSMethod>
     // Create the trampolines
     for (auto &method : methods)
     {
-        // Mangle the callback name in EasyJSR.
-        string cb_name = "__" + module_name + "_" + method.name;
         string method_name = method.name;
         JS_AddModuleExport(this->ctx, m, method.name.c_str());
         // Create actual method in EJR, and just keep the JSValue alive for now...
-        auto fn = this->create_trampoline(cb_name, method.callback);
+        auto fn = method.raw_callback
+                      ? this->create_raw_trampoline(method.raw_callback, method.opaque)
+                      : this->create_trampoline(method.callback);
         module_methods.push_back(make_tuple(method_name, fn));
     }
 
@@ -611,52 +1752,249 @@ JSValue EasyJSR::get_property_from(JSValue this_obj, string property)
     return JS_GetPropertyStr(this->ctx, this_obj, property.c_str());
 }
 
-JSValue EasyJSR::create_trampoline(const string &cb_name, DynCallback cb)
+PropertyKey EasyJSR::intern_key(const string &property)
+{
+    return PropertyKey(this->ctx, JS_NewAtomLen(this->ctx, property.c_str(), property.size()));
+}
+
+JSValue EasyJSR::get_property_from(JSValueConst object, const PropertyKey &key)
+{
+    return JS_GetProperty(this->ctx, object, key.get_atom());
+}
+
+bool EasyJSR::set_property(JSValueConst object, const PropertyKey &key, JSValue value)
+{
+    return JS_SetProperty(this->ctx, object, key.get_atom(), value) >= 0;
+}
+
+namespace
+{
+    /// @brief A DynCallback bound to one JS function.
+    struct DynCallbackSlot : NativeCallback
+    {
+        DynCallback callback;
+        bool borrow_typed_arrays;
+
+        DynCallbackSlot(DynCallback callback, bool borrow_typed_arrays)
+            : callback(std::move(callback)), borrow_typed_arrays(borrow_typed_arrays) {}
+    };
+
+    /// @brief A RawCallback bound to one JS function.
+    struct RawCallbackSlot : NativeCallback
+    {
+        RawCallback callback;
+        void *opaque;
+
+        RawCallbackSlot(RawCallback callback, void *opaque) : callback(callback), opaque(opaque) {}
+    };
+
+    /// @brief A CompactCallback bound to one JS function.
+    struct CompactCallbackSlot : NativeCallback
+    {
+        EasyJSR *owner;
+        CompactCallback callback;
+
+        CompactCallbackSlot(EasyJSR *owner, CompactCallback callback)
+            : owner(owner), callback(std::move(callback)) {}
+    };
+}
+
+JSValue EasyJSR::new_native_function(unique_ptr<NativeCallback> native, JSCFunctionData *call, int length)
+{
+    JSValue func_data[2];
+    pointer_to_js(native.get(), func_data);
+    // func_data only holds int32s, nothing to free.
+    JSValue fn = JS_NewCFunctionData(this->ctx, call, length, 0, 2, func_data);
+    this->native_callbacks.push_back(std::move(native));
+
+    return fn;
+}
+
+JSValue EasyJSR::call_class_constructor(JSContext *ctx, JSValueConst new_target, int argc, JSValueConst *argv, int magic)
 {
-    this->callbacks[cb_name] = std::move(cb);
+    const ClassConstructor &constructor = EasyJSR::from_context(ctx)->class_constructors[magic];
+    JSValue func_data[2];
+    pointer_to_js(constructor.native.get(), func_data);
+    return constructor.construct(ctx, new_target, argc, argv, magic, func_data);
+}
 
+JSValue EasyJSR::create_trampoline(DynCallback cb, bool borrow_typed_arrays)
+{
     // Create JS function bound to callback
     auto trampoline = [](JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv, int magic, JSValue *func_data) -> JSValue
     {
-        int64_t address_int64;
-        JS_ToBigInt64(ctx, &address_int64, func_data[0]);
-        uintptr_t address = static_cast<uintptr_t>(address_int64);
-        EasyJSR *self = reinterpret_cast<EasyJSR *>(address);
+        auto *slot = static_cast<DynCallbackSlot *>(pointer_from_js(func_data));
 
         // Convert JS args -> std::vector<JSArg>
+        // Borrowed typed arrays are safe, argv outlives the callback.
         std::vector<JSArg> cpp_args;
+        cpp_args.reserve(argc);
         for (int i = 0; i < argc; i++)
         {
-            cpp_args.push_back(from_js(ctx, argv[i], false));
+            cpp_args.push_back(from_js(ctx, argv[i], false, slot->borrow_typed_arrays));
+        }
+
+        // Call C++ callback
+        JSArg result = slot->callback(cpp_args);
+
+        // Convert result back to JS, the result is ours so typed arrays are moved.
+        return to_js(ctx, std::move(result));
+    };
+
+    return this->new_native_function(make_unique<DynCallbackSlot>(std::move(cb), borrow_typed_arrays), trampoline, 0);
+}
+
+JSValue EasyJSR::create_compact_trampoline(CompactCallback cb)
+{
+    // Create JS function bound to callback
+    auto trampoline = [](JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv, int magic, JSValue *func_data) -> JSValue
+    {
+        auto *slot = static_cast<CompactCallbackSlot *>(pointer_from_js(func_data));
+        EasyJSR *self = slot->owner;
+
+        // Reuse the args of this depth, a nested call gets its own.
+        if (self->compact_depth == self->compact_args_pool.size())
+        {
+            self->compact_args_pool.push_back(std::make_unique<JSCompactArgs>());
         }
+        JSCompactArgs &args = *self->compact_args_pool[self->compact_depth];
 
-        // Lookup callback by magic
-        const char *cbname_cstr = JS_ToCString(ctx, func_data[1]);
-        std::string cb_name(cbname_cstr);
-        JS_FreeCString(ctx, cbname_cstr);
+        // Claimed before converting, getters and proxies read by it can make nested calls.
+        struct DepthGuard
+        {
+            size_t &depth;
+            explicit DepthGuard(size_t &depth) : depth(depth) { this->depth++; }
+            ~DepthGuard() { this->depth--; }
+        } guard(self->compact_depth);
 
-        auto it = self->callbacks.find(cb_name);
-        if (it == self->callbacks.end())
+        // Convert JS args -> JSCompactArgs
+        args.clear();
+        for (int i = 0; i < argc; i++)
         {
-            return js_undefined();
+            args.push_js(ctx, argv[i]);
         }
 
         // Call C++ callback
-        JSArg result = it->second(cpp_args);
+        JSArg result = slot->callback(args);
 
         // Convert result back to JS
-        return to_js(ctx, result);
+        return to_js(ctx, std::move(result));
     };
-    // Store EasyJSR* and callback name inside function object
-    JSValue func_data[2];
-    uintptr_t address = reinterpret_cast<uintptr_t>(this);
-    int64_t address_int64 = static_cast<int64_t>(address);
-    func_data[0] = JS_NewBigInt64(this->ctx, address_int64);
-    func_data[1] = JS_NewString(this->ctx, cb_name.c_str());
 
-    JSValue fn = JS_NewCFunctionData(this->ctx, trampoline, 0, 0, 2, func_data);
+    return this->new_native_function(make_unique<CompactCallbackSlot>(this, std::move(cb)), trampoline, 0);
+}
 
-    return fn;
+JSValue EasyJSR::create_raw_trampoline(RawCallback cb, void *opaque)
+{
+    auto trampoline = [](JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv, int magic, JSValue *func_data) -> JSValue
+    {
+        auto *slot = static_cast<RawCallbackSlot *>(pointer_from_js(func_data));
+        return slot->callback(ctx, argc, argv, slot->opaque);
+    };
+
+    return this->new_native_function(make_unique<RawCallbackSlot>(cb, opaque), trampoline, 0);
+}
+
+JSValue ejr::new_class_object(JSContext *ctx, JSClassID class_id, JSValueConst new_target, void *opaque)
+{
+    if (!JS_IsRegisteredClass(JS_GetRuntime(ctx), class_id))
+    {
+        return JS_ThrowTypeError(ctx, "class is not registered");
+    }
+
+    // new_target is the constructor (or subclass) new was called on.
+    JSValue proto = js_undefined();
+    if (!JS_IsUndefined(new_target))
+    {
+        proto = JS_GetProperty(ctx, new_target, common_atoms(ctx).prototype);
+        if (JS_IsException(proto))
+        {
+            return proto;
+        }
+    }
+    if (!JS_IsObject(proto))
+    {
+        JS_FreeValue(ctx, proto);
+        proto = JS_GetClassProto(ctx, class_id);
+    }
+
+    JSValue object = JS_NewObjectProtoClass(ctx, proto, class_id);
+    JS_FreeValue(ctx, proto);
+    if (JS_IsException(object))
+    {
+        return object;
+    }
+
+    JS_SetOpaque(object, opaque);
+    return object;
+}
+
+bool EasyJSR::define_class(JSClassID class_id, const string &class_name, JSClassFinalizer *finalizer,
+    unique_ptr<NativeCallback> constructor, JSCFunctionData *construct, int length)
+{
+    // Class ids are global, the class is registered once per runtime.
+    if (!JS_IsRegisteredClass(this->runtime, class_id))
+    {
+        JSClassDef def{};
+        def.class_name = class_name.c_str();
+        def.finalizer = finalizer;
+        if (JS_NewClass(this->runtime, class_id, &def) < 0)
+        {
+            return false;
+        }
+    }
+
+    JSValue ctor;
+    if (construct)
+    {
+        int magic = static_cast<int>(this->class_constructors.size());
+        this->class_constructors.push_back(ClassConstructor{std::move(constructor), construct});
+        ctor = JS_NewCFunctionMagic(this->ctx, &EasyJSR::call_class_constructor, class_name.c_str(), length,
+                                    JS_CFUNC_constructor_magic, magic);
+    }
+    else
+    {
+        auto illegal_constructor = [](JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) -> JSValue
+        {
+            return JS_ThrowTypeError(ctx, "Illegal constructor");
+        };
+        ctor = JS_NewCFunction2(this->ctx, illegal_constructor, class_name.c_str(), 0, JS_CFUNC_constructor, 0);
+    }
+
+    // ctor.prototype and proto.constructor
+    JSValue proto = JS_NewObject(this->ctx);
+    JS_SetConstructor(this->ctx, ctor, proto);
+    JS_SetClassProto(this->ctx, class_id, proto);
+
+    JSValue global = JS_GetGlobalObject(this->ctx);
+    JS_SetPropertyStr(this->ctx, global, class_name.c_str(), ctor);
+    this->free_jsval(global);
+    return true;
+}
+
+void EasyJSR::define_class_method(JSClassID class_id, const string &name,
+    unique_ptr<NativeCallback> native, JSCFunctionData *call, int length)
+{
+    JSValue fn = this->new_native_function(std::move(native), call, length);
+
+    // Not enumerable, like the methods of a JS class.
+    JSValue proto = JS_GetClassProto(this->ctx, class_id);
+    JS_DefinePropertyValueStr(this->ctx, proto, name.c_str(), fn, JS_PROP_WRITABLE | JS_PROP_CONFIGURABLE);
+    this->free_jsval(proto);
+}
+
+void EasyJSR::define_class_property(JSClassID class_id, const string &name,
+    unique_ptr<NativeCallback> getter, JSCFunctionData *get,
+    unique_ptr<NativeCallback> setter, JSCFunctionData *set)
+{
+    JSValue get_fn = this->new_native_function(std::move(getter), get, 0);
+    JSValue set_fn = set ? this->new_native_function(std::move(setter), set, 1) : js_undefined();
+
+    JSValue proto = JS_GetClassProto(this->ctx, class_id);
+    JSAtom atom = JS_NewAtom(this->ctx, name.c_str());
+    JS_DefinePropertyGetSet(this->ctx, proto, atom, get_fn, set_fn, JS_PROP_CONFIGURABLE);
+    JS_FreeAtom(this->ctx, atom);
+    this->free_jsval(proto);
 }
 
 void EasyJSR::set_file_loader(FileLoaderFn loader_fn) {
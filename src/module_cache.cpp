@@ -0,0 +1,87 @@
+#include <include/ejr.hpp>
+#include <mutex>
+
+using namespace ejr;
+using namespace std;
+
+ModuleCache &ModuleCache::shared()
+{
+    static ModuleCache cache;
+    return cache;
+}
+
+uint64_t ModuleCache::key_of(const string &name, const char *source, size_t length)
+{
+    return BytecodeCache::key_of(source, length, name, JS_EVAL_TYPE_MODULE);
+}
+
+JSModuleDef *ModuleCache::load(JSContext *ctx, uint64_t key, const string &name)
+{
+    shared_ptr<const Entry> entry;
+    {
+        shared_lock<shared_mutex> lock(this->mutex);
+        auto it = this->entries.find(key);
+        if (it != this->entries.end() && it->second->name == name)
+        {
+            entry = it->second;
+        }
+    }
+    // Read outside the lock, the entry stays alive even if it is cleared meanwhile.
+    JSValue module = entry ? JS_ReadObject(ctx, entry->bytecode.data(), entry->bytecode.size(), JS_READ_OBJ_BYTECODE) : JS_EXCEPTION;
+    if (JS_IsException(module))
+    {
+        if (entry)
+        {
+            JS_FreeValue(ctx, JS_GetException(ctx));
+        }
+        this->miss_count++;
+        return nullptr;
+    }
+    this->hit_count++;
+
+    // Like a compiled module, the context keeps it.
+    JSModuleDef *m = static_cast<JSModuleDef *>(JS_VALUE_GET_PTR(module));
+    JS_FreeValue(ctx, module);
+    return m;
+}
+
+void ModuleCache::store(JSContext *ctx, uint64_t key, const string &name, JSValueConst module)
+{
+    size_t size;
+    uint8_t *bytes = JS_WriteObject(ctx, &size, module, JS_WRITE_OBJ_BYTECODE);
+    if (!bytes)
+    {
+        JS_FreeValue(ctx, JS_GetException(ctx));
+        return;
+    }
+    auto entry = make_shared<Entry>();
+    entry->name = name;
+    entry->bytecode.assign(bytes, bytes + size);
+    js_free(ctx, bytes);
+
+    unique_lock<shared_mutex> lock(this->mutex);
+    // Runtimes compiling the same module at once store the same bytecode, the first one stays.
+    this->entries.emplace(key, std::move(entry));
+}
+
+void ModuleCache::clear()
+{
+    unique_lock<shared_mutex> lock(this->mutex);
+    this->entries.clear();
+}
+
+size_t ModuleCache::size() const
+{
+    shared_lock<shared_mutex> lock(this->mutex);
+    return this->entries.size();
+}
+
+size_t ModuleCache::hits() const
+{
+    return this->hit_count.load();
+}
+
+size_t ModuleCache::misses() const
+{
+    return this->miss_count.load();
+}
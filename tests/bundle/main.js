@@ -0,0 +1,4 @@
+import { value } from './dep.js';
+import { add } from 'ejr:math';
+
+globalThis.fromModule = add(value, square(2));
@@ -0,0 +1,5 @@
+function square(x) {
+    return x * x;
+}
+globalThis.squareSource = square.toString();
+square(7);
@@ -0,0 +1,69 @@
+#include <stdio.h>
+#include <string.h>
+#include "ejr.h"
+
+JSArg* js_sum(JSArg** args, size_t argc, void* opaque) {
+    int sum = 0;
+    for (size_t i = 0; i < args[0]->value.c_array_val.count; i++) {
+        sum += args[0]->value.c_array_val.items[i]->value.int_val;
+    }
+    return jsarg_int(sum);
+}
+
+// Calls back into JS while holding its own array argument.
+JSArg* js_outer(JSArg** args, size_t argc, void* opaque) {
+    EasyJSRHandle* ejr = (EasyJSRHandle*)opaque;
+    JSArg* array = args[0];
+
+    int value = ejr_eval_function(ejr, "inner", jsarg_make_list(0), 0);
+    JSArg* inner = jsarg_from_jsvalue(ejr, value);
+
+    // The nested call must not have reused our args.
+    int result = inner->value.int_val * 100 + array->value.c_array_val.items[1]->value.int_val;
+    jsarg_free(inner);
+    return jsarg_int(result);
+}
+
+int main() {
+    EasyJSRHandle* ejr = ejr_new();
+    ejr_register_callback(ejr, "sum", js_sum, NULL);
+    ejr_register_callback(ejr, "outer", js_outer, ejr);
+    ejr_free_jsvalue(ejr, ejr_eval_script(ejr,
+        "function f(a, s) { return a.length + a[2] + s; }"
+        "function inner() { return sum([1, 2, 3, 4]); }", "<test>"));
+
+    // Small blocks so the arena has to grow.
+    EJRArena* arena = ejr_arena_new(64);
+
+    for (int round = 0; round < 100; round++) {
+        JSArg** list = jsarg_make_list(2);
+        JSArg* array = jsarg_carray_in(arena, 3);
+        jsarg_add_value_to_c_array(array, jsarg_int_in(arena, round));
+        jsarg_add_value_to_c_array(array, jsarg_str_in(arena, "some longer string"));
+        jsarg_add_value_to_c_array(array, jsarg_int_in(arena, 7));
+        jsarg_add_to_list(list, array, 0);
+        jsarg_add_to_list(list, jsarg_str_in(arena, "x"), 1);
+
+        // Frees the list, the arena args are left alone.
+        int value = ejr_eval_function(ejr, "f", list, 2);
+        char* str = ejr_val_to_string(ejr, value);
+        if (str == NULL || strcmp(str, "10x") != 0) {
+            return 1;
+        }
+        ejr_free_string(str);
+        ejr_free_jsvalue(ejr, value);
+
+        ejr_arena_reset(arena);
+    }
+
+    int value = ejr_eval_script(ejr, "outer([5, 6, 7])", "<test>");
+    JSArg* val = jsarg_from_jsvalue(ejr, value);
+    if (val->type != JSARG_TYPE_INT || val->value.int_val != 1006) {
+        return 2;
+    }
+
+    jsarg_free(val);
+    ejr_arena_free(arena);
+    ejr_free(ejr);
+    return 0;
+}
@@ -0,0 +1,41 @@
+#include <stdio.h>
+#include "ejr.h"
+
+JSArg* js_fill(JSArg** args, size_t argc, void* opaque) {
+    if (argc != 1 || args[0]->type != JSARG_TYPE_ARRAY_VIEW) {
+        return jsarg_int(-1);
+    }
+    if (args[0]->value.array_view_val.element_type != JSARG_TYPED_ARRAY_UINT8) {
+        return jsarg_int(-2);
+    }
+
+    // Write straight into the JS buffer
+    uint8_t* items = (uint8_t*)args[0]->value.array_view_val.items;
+    for (size_t i = 0; i < args[0]->value.array_view_val.count; i++) {
+        items[i] = 7;
+    }
+
+    return jsarg_int((int)args[0]->value.array_view_val.count);
+}
+
+int main() {
+    EasyJSRHandle* ejr = ejr_new();
+    ejr_register_callback_borrowed(ejr, "fill", js_fill, NULL);
+
+    char* script = "let a = new Uint8Array(16); let n = fill(a.subarray(4)); n * 1000 + a[3] * 100 + a[4] * 10 + a[15]";
+    int value = ejr_eval_script(ejr, script, "<test>");
+
+    if (value == -1) {
+        return 1;
+    }
+
+    JSArg* val = jsarg_from_jsvalue(ejr, value);
+    if (val->type != JSARG_TYPE_INT || val->value.int_val != 12077) {
+        printf("%s\n", jsarg_to_string(val));
+        return 2;
+    }
+
+    jsarg_free(val);
+    ejr_free(ejr);
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ejr.h"
+#include "test_bundle.h"
+#include "test_bundle_stripped.h"
+
+JSArg* js_add(JSArg** args, size_t argc, void* opaque) {
+    return jsarg_int(args[0]->value.int_val + args[1]->value.int_val);
+}
+
+int global_int(EasyJSRHandle* ejr, const char* name) {
+    JSArg* arg = jsarg_from_jsvalue(ejr, ejr_get_from_global(ejr, name));
+    int result = arg->type == JSARG_TYPE_INT ? arg->value.int_val : -1;
+    jsarg_free(arg);
+    return result;
+}
+
+bool source_kept(EasyJSRHandle* ejr) {
+    JSArg* arg = jsarg_from_jsvalue(ejr, ejr_eval_script(ejr, "squareSource.includes('x * x')", "<test>"));
+    bool kept = arg->type == JSARG_TYPE_BOOL && arg->value.bool_val;
+    jsarg_free(arg);
+    return kept;
+}
+
+int main() {
+    EasyJSRHandle* ejr = ejr_new();
+    JSMethod methods[1];
+    methods[0].cb = js_add;
+    methods[0].name = "add";
+    methods[0].opaque = NULL;
+    ejr_register_module(ejr, "ejr:math", methods, 1);
+
+    // The script runs first, then the module, which imports a module compiled into the bundle and a native one.
+    int value = ejr_eval_bytecode(ejr, test_bundle, test_bundle_size, true);
+    JSArg* result = jsarg_from_jsvalue(ejr, value);
+    if (result->type == JSARG_TYPE_EXCEPTION) {
+        return 1;
+    }
+    jsarg_free(result);
+    if (global_int(ejr, "fromModule") != 9 || !source_kept(ejr)) {
+        return 2;
+    }
+
+    // The result of a script is its last value.
+    EasyJSRHandle* stripped = ejr_new();
+    result = jsarg_from_jsvalue(stripped, ejr_eval_bytecode(stripped, test_bundle_stripped, test_bundle_stripped_size, false));
+    if (result->type != JSARG_TYPE_INT || result->value.int_val != 49) {
+        return 3;
+    }
+    jsarg_free(result);
+    if (source_kept(stripped)) {
+        return 4;
+    }
+
+    // A copy, freed right after.
+    uint8_t* copy = (uint8_t*)malloc(test_bundle_stripped_size);
+    memcpy(copy, test_bundle_stripped, test_bundle_stripped_size);
+    ejr_free_jsvalue(stripped, ejr_eval_bytecode(stripped, copy, test_bundle_stripped_size, false));
+    free(copy);
+
+    // Anything else is rejected.
+    result = jsarg_from_jsvalue(stripped, ejr_eval_bytecode(stripped, (const uint8_t*)"not a bundle", 12, false));
+    if (result->type != JSARG_TYPE_EXCEPTION) {
+        return 5;
+    }
+    jsarg_free(result);
+    result = jsarg_from_jsvalue(stripped, ejr_eval_bytecode(stripped, test_bundle, test_bundle_size / 2, false));
+    if (result->type != JSARG_TYPE_EXCEPTION) {
+        return 6;
+    }
+    jsarg_free(result);
+
+    ejr_free(stripped);
+    ejr_free(ejr);
+    return 0;
+}
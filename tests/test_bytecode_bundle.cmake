@@ -0,0 +1,8 @@
+# The bundles test_bytecode_bundle.c includes, compiled by ejrc.
+ejr_compile_js(${CMAKE_CURRENT_BINARY_DIR}/test_bundle.h HEADER test_bundle
+    SCRIPTS tests/bundle/script.js MODULES tests/bundle/main.js)
+ejr_compile_js(${CMAKE_CURRENT_BINARY_DIR}/test_bundle_stripped.h HEADER test_bundle_stripped STRIP
+    SCRIPTS tests/bundle/script.js)
+target_sources(libejr_test_bytecode_bundle PRIVATE
+    ${CMAKE_CURRENT_BINARY_DIR}/test_bundle.h ${CMAKE_CURRENT_BINARY_DIR}/test_bundle_stripped.h)
+target_include_directories(libejr_test_bytecode_bundle PRIVATE ${CMAKE_CURRENT_BINARY_DIR})
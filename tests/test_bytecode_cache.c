@@ -0,0 +1,138 @@
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "ejr.h"
+
+static const char* SCRIPT = "function square(x) { return x * x; } square(7);";
+static const char* MODULE = "import { value } from 'dep'; globalThis.fromModule = value;";
+
+static bool dep_missing = false;
+static int dep_loads = 0;
+
+// ejr_set_file_loader copies what the loader returns and never frees it, so static strings are fine.
+// An empty string means the file could not be loaded.
+char* load_dep(const char* file_path, void* opaque) {
+    static char source[] = "export const value = 5;";
+    static char missing[] = "";
+    dep_loads++;
+    return dep_missing ? missing : source;
+}
+
+int eval_int(EasyJSRHandle* ejr, const char* js) {
+    JSArg* arg = jsarg_from_jsvalue(ejr, ejr_eval_script(ejr, js, "<test>"));
+    int result = arg->type == JSARG_TYPE_INT ? arg->value.int_val : -1;
+    jsarg_free(arg);
+    return result;
+}
+
+int global_int(EasyJSRHandle* ejr, const char* name) {
+    JSArg* arg = jsarg_from_jsvalue(ejr, ejr_get_from_global(ejr, name));
+    int result = arg->type == JSARG_TYPE_INT ? arg->value.int_val : -1;
+    jsarg_free(arg);
+    return result;
+}
+
+bool stats_are(EasyJSRHandle* ejr, size_t hits, size_t misses) {
+    size_t h, m;
+    return ejr_bytecode_cache_stats(ejr, &h, &m) && h == hits && m == misses;
+}
+
+// Call fn on every file in the directory.
+void for_each_file(const char* dir, void (*fn)(const char* path)) {
+    DIR* d = opendir(dir);
+    struct dirent* entry;
+    while ((entry = readdir(d))) {
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+        char path[512];
+        snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+        fn(path);
+    }
+    closedir(d);
+}
+
+void damage(const char* path) {
+    FILE* file = fopen(path, "r+b");
+    fseek(file, 24, SEEK_SET);
+    fputs("garbage", file);
+    fclose(file);
+}
+
+void remove_file(const char* path) {
+    remove(path);
+}
+
+EasyJSRHandle* new_cached(const char* dir) {
+    EasyJSRHandle* ejr = ejr_new();
+    ejr_set_bytecode_cache(ejr, dir);
+    ejr_set_file_loader(ejr, load_dep, NULL);
+    return ejr;
+}
+
+int main() {
+    char dir[] = "/tmp/ejr_bytecode_XXXXXX";
+    if (!mkdtemp(dir)) {
+        return 1;
+    }
+
+    // First runtime compiles and stores.
+    EasyJSRHandle* first = new_cached(dir);
+    if (eval_int(first, SCRIPT) != 49 || !stats_are(first, 0, 1)) {
+        return 2;
+    }
+    ejr_free_jsvalue(first, ejr_eval_module(first, MODULE, "main.js"));
+    if (global_int(first, "fromModule") != 5) {
+        return 3;
+    }
+
+    // A new runtime loads both from disk.
+    EasyJSRHandle* second = new_cached(dir);
+    if (eval_int(second, SCRIPT) != 49 || !stats_are(second, 1, 0)) {
+        return 4;
+    }
+    ejr_free_jsvalue(second, ejr_eval_module(second, MODULE, "main.js"));
+    if (global_int(second, "fromModule") != 5 || !stats_are(second, 2, 0)) {
+        return 5;
+    }
+
+    // Changed source compiles again.
+    if (eval_int(second, "function square(x) { return x * x; } square(8);") != 64 || !stats_are(second, 2, 1)) {
+        return 6;
+    }
+
+    // A cached module whose import is gone fails once, without compiling again.
+    dep_missing = true;
+    dep_loads = 0;
+    EasyJSRHandle* missing = new_cached(dir);
+    JSArg* failed = jsarg_from_jsvalue(missing, ejr_eval_module(missing, MODULE, "main.js"));
+    if (failed->type != JSARG_TYPE_EXCEPTION || dep_loads != 1 || !stats_are(missing, 0, 1)) {
+        return 9;
+    }
+    jsarg_free(failed);
+    ejr_free(missing);
+    dep_missing = false;
+
+    // Damaged files fall back to compiling, and count as misses.
+    for_each_file(dir, damage);
+    EasyJSRHandle* third = new_cached(dir);
+    if (eval_int(third, SCRIPT) != 49 || !stats_are(third, 0, 1)) {
+        return 7;
+    }
+
+    // Errors still surface.
+    JSArg* error = jsarg_from_jsvalue(third, ejr_eval_script(third, "function (", "<test>"));
+    if (error->type != JSARG_TYPE_EXCEPTION) {
+        return 8;
+    }
+    jsarg_free(error);
+
+    ejr_free(first);
+    ejr_free(second);
+    ejr_free(third);
+    for_each_file(dir, remove_file);
+    rmdir(dir);
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "ejr.h"
+
+#define ROWS 100
+
+int main() {
+    EasyJSRHandle* ejr = ejr_new();
+    ejr_free_jsvalue(ejr, ejr_eval_script(ejr,
+        "function score(count, weight) { return count * weight; }"
+        "function same(x) { return x; }"
+        "function label(name, count) { if (count < 0) throw new Error('negative'); return name + count; }", "<test>"));
+
+    EJRPreparedFunction* score = ejr_prepare_function(ejr, "score");
+    EJRPreparedFunction* label = ejr_prepare_function(ejr, "label");
+    if (score == NULL || label == NULL) {
+        return 1;
+    }
+
+    int32_t counts[ROWS];
+    double weights[ROWS];
+    double scores[ROWS];
+    for (int i = 0; i < ROWS; i++) {
+        counts[i] = i;
+        weights[i] = 0.5;
+    }
+
+    // Typed columns into a typed output.
+    JSArg columns[2];
+    memset(columns, 0, sizeof(columns));
+    columns[0].type = JSARG_TYPE_INT32_ARRAY;
+    columns[0].value.i32_array_val.items = counts;
+    columns[0].value.i32_array_val.count = ROWS;
+    columns[1].type = JSARG_TYPE_ARRAY_VIEW;
+    columns[1].value.array_view_val.items = weights;
+    columns[1].value.array_view_val.count = ROWS;
+    columns[1].value.array_view_val.element_type = JSARG_TYPED_ARRAY_FLOAT64;
+
+    JSArg out;
+    memset(&out, 0, sizeof(out));
+    out.type = JSARG_TYPE_ARRAY_VIEW;
+    out.value.array_view_val.items = scores;
+    out.value.array_view_val.count = ROWS;
+    out.value.array_view_val.element_type = JSARG_TYPED_ARRAY_FLOAT64;
+
+    if (ejr_call_prepared_batch(ejr, score, columns, 2, &out) != ROWS) {
+        return 2;
+    }
+    for (int i = 0; i < ROWS; i++) {
+        if (scores[i] != i * 0.5) {
+            return 3;
+        }
+    }
+
+    // Columns must line up.
+    columns[1].value.array_view_val.count = ROWS - 1;
+    if (ejr_call_prepared_batch(ejr, score, columns, 2, &out) != -1) {
+        return 4;
+    }
+
+    // A string column into a list of results.
+    JSArg* names = jsarg_carray(3);
+    jsarg_add_value_to_c_array(names, jsarg_str("a"));
+    jsarg_add_value_to_c_array(names, jsarg_str("b"));
+    jsarg_add_value_to_c_array(names, jsarg_str("c"));
+    int32_t label_counts[3] = {1, 2, -1};
+
+    columns[0] = *names;
+    columns[1].type = JSARG_TYPE_INT32_ARRAY;
+    columns[1].value.i32_array_val.items = label_counts;
+    columns[1].value.i32_array_val.count = 3;
+
+    JSArg* labels = jsarg_carray(3);
+
+    // The third row throws.
+    if (ejr_call_prepared_batch(ejr, label, columns, 2, labels) != 2) {
+        return 5;
+    }
+    JSArg** results = labels->value.c_array_val.items;
+    if (results[0]->type != JSARG_TYPE_STRING || strcmp(results[0]->value.str_val, "a1") != 0) {
+        return 6;
+    }
+    if (results[1]->type != JSARG_TYPE_STRING || strcmp(results[1]->value.str_val, "b2") != 0) {
+        return 7;
+    }
+    if (labels->value.c_array_val.count != 3 || results[2]->type != JSARG_TYPE_EXCEPTION || strcmp(results[2]->value.exception_val.msg, "Error: negative") != 0) {
+        return 8;
+    }
+
+    jsarg_free(labels);
+    jsarg_free(names);
+
+    // Clamped output converts like Uint8ClampedArray.
+    EJRPreparedFunction* same = ejr_prepare_function(ejr, "same");
+    double inputs[8] = {-3, 0.5, 1.5, 2.5, 254.5, 4294967301.0, 300, NAN};
+    uint8_t expected[8] = {0, 0, 2, 2, 254, 255, 255, 0};
+    uint8_t clamped[8];
+    columns[0].type = JSARG_TYPE_ARRAY_VIEW;
+    columns[0].value.array_view_val.items = inputs;
+    columns[0].value.array_view_val.count = 8;
+    columns[0].value.array_view_val.element_type = JSARG_TYPED_ARRAY_FLOAT64;
+    out.value.array_view_val.items = clamped;
+    out.value.array_view_val.count = 8;
+    out.value.array_view_val.element_type = JSARG_TYPED_ARRAY_UINT8C;
+    if (ejr_call_prepared_batch(ejr, same, columns, 1, &out) != 8 || memcmp(clamped, expected, sizeof(expected)) != 0) {
+        return 9;
+    }
+    ejr_free_prepared(ejr, same);
+
+    ejr_free_prepared(ejr, score);
+    ejr_free_prepared(ejr, label);
+    ejr_free(ejr);
+    return 0;
+}
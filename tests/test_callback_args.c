@@ -0,0 +1,68 @@
+#include <stdio.h>
+#include <string.h>
+#include "ejr.h"
+
+// Checks the type of every argument and returns a array of them.
+JSArg* js_types(JSArg** args, size_t argc, void* opaque) {
+    JSArg* result = jsarg_carray(argc);
+    for (size_t i = 0; i < argc; i++) {
+        jsarg_add_value_to_c_array(result, jsarg_int((int)args[i]->type));
+    }
+    return result;
+}
+
+JSArg* js_concat(JSArg** args, size_t argc, void* opaque) {
+    char buffer[256] = "";
+    for (size_t i = 0; i < argc; i++) {
+        if (args[i]->type == JSARG_TYPE_STRING) {
+            strncat(buffer, args[i]->value.str_val, sizeof(buffer) - strlen(buffer) - 1);
+        }
+    }
+    return jsarg_str(buffer);
+}
+
+JSArg* js_sum_array(JSArg** args, size_t argc, void* opaque) {
+    if (argc != 1 || args[0]->type != JSARG_TYPE_C_ARRAY) {
+        return jsarg_int(-1);
+    }
+    int sum = 0;
+    for (size_t i = 0; i < args[0]->value.c_array_val.count; i++) {
+        sum += args[0]->value.c_array_val.items[i]->value.int_val;
+    }
+    return jsarg_int(sum);
+}
+
+JSArg* js_nothing(JSArg** args, size_t argc, void* opaque) {
+    return NULL;
+}
+
+int main() {
+    EasyJSRHandle* ejr = ejr_new();
+    ejr_register_callback(ejr, "types", js_types, NULL);
+    ejr_register_callback(ejr, "concat", js_concat, NULL);
+    ejr_register_callback(ejr, "sum_array", js_sum_array, NULL);
+    ejr_register_callback(ejr, "nothing", js_nothing, NULL);
+
+    const char* script =
+        "let t = types(1, 2.5, true, 'a', 5n, [1], null);"
+        "let c = concat('a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'x'.repeat(20));"
+        "[t.join(','), c, sum_array([1, 2, 3]), nothing()].join('|')";
+    int value = ejr_eval_script(ejr, script, "<test>");
+
+    if (value == -1) {
+        return 1;
+    }
+
+    JSArg* val = jsarg_from_jsvalue(ejr, value);
+    if (val->type != JSARG_TYPE_STRING) {
+        return 2;
+    }
+    if (strcmp(val->value.str_val, "0,1,4,2,5,7,2|abcdefghijxxxxxxxxxxxxxxxxxxxx|6|") != 0) {
+        printf("%s\n", val->value.str_val);
+        return 3;
+    }
+
+    jsarg_free(val);
+    ejr_free(ejr);
+    return 0;
+}
@@ -0,0 +1,130 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ejr.h"
+
+typedef struct {
+    int count;
+} Counter;
+
+static int alive = 0;
+
+void* counter_new(JSArg** args, size_t arg_count, void* opaque) {
+    if (arg_count < 1 || args[0]->type != JSARG_TYPE_INT) {
+        return NULL;
+    }
+    Counter* counter = malloc(sizeof(Counter));
+    counter->count = args[0]->value.int_val;
+    alive++;
+    return counter;
+}
+
+void counter_free(void* native, void* opaque) {
+    alive--;
+    free(native);
+}
+
+JSArg* counter_add(void* native, JSArg** args, size_t arg_count, void* opaque) {
+    Counter* counter = native;
+    counter->count += args[0]->value.int_val;
+    return jsarg_int(counter->count);
+}
+
+JSArg* counter_get(void* native, JSArg** args, size_t arg_count, void* opaque) {
+    return jsarg_int(((Counter*)native)->count);
+}
+
+JSArg* counter_set(void* native, JSArg** args, size_t arg_count, void* opaque) {
+    ((Counter*)native)->count = args[0]->value.int_val;
+    return NULL;
+}
+
+int main() {
+    EasyJSRHandle* ejr = ejr_new();
+
+    EJRClass* cls = ejr_register_class(ejr, "Counter", counter_new, counter_free, NULL);
+    if (cls == NULL) {
+        return 1;
+    }
+    ejr_class_add_method(ejr, cls, "add", counter_add, NULL);
+    ejr_class_add_property(ejr, cls, "value", counter_get, counter_set, NULL);
+
+    int value = ejr_eval_script(ejr,
+        "let c = new Counter(5);"
+        "c.add(2);"
+        "c.value = c.value * 10;"
+        "let s = c.value + ' ' + (c instanceof Counter);"
+        "try { new Counter('x'); } catch (e) { s += ' threw'; }"
+        "try { Counter.prototype.add.call({}, 1); } catch (e) { s += ' ' + e.constructor.name; }"
+        "for (let i = 0; i < 100; i++) new Counter(i);"
+        "s", "<test>");
+    char* str = ejr_val_to_string(ejr, value);
+    if (str == NULL || strcmp(str, "70 true threw TypeError") != 0) {
+        return 2;
+    }
+    ejr_free_string(str);
+
+    // Calling the constructor without new throws, whatever this is.
+    int calls = ejr_eval_script(ejr,
+        "let thrown = 0;"
+        "try { Counter(1); } catch (e) { thrown++; }"
+        "try { Counter.call(Map, 1); } catch (e) { thrown++; }"
+        "try { Reflect.apply(Counter, Map, [1]); } catch (e) { thrown++; }"
+        "thrown + ' ' + Object.getPrototypeOf(Reflect.construct(Counter, [1], Map)).constructor.name", "<test>");
+    str = ejr_val_to_string(ejr, calls);
+    if (str == NULL || strcmp(str, "3 Map") != 0) {
+        return 9;
+    }
+    ejr_free_string(str);
+
+    // Native objects made in C
+    Counter* native = malloc(sizeof(Counter));
+    native->count = 3;
+    alive++;
+    int object = ejr_new_object(ejr, cls, native);
+    if (ejr_get_object(ejr, cls, object) != native) {
+        return 3;
+    }
+    int other = ejr_get_from_global(ejr, "Counter");
+    if (ejr_get_object(ejr, cls, other) != NULL) {
+        return 4;
+    }
+    ejr_free_jsvalue(ejr, other);
+
+    JSArg by;
+    memset(&by, 0, sizeof(by));
+    by.type = JSARG_TYPE_INT;
+    by.value.int_val = 4;
+    int result = ejr_eval_class_function_flat(ejr, object, "add", &by, 1);
+    JSArg* sum = jsarg_from_jsvalue(ejr, result);
+    if (sum->type != JSARG_TYPE_INT || sum->value.int_val != 7 || native->count != 7) {
+        return 5;
+    }
+    jsarg_free(sum);
+    ejr_free_jsvalue(ejr, object);
+
+    // Every native object is freed by the GC
+    ejr_free(ejr);
+    if (alive != 0) {
+        return 6;
+    }
+
+    // A class name keeps its class id, registering it again does not run out of ids.
+    EasyJSRHandle* again = ejr_new();
+    for (int i = 0; i < 70000; i++) {
+        if (ejr_register_class(again, "Point", NULL, NULL, NULL) == NULL) {
+            return 7;
+        }
+    }
+    if (ejr_register_class(again, "Line", NULL, NULL, NULL) == NULL) {
+        return 7;
+    }
+    int type = ejr_eval_script(again, "typeof Line", "<test>");
+    str = ejr_val_to_string(again, type);
+    if (str == NULL || strcmp(str, "function") != 0) {
+        return 8;
+    }
+    ejr_free_string(str);
+    ejr_free(again);
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include "ejr.h"
+
+JSArg* js_add(JSArg** args, size_t argc, void* opaque) {
+    return jsarg_int(args[0]->value.int_val + args[1]->value.int_val);
+}
+
+JSArg* js_count(JSArg** args, size_t argc, void* opaque) {
+    return jsarg_int(++*(int*)opaque);
+}
+
+int eval_int(EasyJSRHandle* ejr, const char* js) {
+    JSArg* arg = jsarg_from_jsvalue(ejr, ejr_eval_script(ejr, js, "<test>"));
+    int result = arg->type == JSARG_TYPE_INT ? arg->value.int_val : -1;
+    jsarg_free(arg);
+    return result;
+}
+
+void* prewarm_in_thread(void* tmpl) {
+    ejr_template_prewarm((EJRContextTemplate*)tmpl, 4);
+    return NULL;
+}
+
+int main() {
+    int calls = 0;
+    EJRContextTemplate* tmpl = ejr_template_new();
+    ejr_template_set_intrinsics(tmpl, EJR_INTRINSIC_ALL & ~EJR_INTRINSIC_DATE);
+    ejr_template_register_callback(tmpl, "count", js_count, &calls);
+
+    JSMethod methods[1];
+    methods[0].cb = js_add;
+    methods[0].name = "add";
+    methods[0].opaque = NULL;
+    ejr_template_register_module(tmpl, "ejr:math", methods, 1);
+
+    // The prelude can use everything registered before it.
+    if (!ejr_template_add_prelude(tmpl, "globalThis.app = { start: count() };", "prelude.js", false) ||
+        !ejr_template_add_prelude(tmpl, "import { add } from 'ejr:math'; globalThis.app.sum = add(2, 3);", "prelude_module.js", true)) {
+        return 1;
+    }
+    // Run when added, to check them.
+    if (calls == 0) {
+        return 2;
+    }
+
+    // Broken preludes are rejected.
+    if (ejr_template_add_prelude(tmpl, "function (", "broken.js", false) || strlen(ejr_template_error(tmpl)) == 0) {
+        return 3;
+    }
+    if (ejr_template_add_prelude(tmpl, "throw new Error('nope');", "throws.js", false) || !strstr(ejr_template_error(tmpl), "nope")) {
+        return 4;
+    }
+
+    EasyJSRHandle* a = ejr_new_from_template(tmpl);
+    EasyJSRHandle* b = ejr_new_from_template(tmpl);
+    if (eval_int(a, "app.sum") != 5 || eval_int(b, "app.start") != eval_int(a, "app.start") + 1) {
+        return 5;
+    }
+    // Left out built-ins are missing.
+    if (eval_int(a, "typeof Date === 'undefined' && typeof Map === 'function' ? 1 : 0") != 1) {
+        return 6;
+    }
+    // Every runtime is isolated.
+    ejr_free_jsvalue(a, ejr_eval_script(a, "app.sum = 100;", "<test>"));
+    if (eval_int(b, "app.sum") != 5) {
+        return 7;
+    }
+
+    // Runtimes made ahead of time on another thread.
+    pthread_t thread;
+    pthread_create(&thread, NULL, prewarm_in_thread, tmpl);
+    pthread_join(thread, NULL);
+    for (int i = 0; i < 6; i++) {
+        EasyJSRHandle* warm = ejr_new_from_template(tmpl);
+        if (eval_int(warm, "count() > 0 && app.sum === 5 ? 1 : 0") != 1) {
+            return 8;
+        }
+        ejr_free(warm);
+    }
+
+    // Runtimes outlive their template.
+    ejr_template_free(tmpl);
+    if (eval_int(a, "count() > 0 ? 1 : 0") != 1) {
+        return 9;
+    }
+
+    ejr_free(a);
+    ejr_free(b);
+    return 0;
+}
@@ -0,0 +1,50 @@
+#include <stdio.h>
+#include <string.h>
+#include "ejr.h"
+
+int main() {
+    EasyJSRHandle* ejr = ejr_new();
+    ejr_free_jsvalue(ejr, ejr_eval_script(ejr,
+        "function add(a, b) { return a + b; }"
+        "var counter = { n: 0, bump(by, label) { this.n += by; return label + this.n; } };", "<test>"));
+
+    // One argument buffer, reused for every call.
+    JSArg args[2];
+    memset(args, 0, sizeof(args));
+    args[0].type = JSARG_TYPE_INT;
+    args[1].type = JSARG_TYPE_INT;
+
+    int total = 0;
+    for (int i = 0; i < 1000; i++) {
+        args[0].value.int_val = i;
+        args[1].value.int_val = 1;
+
+        int value = ejr_eval_function_flat(ejr, "add", args, 2);
+        JSArg* result = jsarg_from_jsvalue(ejr, value);
+        if (result->type != JSARG_TYPE_INT) {
+            return 1;
+        }
+        total += result->value.int_val;
+        jsarg_free(result);
+    }
+    if (total != 500500) {
+        return 2;
+    }
+
+    int counter = ejr_get_from_global(ejr, "counter");
+    args[0].type = JSARG_TYPE_INT;
+    args[0].value.int_val = 5;
+    args[1].type = JSARG_TYPE_STRING;
+    args[1].value.str_val = "n=";
+
+    int value = ejr_eval_class_function_flat(ejr, counter, "bump", args, 2);
+    value = ejr_eval_class_function_flat(ejr, counter, "bump", args, 2);
+    char* str = ejr_val_to_string(ejr, value);
+    if (str == NULL || strcmp(str, "n=10") != 0) {
+        return 3;
+    }
+
+    ejr_free_string(str);
+    ejr_free(ejr);
+    return 0;
+}
@@ -0,0 +1,65 @@
+#include <stdio.h>
+#include <string.h>
+#include "ejr.h"
+
+int main() {
+    EasyJSRHandle* ejr = ejr_new();
+    ejr_free_jsvalue(ejr, ejr_eval_script(ejr,
+        "var result = { id: 7, score: 2.5, ok: true, label: 'best', get broken() { throw new Error('nope'); } };", "<test>"));
+
+    const char* names[5] = { "id", "score", "ok", "label", "broken" };
+    EJRKey* keys[5];
+    for (int i = 0; i < 5; i++) {
+        keys[i] = ejr_intern_key(ejr, names[i]);
+    }
+
+    int result = ejr_get_from_global(ejr, "result");
+
+    // Heap values, released one by one.
+    JSArg out[5];
+    if (ejr_get_properties(ejr, result, (const EJRKey* const*)keys, 5, out, NULL) != 5) {
+        return 1;
+    }
+    if (out[0].type != JSARG_TYPE_INT || out[0].value.int_val != 7) {
+        return 2;
+    }
+    if (out[1].type != JSARG_TYPE_DOUBLE || out[1].value.double_val != 2.5) {
+        return 3;
+    }
+    if (out[2].type != JSARG_TYPE_BOOL || !out[2].value.bool_val) {
+        return 4;
+    }
+    if (out[3].type != JSARG_TYPE_STRING || strcmp(out[3].value.str_val, "best") != 0) {
+        return 5;
+    }
+    if (out[4].type != JSARG_TYPE_EXCEPTION) {
+        return 6;
+    }
+    for (int i = 0; i < 5; i++) {
+        jsarg_free_value(&out[i]);
+    }
+
+    // Arena values, released with the arena.
+    EJRArena* arena = ejr_arena_new(0);
+    for (int round = 0; round < 100; round++) {
+        if (ejr_get_properties(ejr, result, (const EJRKey* const*)keys, 4, out, arena) != 4) {
+            return 7;
+        }
+        if (out[3].type != JSARG_TYPE_STRING || strcmp(out[3].value.str_val, "best") != 0) {
+            return 8;
+        }
+        ejr_arena_reset(arena);
+    }
+    ejr_arena_free(arena);
+
+    // Not a object
+    int number = ejr_get_property_by_key(ejr, result, keys[0]);
+    if (ejr_get_properties(ejr, number, (const EJRKey* const*)keys, 1, out, NULL) != -1) {
+        return 9;
+    }
+    ejr_free_jsvalue(ejr, number);
+
+    ejr_free_jsvalue(ejr, result);
+    ejr_free(ejr);
+    return 0;
+}
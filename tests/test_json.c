@@ -0,0 +1,103 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ejr.h"
+
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+} Buffer;
+
+// Appends to a growable buffer.
+bool append(const char* data, size_t length, void* opaque) {
+    Buffer* buffer = (Buffer*)opaque;
+    if (buffer->length + length + 1 > buffer->capacity) {
+        size_t capacity = (buffer->length + length + 1) * 2;
+        char* grown = (char*)realloc(buffer->data, capacity);
+        if (!grown) {
+            return false;
+        }
+        buffer->data = grown;
+        buffer->capacity = capacity;
+    }
+    memcpy(buffer->data + buffer->length, data, length);
+    buffer->length += length;
+    buffer->data[buffer->length] = '\0';
+    return true;
+}
+
+bool refuse(const char* data, size_t length, void* opaque) {
+    return false;
+}
+
+int main() {
+    EasyJSRHandle* ejr = ejr_new();
+
+    const char* json = "{\"id\":7,\"tags\":[\"a\",\"b\"],\"name\":\"caf\xc3\xa9\"}";
+    int doc = ejr_parse_json(ejr, json, strlen(json));
+    if (doc < 0) {
+        return 1;
+    }
+
+    int id = ejr_get_property_from(ejr, doc, "id");
+    JSArg* id_arg = jsarg_from_jsvalue(ejr, id);
+    if (id_arg->type != JSARG_TYPE_INT || id_arg->value.int_val != 7) {
+        return 2;
+    }
+    jsarg_free(id_arg);
+
+    // Round trip through a growable buffer, non ASCII included.
+    Buffer buffer = { NULL, 0, 0 };
+    if (!ejr_json_stringify(ejr, doc, append, &buffer)) {
+        return 3;
+    }
+    if (buffer.length != strlen(json) || strcmp(buffer.data, json) != 0) {
+        return 4;
+    }
+
+    // Reusing the buffer appends.
+    ejr_free_jsvalue(ejr, ejr_eval_script(ejr, "var list = [1, 2, 3];", "<test>"));
+    int list = ejr_get_from_global(ejr, "list");
+    buffer.length = 0;
+    if (!ejr_json_stringify(ejr, list, append, &buffer) || strcmp(buffer.data, "[1,2,3]") != 0) {
+        return 5;
+    }
+
+    // The sink can fail the call.
+    if (ejr_json_stringify(ejr, list, refuse, NULL)) {
+        return 6;
+    }
+
+    // Invalid JSON is a exception.
+    const char* broken = "{\"id\": }";
+    JSArg* broken_arg = jsarg_from_jsvalue(ejr, ejr_parse_json(ejr, broken, strlen(broken)));
+    if (broken_arg->type != JSARG_TYPE_EXCEPTION) {
+        return 7;
+    }
+    jsarg_free(broken_arg);
+
+    // Cycles and values without a JSON form fail, and leave no exception behind.
+    ejr_free_jsvalue(ejr, ejr_eval_script(ejr, "var cycle = {}; cycle.self = cycle;", "<test>"));
+    int cycle = ejr_get_from_global(ejr, "cycle");
+    if (ejr_json_stringify(ejr, cycle, append, &buffer)) {
+        return 8;
+    }
+    int undef = ejr_get_from_global(ejr, "missing");
+    if (ejr_json_stringify(ejr, undef, append, &buffer)) {
+        return 9;
+    }
+    JSArg* after = jsarg_from_jsvalue(ejr, ejr_eval_script(ejr, "1 + 1", "<test>"));
+    if (after->type != JSARG_TYPE_INT || after->value.int_val != 2) {
+        return 10;
+    }
+    jsarg_free(after);
+
+    free(buffer.data);
+    ejr_free_jsvalue(ejr, undef);
+    ejr_free_jsvalue(ejr, cycle);
+    ejr_free_jsvalue(ejr, list);
+    ejr_free_jsvalue(ejr, doc);
+    ejr_free(ejr);
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "ejr.h"
+
+JSArg* js_add(JSArg** args, size_t argc, void* opaque) {
+    return jsarg_int(args[0]->value.int_val + args[1]->value.int_val);
+}
+
+char* load_other(const char* file_path, void* opaque) {
+    static char source[] = "export const value = 100;";
+    return source;
+}
+
+int global_int(EasyJSRHandle* ejr, const char* name) {
+    JSArg* arg = jsarg_from_jsvalue(ejr, ejr_get_from_global(ejr, name));
+    int result = arg->type == JSARG_TYPE_INT ? arg->value.int_val : -1;
+    jsarg_free(arg);
+    return result;
+}
+
+int main() {
+    EasyJSRHandle* ejr = ejr_new();
+    JSMethod methods[1];
+    methods[0].cb = js_add;
+    methods[0].name = "add";
+    methods[0].opaque = NULL;
+    ejr_register_module(ejr, "ejr:math", methods, 1);
+    ejr_set_file_loader(ejr, load_other, NULL);
+    ejr_free_jsvalue(ejr, ejr_eval_script(ejr, "function square(x) { return x * x; }", "<test>"));
+
+    if (!ejr_mount_bytecode_bundle(ejr, TEST_BUNDLE_PATH)) {
+        return 1;
+    }
+
+    // main.js and its import dep.js come from the bundle, not the file loader.
+    ejr_free_jsvalue(ejr, ejr_eval_module(ejr, "import 'tests/bundle/main.js';", "<test>"));
+    if (global_int(ejr, "fromModule") != 9) {
+        return 2;
+    }
+
+    // Anything else still goes to the file loader.
+    ejr_free_jsvalue(ejr, ejr_eval_module(ejr, "import { value } from 'other.js'; globalThis.other = value;", "<test>"));
+    if (global_int(ejr, "other") != 100) {
+        return 3;
+    }
+
+    // Files that are missing or not bundles are not mounted.
+    char path[] = "/tmp/ejr_not_a_bundle_XXXXXX";
+    int fd = mkstemp(path);
+    FILE* file = fdopen(fd, "w");
+    fputs("not a bundle", file);
+    fclose(file);
+    if (ejr_mount_bytecode_bundle(ejr, path) || ejr_mount_bytecode_bundle(ejr, "/tmp/ejr_missing_bundle.jsbc")) {
+        return 4;
+    }
+    remove(path);
+
+    // A script flagged as a module fails the import, it is not loaded as one.
+    FILE* script = fopen(TEST_SCRIPT_BUNDLE_PATH, "rb");
+    unsigned char bundle[4096];
+    size_t size = fread(bundle, 1, sizeof(bundle), script);
+    fclose(script);
+    // The flags of the first entry, right after the 16 byte header.
+    bundle[16] = 1;
+    char flagged[] = "/tmp/ejr_flagged_bundle_XXXXXX";
+    fd = mkstemp(flagged);
+    file = fdopen(fd, "wb");
+    fwrite(bundle, 1, size, file);
+    fclose(file);
+    if (!ejr_mount_bytecode_bundle(ejr, flagged)) {
+        return 5;
+    }
+    remove(flagged);
+    ejr_free_jsvalue(ejr, ejr_eval_module(ejr, "import 'tests/bundle/script.js'; globalThis.flagged = 1;", "<test>"));
+    if (global_int(ejr, "flagged") != -1) {
+        return 6;
+    }
+
+    ejr_free(ejr);
+    return 0;
+}
@@ -0,0 +1,8 @@
+# The bundle files test_mapped_bundle.c mounts, compiled by ejrc.
+ejr_compile_js(${CMAKE_CURRENT_BINARY_DIR}/test_mapped_bundle.jsbc MODULES tests/bundle/main.js tests/bundle/dep.js)
+ejr_compile_js(${CMAKE_CURRENT_BINARY_DIR}/test_mapped_script.jsbc SCRIPTS tests/bundle/script.js)
+target_sources(libejr_test_mapped_bundle PRIVATE
+    ${CMAKE_CURRENT_BINARY_DIR}/test_mapped_bundle.jsbc ${CMAKE_CURRENT_BINARY_DIR}/test_mapped_script.jsbc)
+target_compile_definitions(libejr_test_mapped_bundle PRIVATE
+    TEST_BUNDLE_PATH="${CMAKE_CURRENT_BINARY_DIR}/test_mapped_bundle.jsbc"
+    TEST_SCRIPT_BUNDLE_PATH="${CMAKE_CURRENT_BINARY_DIR}/test_mapped_script.jsbc")
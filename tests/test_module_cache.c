@@ -0,0 +1,79 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include "ejr.h"
+
+static const char* MODULE = "import { value } from 'lib.js'; globalThis.fromModule = value;";
+
+// Source of lib.js, changed to check that a new source compiles again.
+static char lib_source[64] = "export const value = 5;";
+
+char* load_lib(const char* file_path, void* opaque) {
+    return lib_source;
+}
+
+int import_value(bool cached) {
+    EasyJSRHandle* ejr = ejr_new();
+    ejr_set_file_loader(ejr, load_lib, NULL);
+    ejr_set_module_cache_enabled(ejr, cached);
+    ejr_free_jsvalue(ejr, ejr_eval_module(ejr, MODULE, "main.js"));
+
+    JSArg* arg = jsarg_from_jsvalue(ejr, ejr_get_from_global(ejr, "fromModule"));
+    int result = arg->type == JSARG_TYPE_INT ? arg->value.int_val : -1;
+    jsarg_free(arg);
+    ejr_free(ejr);
+    return result;
+}
+
+bool stats_are(size_t hits, size_t misses, size_t modules) {
+    size_t h, m, count;
+    return ejr_module_cache_stats(&h, &m, &count) && h == hits && m == misses && count == modules;
+}
+
+void* import_in_thread(void* result) {
+    *(int*)result = import_value(true);
+    return NULL;
+}
+
+int main() {
+    // The first runtime compiles, the next ones read its bytecode.
+    if (import_value(true) != 5 || !stats_are(0, 1, 1)) {
+        return 1;
+    }
+    if (import_value(true) != 5 || import_value(true) != 5 || !stats_are(2, 1, 1)) {
+        return 2;
+    }
+
+    // Turned off, the cache is not touched.
+    if (import_value(false) != 5 || !stats_are(2, 1, 1)) {
+        return 3;
+    }
+
+    // Changed source compiles again.
+    strcpy(lib_source, "export const value = 6;");
+    if (import_value(true) != 6 || !stats_are(2, 2, 2)) {
+        return 4;
+    }
+
+    // Many runtimes on many threads at once.
+    pthread_t threads[8];
+    int results[8];
+    for (int i = 0; i < 8; i++) {
+        pthread_create(&threads[i], NULL, import_in_thread, &results[i]);
+    }
+    for (int i = 0; i < 8; i++) {
+        pthread_join(threads[i], NULL);
+        if (results[i] != 6) {
+            return 5;
+        }
+    }
+    if (!stats_are(10, 2, 2)) {
+        return 6;
+    }
+
+    ejr_clear_module_cache();
+    if (!stats_are(10, 2, 0) || import_value(true) != 6 || !stats_are(10, 3, 1)) {
+        return 7;
+    }
+    return 0;
+}
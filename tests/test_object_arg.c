@@ -0,0 +1,90 @@
+#include <stdio.h>
+#include <string.h>
+#include "ejr.h"
+
+JSArg* make_point(JSArg** args, size_t arg_count, void* opaque) {
+    int i = args[0]->value.int_val;
+
+    JSArg* tags = jsarg_carray(2);
+    jsarg_add_value_to_c_array(tags, jsarg_int(i));
+    jsarg_add_value_to_c_array(tags, jsarg_str("point"));
+
+    JSArg* point = jsarg_object(4);
+    jsarg_add_entry_to_object(point, "x", jsarg_int(i));
+    jsarg_add_entry_to_object(point, "y", jsarg_double(i * 0.5));
+    jsarg_add_entry_to_object(point, "name", jsarg_str("p"));
+    jsarg_add_entry_to_object(point, "tags", tags);
+    return point;
+}
+
+JSArg* make_repeated(JSArg** args, size_t arg_count, void* opaque) {
+    JSArg* object = jsarg_object(2);
+    jsarg_add_entry_to_object(object, "a", jsarg_int(1));
+    jsarg_add_entry_to_object(object, "a", jsarg_int(2));
+    return object;
+}
+
+int eval_int(EasyJSRHandle* ejr, const char* js) {
+    int value = ejr_eval_script(ejr, js, "<test>");
+    JSArg* arg = jsarg_from_jsvalue(ejr, value);
+    int result = arg->type == JSARG_TYPE_INT ? arg->value.int_val : -1;
+    jsarg_free(arg);
+    return result;
+}
+
+int main() {
+    EasyJSRHandle* ejr = ejr_new();
+    ejr_register_callback(ejr, "make_point", make_point, NULL);
+    ejr_register_callback(ejr, "make_repeated", make_repeated, NULL);
+
+    // Same-shaped records from the cached template.
+    if (eval_int(ejr,
+        "var sum = 0;"
+        "for (let i = 0; i < 100; i++) {"
+        "  const p = make_point(i);"
+        "  if (Object.keys(p).join() !== 'x,y,name,tags' || p.name !== 'p' || p.tags[1] !== 'point') throw new Error('bad');"
+        "  sum += p.x + p.y * 2 + p.tags[0];"
+        "}"
+        "sum | 0;") != 3 * 4950) {
+        return 1;
+    }
+
+    // A record is a ordinary object, changing one leaves the others alone.
+    if (eval_int(ejr,
+        "var a = make_point(1), b = make_point(2);"
+        "a.extra = 5; delete a.y; b.x = 10;"
+        "(a.extra === 5 && a.y === undefined && b.extra === undefined && b.y === 1 && make_point(3).x === 3) ? 1 : 0;") != 1) {
+        return 2;
+    }
+
+    // A repeated key is set twice.
+    if (eval_int(ejr, "var r = make_repeated(); (Object.keys(r).length === 1 && r.a === 2) ? 1 : 0;") != 1) {
+        return 3;
+    }
+
+    // Objects as args, from a arena.
+    ejr_free_jsvalue(ejr, ejr_eval_script(ejr, "function describe(o) { return o.first + ':' + o.second.inner; }", "<test>"));
+    EJRArena* arena = ejr_arena_new(0);
+    JSArg* inner = jsarg_object_in(arena, 1);
+    jsarg_add_entry_to_object_in(arena, inner, "inner", jsarg_int_in(arena, 3));
+    JSArg* outer = jsarg_object_in(arena, 2);
+    jsarg_add_entry_to_object_in(arena, outer, "first", jsarg_str_in(arena, "one"));
+    jsarg_add_entry_to_object_in(arena, outer, "second", inner);
+
+    int described = ejr_eval_function_flat(ejr, "describe", outer, 1);
+    JSArg* described_arg = jsarg_from_jsvalue(ejr, described);
+    if (described_arg->type != JSARG_TYPE_STRING || strcmp(described_arg->value.str_val, "one:3") != 0) {
+        return 4;
+    }
+    jsarg_free(described_arg);
+
+    char* str = jsarg_to_string(outer);
+    if (strcmp(str, "{first: one, second: {inner: 3}}") != 0) {
+        return 5;
+    }
+    ejr_free_string(str);
+    ejr_arena_free(arena);
+
+    ejr_free(ejr);
+    return 0;
+}
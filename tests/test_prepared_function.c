@@ -0,0 +1,68 @@
+#include <stdio.h>
+#include <string.h>
+#include "ejr.h"
+
+int main() {
+    EasyJSRHandle* ejr = ejr_new();
+    ejr_free_jsvalue(ejr, ejr_eval_script(ejr,
+        "function add(a, b) { return a + b; }"
+        "var counter = { n: 0, bump(by, label) { this.n += by; return label + this.n; } };", "<test>"));
+
+    if (ejr_prepare_function(ejr, "missing") != NULL) {
+        return 1;
+    }
+
+    EJRPreparedFunction* add = ejr_prepare_function(ejr, "add");
+    if (add == NULL) {
+        return 2;
+    }
+
+    JSArg args[2];
+    memset(args, 0, sizeof(args));
+    args[0].type = JSARG_TYPE_INT;
+    args[1].type = JSARG_TYPE_INT;
+
+    int total = 0;
+    for (int i = 0; i < 1000; i++) {
+        args[0].value.int_val = i;
+        args[1].value.int_val = 1;
+
+        int value = ejr_call_prepared(ejr, add, args, 2);
+        JSArg* result = jsarg_from_jsvalue(ejr, value);
+        if (result->type != JSARG_TYPE_INT) {
+            return 3;
+        }
+        total += result->value.int_val;
+        jsarg_free(result);
+    }
+    if (total != 500500) {
+        return 4;
+    }
+    ejr_free_prepared(ejr, add);
+    // Already freed, nothing to do.
+    ejr_free_prepared(ejr, add);
+
+    // The object is kept alive and used as this.
+    int counter = ejr_get_from_global(ejr, "counter");
+    EJRPreparedFunction* bump = ejr_prepare_class_function(ejr, counter, "bump");
+    ejr_free_jsvalue(ejr, counter);
+    if (bump == NULL) {
+        return 5;
+    }
+
+    args[0].value.int_val = 5;
+    args[1].type = JSARG_TYPE_STRING;
+    args[1].value.str_val = "n=";
+
+    ejr_free_jsvalue(ejr, ejr_call_prepared(ejr, bump, args, 2));
+    int value = ejr_call_prepared(ejr, bump, args, 2);
+    char* str = ejr_val_to_string(ejr, value);
+    if (str == NULL || strcmp(str, "n=10") != 0) {
+        return 6;
+    }
+    ejr_free_string(str);
+
+    // Left for ejr_free to release.
+    ejr_free(ejr);
+    return 0;
+}
@@ -0,0 +1,51 @@
+#include <stdio.h>
+#include <string.h>
+#include "ejr.h"
+
+int main() {
+    EasyJSRHandle* ejr = ejr_new();
+    ejr_free_jsvalue(ejr, ejr_eval_script(ejr, "var point = { x: 1, y: 2 };", "<test>"));
+
+    EJRKey* x = ejr_intern_key(ejr, "x");
+    EJRKey* z = ejr_intern_key(ejr, "z");
+    if (x == NULL || z == NULL) {
+        return 1;
+    }
+
+    int point = ejr_get_from_global(ejr, "point");
+    for (int i = 0; i < 100; i++) {
+        JSArg* value = jsarg_from_jsvalue(ejr, ejr_get_property_by_key(ejr, point, x));
+        if (value->type != JSARG_TYPE_INT || value->value.int_val != 1) {
+            return 2;
+        }
+        jsarg_free(value);
+    }
+
+    JSArg str;
+    memset(&str, 0, sizeof(str));
+    str.type = JSARG_TYPE_STRING;
+    str.value.str_val = "set from C";
+    if (!ejr_set_property_by_key(ejr, point, z, &str)) {
+        return 3;
+    }
+
+    int value = ejr_eval_script(ejr, "point.z", "<test>");
+    char* result = ejr_val_to_string(ejr, value);
+    if (result == NULL || strcmp(result, "set from C") != 0) {
+        return 4;
+    }
+    ejr_free_string(result);
+
+    // Not a object
+    if (ejr_get_property_by_key(ejr, -1, x) != -1) {
+        return 5;
+    }
+
+    ejr_free_key(ejr, x);
+    // Already freed, nothing to do.
+    ejr_free_key(ejr, x);
+    ejr_free_jsvalue(ejr, point);
+    // z is left for ejr_free.
+    ejr_free(ejr);
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include <stdio.h>
+#include "ejr.h"
+
+int main() {
+    EasyJSRHandle* ejr = ejr_new();
+    ejr_free_jsvalue(ejr, ejr_eval_script(ejr, "var value = { n: 1, inner: { m: 2 } };", "<test>"));
+
+    int kept = -1;
+    int inner_kept = -1;
+    int freed = -1;
+    int outer_value = -1;
+
+    ejr_scope_begin(ejr);
+    int object = ejr_get_from_global(ejr, "value");
+    freed = ejr_get_property_from(ejr, object, "n");
+
+    // Freed by hand inside the scope
+    int early = ejr_get_property_from(ejr, object, "n");
+    ejr_free_jsvalue(ejr, early);
+
+    ejr_scope_begin(ejr);
+    int inner = ejr_get_property_from(ejr, object, "inner");
+    int m = ejr_get_property_from(ejr, inner, "m");
+    inner_kept = ejr_scope_escape(ejr, m);
+    ejr_scope_end(ejr);
+
+    // inner is gone, m moved into the outer scope
+    if (ejr_is_valid_jsvalue(ejr, inner) || !ejr_is_valid_jsvalue(ejr, inner_kept)) {
+        return 1;
+    }
+
+    kept = ejr_scope_escape(ejr, ejr_get_property_from(ejr, object, "n"));
+    ejr_scope_end(ejr);
+
+    if (ejr_is_valid_jsvalue(ejr, object) || ejr_is_valid_jsvalue(ejr, freed) || ejr_is_valid_jsvalue(ejr, inner_kept)) {
+        return 2;
+    }
+    if (!ejr_is_valid_jsvalue(ejr, kept)) {
+        return 3;
+    }
+
+    JSArg* arg = jsarg_from_jsvalue(ejr, kept);
+    if (arg->type != JSARG_TYPE_INT || arg->value.int_val != 1) {
+        return 4;
+    }
+    jsarg_free(arg);
+
+    // Values outside of scopes are left alone.
+    outer_value = ejr_get_from_global(ejr, "value");
+    ejr_scope_begin(ejr);
+    for (int i = 0; i < 1000; i++) {
+        ejr_get_property_from(ejr, outer_value, "inner");
+    }
+    ejr_scope_end(ejr);
+    if (!ejr_is_valid_jsvalue(ejr, outer_value)) {
+        return 5;
+    }
+
+    // Values freed by hand in long lived scopes, the scopes still end right.
+    ejr_scope_begin(ejr);
+    int outer_scoped = ejr_get_property_from(ejr, outer_value, "n");
+    ejr_scope_begin(ejr);
+    int inner_scoped = ejr_get_property_from(ejr, outer_value, "n");
+    for (int i = 0; i < 10000; i++) {
+        ejr_free_jsvalue(ejr, ejr_get_property_from(ejr, outer_value, "n"));
+    }
+    int inner_late = ejr_get_property_from(ejr, outer_value, "n");
+    ejr_scope_end(ejr);
+    if (ejr_is_valid_jsvalue(ejr, inner_scoped) || ejr_is_valid_jsvalue(ejr, inner_late) || !ejr_is_valid_jsvalue(ejr, outer_scoped)) {
+        return 7;
+    }
+    ejr_scope_end(ejr);
+    if (ejr_is_valid_jsvalue(ejr, outer_scoped)) {
+        return 8;
+    }
+
+    // Unbalanced ends are ignored.
+    ejr_scope_end(ejr);
+    if (ejr_scope_escape(ejr, -1) != -1) {
+        return 6;
+    }
+
+    // An open scope is released by ejr_free.
+    ejr_scope_begin(ejr);
+    ejr_get_from_global(ejr, "value");
+    ejr_free(ejr);
+    return 0;
+}
@@ -0,0 +1,103 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ejr.h"
+
+// Call a method on a value and read back a int result.
+int call_int(EasyJSRHandle* ejr, int value_id, const char* fn_name) {
+    JSArg* arg = jsarg_from_jsvalue(ejr, ejr_eval_class_function_flat(ejr, value_id, fn_name, NULL, 0));
+    int result = arg->type == JSARG_TYPE_INT ? arg->value.int_val : -1;
+    jsarg_free(arg);
+    return result;
+}
+
+int main() {
+    EasyJSRHandle* a = ejr_new();
+    EasyJSRHandle* b = ejr_new();
+
+    ejr_free_jsvalue(b, ejr_eval_script(b,
+        "Object.prototype.check = function () {"
+        "  return (this.n === 5n && this.d instanceof Date && this.d.getTime() === 0 && 'u' in this && this.u === undefined"
+        "    && this.arr instanceof Float64Array && this.arr[1] === 2.5 && this.self === this && this.pair[0] === this.pair[1]) ? 1 : 0;"
+        "};"
+        "Object.prototype.write = function () { new Int32Array(this.sab)[0] = 42; return 1; };", "<test>"));
+
+    // Types JSON would lose, moved to another runtime.
+    ejr_free_jsvalue(a, ejr_eval_script(a,
+        "var shared = {}; var value = { n: 5n, d: new Date(0), u: undefined, arr: new Float64Array([1.5, 2.5]), pair: [shared, shared] };"
+        "value.self = value;", "<test>"));
+    int value = ejr_get_from_global(a, "value");
+    EJRSerializedValue* serialized = ejr_serialize_value(a, value, false);
+    if (!serialized) {
+        return 1;
+    }
+    int clone = ejr_deserialize_value(b, serialized);
+    if (call_int(b, clone, "check") != 1) {
+        return 2;
+    }
+    ejr_free_jsvalue(b, clone);
+
+    // Stored bytes read back later.
+    size_t size;
+    const uint8_t* bytes = ejr_serialized_bytes(serialized, &size);
+    uint8_t* stored = (uint8_t*)malloc(size);
+    memcpy(stored, bytes, size);
+    ejr_free_serialized_value(serialized);
+
+    clone = ejr_deserialize_bytes(b, stored, size);
+    if (call_int(b, clone, "check") != 1) {
+        return 3;
+    }
+    ejr_free_jsvalue(b, clone);
+    free(stored);
+
+    // Functions can not be cloned.
+    ejr_free_jsvalue(a, ejr_eval_script(a, "var fn = { f: function () {} };", "<test>"));
+    int fn = ejr_get_from_global(a, "fn");
+    if (ejr_serialize_value(a, fn, false)) {
+        return 4;
+    }
+    ejr_free_jsvalue(a, fn);
+
+    // SharedArrayBuffers only by request, then shared by reference.
+    ejr_free_jsvalue(a, ejr_eval_script(a, "var holder = { sab: new SharedArrayBuffer(4) }; var view = new Int32Array(holder.sab);", "<test>"));
+    int holder = ejr_get_from_global(a, "holder");
+    if (ejr_serialize_value(a, holder, false)) {
+        return 5;
+    }
+    serialized = ejr_serialize_value(a, holder, true);
+    if (!serialized) {
+        return 6;
+    }
+    ejr_free_jsvalue(a, holder);
+
+    // Raw bytes can not carry them.
+    bytes = ejr_serialized_bytes(serialized, &size);
+    JSArg* rejected = jsarg_from_jsvalue(b, ejr_deserialize_bytes(b, bytes, size));
+    if (rejected->type != JSARG_TYPE_EXCEPTION) {
+        return 7;
+    }
+    jsarg_free(rejected);
+
+    clone = ejr_deserialize_value(b, serialized);
+    if (call_int(b, clone, "write") != 1) {
+        return 8;
+    }
+    JSArg* seen = jsarg_from_jsvalue(a, ejr_eval_script(a, "view[0]", "<test>"));
+    if (seen->type != JSARG_TYPE_INT || seen->value.int_val != 42) {
+        return 9;
+    }
+    jsarg_free(seen);
+
+    // The buffer outlives the runtime that made it.
+    ejr_free_jsvalue(a, value);
+    ejr_free(a);
+    ejr_free_serialized_value(serialized);
+    if (call_int(b, clone, "write") != 1) {
+        return 10;
+    }
+    ejr_free_jsvalue(b, clone);
+
+    ejr_free(b);
+    return 0;
+}
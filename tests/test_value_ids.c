@@ -0,0 +1,90 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "ejr.h"
+
+int main() {
+    EasyJSRHandle* ejr = ejr_new();
+    ejr_free_jsvalue(ejr, ejr_eval_script(ejr, "var value = { n: 1 };", "<test>"));
+
+    int object = ejr_get_from_global(ejr, "value");
+    int first = ejr_get_property_from(ejr, object, "n");
+    if (!ejr_is_valid_jsvalue(ejr, first)) {
+        return 1;
+    }
+
+    // A freed id is stale, even once its slot is reused.
+    ejr_free_jsvalue(ejr, first);
+    int second = ejr_get_property_from(ejr, object, "n");
+    if (second == first || ejr_is_valid_jsvalue(ejr, first) || !ejr_is_valid_jsvalue(ejr, second)) {
+        return 2;
+    }
+    if (ejr_get_property_from(ejr, first, "n") != -1) {
+        return 3;
+    }
+
+    // Freeing a stale id leaves the new value alone.
+    ejr_free_jsvalue(ejr, first);
+    if (!ejr_is_valid_jsvalue(ejr, second)) {
+        return 4;
+    }
+    ejr_free_jsvalue(ejr, second);
+
+    // Lots of churn and live values.
+    int ids[1000];
+    for (int round = 0; round < 10; round++) {
+        for (int i = 0; i < 1000; i++) {
+            ids[i] = ejr_get_property_from(ejr, object, "n");
+        }
+        for (int i = 0; i < 1000; i++) {
+            JSArg* arg = jsarg_from_jsvalue(ejr, ids[i]);
+            if (arg->type != JSARG_TYPE_INT || arg->value.int_val != 1) {
+                return 5;
+            }
+            jsarg_free(arg);
+            if (ejr_is_valid_jsvalue(ejr, ids[i])) {
+                return 6;
+            }
+        }
+    }
+
+    if (ejr_is_valid_jsvalue(ejr, -1) || ejr_is_valid_jsvalue(ejr, (1 << 20) - 1)) {
+        return 7;
+    }
+
+    // Stays stale through more eval and free cycles than there are generations.
+    int stale = ejr_eval_script(ejr, "'stale'", "<test>");
+    ejr_free_jsvalue(ejr, stale);
+    for (int i = 0; i < 5000; i++) {
+        int live = ejr_eval_script(ejr, "'live'", "<test>");
+        if (ejr_is_valid_jsvalue(ejr, stale)) {
+            return 8;
+        }
+        ejr_free_jsvalue(ejr, live);
+    }
+
+    // A full table hands out -1, until a value is freed.
+    int* all = malloc(sizeof(int) * EJR_MAX_LIVE_VALUES);
+    int count = 0;
+    for (; count < EJR_MAX_LIVE_VALUES; count++) {
+        all[count] = ejr_get_property_from(ejr, object, "n");
+        if (all[count] == -1) {
+            break;
+        }
+    }
+    // object and the values above are alive too.
+    if (count == 0 || count == EJR_MAX_LIVE_VALUES || ejr_get_from_global(ejr, "value") != -1) {
+        return 9;
+    }
+    ejr_free_jsvalue(ejr, all[0]);
+    all[0] = ejr_get_property_from(ejr, object, "n");
+    if (!ejr_is_valid_jsvalue(ejr, all[0])) {
+        return 10;
+    }
+    for (int i = 0; i < count; i++) {
+        ejr_free_jsvalue(ejr, all[i]);
+    }
+    free(all);
+
+    ejr_free(ejr);
+    return 0;
+}
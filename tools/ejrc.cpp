@@ -0,0 +1,195 @@
+// ejrc compiles JS files to a bytecode bundle, that EasyJSR::eval_bytecode runs without parsing.
+//
+// usage: ejrc [-o output] [-c name] [--strip] [-m | -s] file...
+//   -o output   Where to write the bundle, out.jsbc by default.
+//   -c name     Write a C header with the bundle as `name` and `name_size` instead.
+//   --strip     Drop the source and debug info.
+//   -m, -s      Compile the files after it as modules or as scripts (the default). .mjs files are always modules.
+//
+// Modules imported by the files are compiled into the bundle too, imports that are not files (native modules)
+// are left to the runtime. Files are named by their path as given, so run ejrc from the directory the
+// imports are relative to.
+
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <include/ejr.hpp>
+#include "utils.hpp"
+
+using namespace std;
+using namespace ejr;
+
+struct Input
+{
+    string name;
+    bool is_module;
+};
+
+static bool read_file(const string &path, string &out)
+{
+    ifstream file(path, ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+    stringstream buffer;
+    buffer << file.rdbuf();
+    out = buffer.str();
+    return true;
+}
+
+static string module_name(const string &path)
+{
+    // QuickJS names imports without the leading "./".
+    return str_starts_with(path, "./") ? path.substr(2) : path;
+}
+
+static int usage()
+{
+    cerr << "usage: ejrc [-o output] [-c name] [--strip] [-m | -s] file..." << endl;
+    return 2;
+}
+
+/// @brief The bundle as a C header, `name` and `name_size`.
+static string to_header(const vector<uint8_t> &bundle, const string &name)
+{
+    string guard = "EJR_BYTECODE_" + name + "_H";
+    for (char &c : guard)
+    {
+        c = static_cast<char>(toupper(static_cast<unsigned char>(c)));
+    }
+
+    stringstream out;
+    out << "// Generated by ejrc, do not edit.\n\n"
+        << "#ifndef " << guard << "\n#define " << guard << "\n\n"
+        << "#include <stddef.h>\n#include <stdint.h>\n\n"
+        << "static const uint8_t " << name << "[] = {";
+    char byte[16];
+    for (size_t i = 0; i < bundle.size(); i++)
+    {
+        snprintf(byte, sizeof(byte), "%s0x%02x,", i % 16 == 0 ? "\n    " : " ", bundle[i]);
+        out << byte;
+    }
+    out << "\n};\n\nstatic const size_t " << name << "_size = sizeof(" << name << ");\n\n"
+        << "#endif // " << guard << "\n";
+    return out.str();
+}
+
+int main(int argc, char **argv)
+{
+    string output;
+    string header_name;
+    bool strip = false;
+    bool as_module = false;
+    deque<Input> inputs;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if ((arg == "-o" || arg == "-c") && i + 1 < argc)
+        {
+            (arg == "-o" ? output : header_name) = argv[++i];
+        }
+        else if (arg == "--strip")
+        {
+            strip = true;
+        }
+        else if (arg == "-m" || arg == "-s")
+        {
+            as_module = arg == "-m";
+        }
+        else if (str_starts_with(arg, "-"))
+        {
+            return usage();
+        }
+        else
+        {
+            inputs.push_back({module_name(arg), as_module || str_ends_with(arg, ".mjs")});
+        }
+    }
+    if (inputs.empty())
+    {
+        return usage();
+    }
+    if (output.empty())
+    {
+        output = header_name.empty() ? "out.jsbc" : header_name + ".h";
+    }
+
+    // Names of the files in the bundle, and of the imports still to compile.
+    set<string> seen;
+    for (const Input &input : inputs)
+    {
+        seen.insert(input.name);
+    }
+
+    vector<Input> compiled;
+    vector<vector<uint8_t>> bytecode;
+    while (!inputs.empty())
+    {
+        Input input = inputs.front();
+        inputs.pop_front();
+
+        string source;
+        if (!read_file(input.name, source))
+        {
+            cerr << "ejrc: could not read " << input.name << endl;
+            return 1;
+        }
+
+        // A fresh runtime per file, so every import is loaded and compiled into the bundle once.
+        EasyJSR runtime;
+        runtime.set_file_loader([&](const string &path) -> string {
+            string contents;
+            if (!read_file(path, contents))
+            {
+                // Like a native module, the runtime has to provide it. Imports are only linked when run.
+                cerr << "ejrc: " << path << " not found, it is loaded at runtime" << endl;
+                return "export {};";
+            }
+            if (seen.insert(path).second)
+            {
+                inputs.push_back({path, true});
+            }
+            return contents;
+        });
+
+        bytecode.emplace_back();
+        int eval_flags = input.is_module ? JS_EVAL_TYPE_MODULE : JS_EVAL_TYPE_GLOBAL;
+        if (!runtime.compile_bytecode(source, input.name, eval_flags, bytecode.back(), strip))
+        {
+            JSValue error = JS_GetException(runtime.get_context());
+            cerr << "ejrc: " << input.name << ": " << runtime.val_to_string(error) << endl;
+            return 1;
+        }
+        compiled.push_back(input);
+    }
+
+    vector<BytecodeBundleEntry> entries;
+    for (size_t i = 0; i < compiled.size(); i++)
+    {
+        entries.push_back({compiled[i].name, compiled[i].is_module, bytecode[i].data(), bytecode[i].size()});
+    }
+    vector<uint8_t> bundle;
+    write_bytecode_bundle(entries, bundle);
+
+    ofstream file(output, ios::binary | ios::trunc);
+    if (header_name.empty())
+    {
+        file.write(reinterpret_cast<const char *>(bundle.data()), bundle.size());
+    }
+    else
+    {
+        file << to_header(bundle, header_name);
+    }
+    if (!file)
+    {
+        cerr << "ejrc: could not write " << output << endl;
+        return 1;
+    }
+    return 0;
+}